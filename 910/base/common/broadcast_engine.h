@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_BROADCAST_ENGINE_H_
+#define GE_COMMON_BROADCAST_ENGINE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace ge {
+///
+/// @brief strided iteration of binary broadcast. Adjacent dims with the same broadcast pattern are collapsed,
+///        the innermost collapsed dim is computed as one block with a typed operator, so a broadcast of any rank
+///        becomes one of: elementwise, scalar-vector, vector-scalar, repeated over the outer dims.
+///
+class BroadcastEngine {
+ public:
+  ///
+  /// @brief compute output shape and strides, shapes are aligned to the right as numpy does
+  /// @param [in] x_dims  dims of first input, empty means scalar
+  /// @param [in] y_dims  dims of second input, empty means scalar
+  /// @return SUCCESS or PARAM_INVALID if shapes can not be broadcast
+  ///
+  Status Init(const std::vector<int64_t> &x_dims, const std::vector<int64_t> &y_dims) {
+    dims_.clear();
+    x_strides_.clear();
+    y_strides_.clear();
+    output_dims_.clear();
+    const size_t rank = (x_dims.size() > y_dims.size()) ? x_dims.size() : y_dims.size();
+    output_dims_.resize(rank);
+    x_size_ = 1;
+    y_size_ = 1;
+    output_size_ = 1;
+    std::vector<bool> x_bcast;
+    std::vector<bool> y_bcast;
+    for (size_t i = 0U; i < rank; ++i) {
+      const int64_t x_dim = (i + x_dims.size() < rank) ? 1 : x_dims[i + x_dims.size() - rank];
+      const int64_t y_dim = (i + y_dims.size() < rank) ? 1 : y_dims[i + y_dims.size() - rank];
+      if ((x_dim < 0) || (y_dim < 0)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] Broadcast does not support unknown dim, x dim:%ld, y dim:%ld.",
+               x_dim, y_dim);
+        return PARAM_INVALID;
+      }
+      int64_t out_dim = x_dim;
+      if (x_dim == 1) {
+        out_dim = y_dim;
+      } else if ((y_dim != 1) && (y_dim != x_dim)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] Can not broadcast dim %zu, x dim:%ld, y dim:%ld.", i, x_dim, y_dim);
+        return PARAM_INVALID;
+      }
+      output_dims_[i] = out_dim;
+      x_size_ *= x_dim;
+      y_size_ *= y_dim;
+      output_size_ *= out_dim;
+      if (out_dim == 1) {
+        continue;
+      }
+      const bool is_x_bcast = (x_dim == 1);
+      const bool is_y_bcast = (y_dim == 1);
+      if ((!dims_.empty()) && (x_bcast.back() == is_x_bcast) && (y_bcast.back() == is_y_bcast)) {
+        dims_.back() *= out_dim;
+      } else {
+        dims_.emplace_back(out_dim);
+        x_bcast.emplace_back(is_x_bcast);
+        y_bcast.emplace_back(is_y_bcast);
+      }
+    }
+    if (dims_.empty()) {
+      dims_.emplace_back(1);
+      x_bcast.emplace_back(true);
+      y_bcast.emplace_back(true);
+    }
+    x_strides_.resize(dims_.size());
+    y_strides_.resize(dims_.size());
+    int64_t x_stride = 1;
+    int64_t y_stride = 1;
+    for (size_t i = dims_.size(); i > 0U; --i) {
+      const size_t idx = i - 1U;
+      x_strides_[idx] = x_bcast[idx] ? 0 : x_stride;
+      y_strides_[idx] = y_bcast[idx] ? 0 : y_stride;
+      x_stride *= x_bcast[idx] ? 1 : dims_[idx];
+      y_stride *= y_bcast[idx] ? 1 : dims_[idx];
+    }
+    return SUCCESS;
+  }
+
+  const std::vector<int64_t> &GetOutputDims() const { return output_dims_; }
+  int64_t GetOutputSize() const { return output_size_; }
+  int64_t GetXSize() const { return x_size_; }
+  int64_t GetYSize() const { return y_size_; }
+
+  ///
+  /// @brief compute out[i] = op(x[xi], y[yi]) for every output element
+  /// @param [in] x  data of first input, at least GetXSize() elements
+  /// @param [in] y  data of second input, at least GetYSize() elements
+  /// @param [out] out  random access iterator of at least GetOutputSize() elements
+  /// @param [in] op  callable of OutT(const InT &, const InT &), inlined into the block loops
+  ///
+  template <typename InT, typename OutIter, typename Op>
+  void Compute(const InT *const x, const InT *const y, OutIter out, Op &op) const {
+    const auto apply = [&op](decltype(*out) dst, const InT &x_value, const InT &y_value) {
+      dst = op(x_value, y_value);
+      return true;
+    };
+    (void)Run(x, y, out, apply);
+  }
+
+  ///
+  /// @brief same as Compute, but op reports a status and computing stops at the first element it fails on
+  /// @param [in] op  callable of OutT(const InT &, const InT &, Status &)
+  /// @return SUCCESS or the status op failed with, outputs from the failed element on are left unset
+  ///
+  template <typename InT, typename OutIter, typename Op>
+  Status ComputeChecked(const InT *const x, const InT *const y, OutIter out, Op &op) const {
+    Status ret = SUCCESS;
+    const auto apply = [&op, &ret](decltype(*out) dst, const InT &x_value, const InT &y_value) {
+      dst = op(x_value, y_value, ret);
+      return ret == SUCCESS;
+    };
+    (void)Run(x, y, out, apply);
+    return ret;
+  }
+
+ private:
+  template <typename InT, typename OutIter, typename Apply>
+  bool Run(const InT *const x, const InT *const y, OutIter out, const Apply &apply) const {
+    if (output_size_ == 0) {
+      return true;
+    }
+    const size_t outer_rank = dims_.size() - 1U;
+    const int64_t inner = dims_.back();
+    const int64_t x_inner_stride = x_strides_.back();
+    const int64_t y_inner_stride = y_strides_.back();
+    const int64_t outer = output_size_ / inner;
+    std::vector<int64_t> counter(outer_rank, 0);
+    int64_t x_offset = 0;
+    int64_t y_offset = 0;
+    for (int64_t o = 0; o < outer; ++o) {
+      if (!ComputeBlock(x + x_offset, y + y_offset, out, inner, x_inner_stride, y_inner_stride, apply)) {
+        return false;
+      }
+      out += inner;
+      for (size_t d = outer_rank; d > 0U; --d) {
+        const size_t idx = d - 1U;
+        x_offset += x_strides_[idx];
+        y_offset += y_strides_[idx];
+        if (++counter[idx] < dims_[idx]) {
+          break;
+        }
+        x_offset -= x_strides_[idx] * dims_[idx];
+        y_offset -= y_strides_[idx] * dims_[idx];
+        counter[idx] = 0;
+      }
+    }
+    return true;
+  }
+
+  // apply returns false to stop, it is constant true for Compute and the checks fold away
+  template <typename InT, typename OutIter, typename Apply>
+  static bool ComputeBlock(const InT *const x, const InT *const y, OutIter out, const int64_t len,
+                           const int64_t x_stride, const int64_t y_stride, const Apply &apply) {
+    if ((x_stride == 1) && (y_stride == 1)) {
+      for (int64_t i = 0; i < len; ++i) {
+        if (!apply(out[i], x[i], y[i])) {
+          return false;
+        }
+      }
+    } else if ((x_stride == 0) && (y_stride == 1)) {
+      const InT x_value = x[0];
+      for (int64_t i = 0; i < len; ++i) {
+        if (!apply(out[i], x_value, y[i])) {
+          return false;
+        }
+      }
+    } else if ((x_stride == 1) && (y_stride == 0)) {
+      const InT y_value = y[0];
+      for (int64_t i = 0; i < len; ++i) {
+        if (!apply(out[i], x[i], y_value)) {
+          return false;
+        }
+      }
+    } else {
+      for (int64_t i = 0; i < len; ++i) {
+        if (!apply(out[i], x[i * x_stride], y[i * y_stride])) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // collapsed dims and strides in element, stride 0 means broadcast
+  std::vector<int64_t> dims_;
+  std::vector<int64_t> x_strides_;
+  std::vector<int64_t> y_strides_;
+  std::vector<int64_t> output_dims_;
+  int64_t x_size_ = 1;
+  int64_t y_size_ = 1;
+  int64_t output_size_ = 1;
+};
+}  // namespace ge
+
+#endif  // GE_COMMON_BROADCAST_ENGINE_H_
@@ -17,7 +17,12 @@
 #ifndef GE_COMMON_FORMATS_FORMAT_TRANSFERS_DATATYPE_TRANSFER_H_
 #define GE_COMMON_FORMATS_FORMAT_TRANSFERS_DATATYPE_TRANSFER_H_
 
+#include <memory>
+#include <new>
+
+#include "common/fp16_batch_convert.h"
 #include "formats/register_format_transfer.h"
+#include "framework/common/debug/ge_log.h"
 #include "framework/common/ge_inner_error_codes.h"
 
 namespace ge {
@@ -31,6 +36,82 @@ class DataTypeTransfer {
 bool IsTransDataTypeSupport(const CastArgs &args);
 
 Status TransTensorDataType(const CastArgs &args, TransResult &result);
+
+///
+/// @brief whether the cast can be done by the batch converters, see TransTensorDataTypeWithBatch.
+///        Covers fp32 <-> fp16, fp32 <-> bf16, int8 -> fp32 and int8 -> fp16.
+///
+inline bool IsBatchTransDataTypeSupport(const CastArgs &args) {
+  switch (args.src_data_type) {
+    case DT_FLOAT:
+      return (args.dst_data_type == DT_FLOAT16) || (args.dst_data_type == DT_BF16);
+    case DT_FLOAT16:
+    case DT_BF16:
+      return args.dst_data_type == DT_FLOAT;
+    case DT_INT8:
+      return (args.dst_data_type == DT_FLOAT) || (args.dst_data_type == DT_FLOAT16);
+    default:
+      return false;
+  }
+}
+
+///
+/// @brief cast src_data_size elements with the batch converters selected by cpu features
+///
+inline Status TransDataTypeBatch(const CastArgs &args, TransResult &result) {
+  if (!IsBatchTransDataTypeSupport(args)) {
+    GELOGE(UNSUPPORTED, "[Check][Param] Batch cast from %d to %d is not supported.",
+           static_cast<int32_t>(args.src_data_type), static_cast<int32_t>(args.dst_data_type));
+    return UNSUPPORTED;
+  }
+  const size_t dst_type_size = (args.dst_data_type == DT_FLOAT) ? sizeof(float) : sizeof(uint16_t);
+  const size_t total_size = args.src_data_size * dst_type_size;
+  result.length = total_size;
+  if (total_size == 0U) {
+    GELOGI("In TransDataTypeBatch, total_size is zero, has no data.");
+    return SUCCESS;
+  }
+  if (args.data == nullptr) {
+    GELOGE(PARAM_INVALID, "[Check][Param] Batch cast src data is nullptr, size %zu.", args.src_data_size);
+    return PARAM_INVALID;
+  }
+  const std::shared_ptr<uint8_t> dst(new (std::nothrow) uint8_t[total_size], std::default_delete<uint8_t[]>());
+  if (dst == nullptr) {
+    GELOGE(ACL_ERROR_GE_MEMORY_ALLOCATION, "[Allocate][DSTMemory] Failed, memory for dst buf %zu", total_size);
+    return ACL_ERROR_GE_MEMORY_ALLOCATION;
+  }
+  const size_t num = args.src_data_size;
+  if (args.src_data_type == DT_FLOAT) {
+    const float *const src = reinterpret_cast<const float *>(args.data);
+    if (args.dst_data_type == DT_FLOAT16) {
+      BatchConvertFp32ToFp16(src, reinterpret_cast<uint16_t *>(dst.get()), num);
+    } else {
+      BatchConvertFp32ToBf16(src, reinterpret_cast<uint16_t *>(dst.get()), num);
+    }
+  } else if (args.src_data_type == DT_FLOAT16) {
+    BatchConvertFp16ToFp32(reinterpret_cast<const uint16_t *>(args.data), reinterpret_cast<float *>(dst.get()), num);
+  } else if (args.src_data_type == DT_BF16) {
+    BatchConvertBf16ToFp32(reinterpret_cast<const uint16_t *>(args.data), reinterpret_cast<float *>(dst.get()), num);
+  } else if (args.dst_data_type == DT_FLOAT) {
+    BatchConvertInt8ToFp32(reinterpret_cast<const int8_t *>(args.data), reinterpret_cast<float *>(dst.get()), num);
+  } else {
+    BatchConvertInt8ToFp16(reinterpret_cast<const int8_t *>(args.data), reinterpret_cast<uint16_t *>(dst.get()),
+                           num);
+  }
+  result.data = dst;
+  return SUCCESS;
+}
+
+///
+/// @brief cast with the batch converters if they cover the data types, otherwise with TransTensorDataType.
+///        Results of the covered casts are the same as the element wise transfers.
+///
+inline Status TransTensorDataTypeWithBatch(const CastArgs &args, TransResult &result) {
+  if (IsBatchTransDataTypeSupport(args)) {
+    return TransDataTypeBatch(args, result);
+  }
+  return TransTensorDataType(args, result);
+}
 }  // namespace formats
 }  // namespace ge
 
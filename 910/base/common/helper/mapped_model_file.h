@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_HELPER_MAPPED_MODEL_FILE_H_
+#define GE_COMMON_HELPER_MAPPED_MODEL_FILE_H_
+
+#include <sys/mman.h>  // madvise, mmpa has no wrapper of it
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "framework/common/ge_types.h"
+#include "framework/common/types.h"
+#include "framework/common/util.h"
+#include "mmpa/mmpa_api.h"
+
+namespace ge {
+/**
+ * @ingroup domi_ome
+ * @brief om file mapped read only into memory. Partitions parsed from the mapping are views of the file, pages are
+ *        loaded on first touch and can be given back to the OS once their content has been uploaded to device.
+ *        Pages are not writable, a partition that has to be modified must be copied first.
+ */
+class MappedModelFile {
+ public:
+  MappedModelFile() = default;
+  ~MappedModelFile() {
+    Unmap();
+  }
+  MappedModelFile(const MappedModelFile &) = delete;
+  MappedModelFile &operator=(const MappedModelFile &) = delete;
+
+  /**
+   * @ingroup domi_ome
+   * @brief map the whole model file
+   * @param [in] model_path  model path
+   * @return SUCCESS, or ACL_ERROR_GE_EXEC_MODEL_PATH_INVALID if file can not be mapped
+   */
+  Status Map(const char_t *const model_path) {
+    Unmap();
+    const std::string real_path = RealPath(model_path);
+    if (real_path.empty()) {
+      GELOGE(ACL_ERROR_GE_EXEC_MODEL_PATH_INVALID, "[Check][Param] model file path:%s is invalid",
+             (model_path == nullptr) ? "nullptr" : model_path);
+      return ACL_ERROR_GE_EXEC_MODEL_PATH_INVALID;
+    }
+    const INT32 fd = mmOpen(real_path.c_str(), M_RDONLY);
+    if (fd < 0) {
+      GELOGE(ACL_ERROR_GE_EXEC_MODEL_PATH_INVALID, "[Open][File] %s failed", real_path.c_str());
+      return ACL_ERROR_GE_EXEC_MODEL_PATH_INVALID;
+    }
+    mmStat_t file_stat = {};
+    if ((mmFStatGet(fd, &file_stat) != EN_OK) || (file_stat.st_size < static_cast<off_t>(sizeof(ModelFileHeader)))) {
+      GELOGE(ACL_ERROR_GE_EXEC_MODEL_DATA_SIZE_INVALID, "[Check][Size] model file %s is smaller than header size %zu",
+             real_path.c_str(), sizeof(ModelFileHeader));
+      (void)mmClose(fd);
+      return ACL_ERROR_GE_EXEC_MODEL_DATA_SIZE_INVALID;
+    }
+    const mmSize_t file_size = static_cast<mmSize_t>(file_stat.st_size);
+    void *const addr = mmMmap(fd, file_size, 0, &map_extra_, PROT_READ, MAP_PRIVATE);
+    // the mapping keeps its own reference of the file
+    (void)mmClose(fd);
+    if ((addr == nullptr) || (addr == MAP_FAILED)) {
+      GELOGE(ACL_ERROR_GE_MEMORY_ALLOCATION, "[Map][File] %s failed, size:%zu", real_path.c_str(), file_size);
+      return ACL_ERROR_GE_MEMORY_ALLOCATION;
+    }
+    (void)madvise(addr, file_size, MADV_SEQUENTIAL);
+    data_ = static_cast<uint8_t *>(addr);
+    size_ = static_cast<uint64_t>(file_size);
+    path_ = real_path;
+    released_size_.store(0UL);
+    GELOGI("Map model file %s success, size:%lu", path_.c_str(), size_);
+    return SUCCESS;
+  }
+
+  /**
+   * @ingroup domi_ome
+   * @brief fill model data as LoadFromFile does, model_data does not own the memory
+   */
+  void FillModelData(const int32_t priority, ModelData &model_data) const {
+    model_data.model_data = data_;
+    model_data.model_len = size_;
+    model_data.priority = priority;
+    model_data.om_path = path_;
+  }
+
+  bool Contains(const void *const addr, const uint64_t size) const {
+    const uint8_t *const begin = static_cast<const uint8_t *>(addr);
+    return (data_ != nullptr) && (begin >= data_) && (size <= size_) &&
+           (static_cast<uint64_t>(begin - data_) <= (size_ - size));
+  }
+
+  /**
+   * @ingroup domi_ome
+   * @brief hint that the range is read soon, e.g. partition about to be uploaded to device
+   */
+  void Prefetch(const void *const addr, const uint64_t size) const {
+    uint8_t *begin = nullptr;
+    uint64_t len = 0UL;
+    if (AlignRange(addr, size, false, begin, len)) {
+      (void)madvise(begin, len, MADV_WILLNEED);
+    }
+  }
+
+  /**
+   * @ingroup domi_ome
+   * @brief drop the host pages fully inside the range, e.g. weights already copied to device.
+   *        The range reads back from file if it is touched again.
+   * @return SUCCESS, PARAM_INVALID if range is not in the mapping
+   */
+  Status ReleasePages(const void *const addr, const uint64_t size) {
+    if (!Contains(addr, size)) {
+      GELOGE(PARAM_INVALID, "[Check][Param] range %p size %lu is not in mapped model file %s", addr, size,
+             path_.c_str());
+      return PARAM_INVALID;
+    }
+    uint8_t *begin = nullptr;
+    uint64_t len = 0UL;
+    if (!AlignRange(addr, size, true, begin, len)) {
+      return SUCCESS;
+    }
+    if (madvise(begin, len, MADV_DONTNEED) != 0) {
+      GELOGW("Release pages of model file %s failed, offset:%ld size:%lu", path_.c_str(),
+             static_cast<int64_t>(begin - data_), len);
+      return SUCCESS;
+    }
+    (void)released_size_.fetch_add(len);
+    GELOGD("Release pages of model file %s, offset:%ld size:%lu", path_.c_str(), static_cast<int64_t>(begin - data_),
+           len);
+    return SUCCESS;
+  }
+
+  const uint8_t *GetData() const { return data_; }
+  uint64_t GetSize() const { return size_; }
+  const std::string &GetPath() const { return path_; }
+  uint64_t GetReleasedSize() const { return released_size_.load(); }
+
+ private:
+  // inner: shrink to whole pages inside the range, otherwise grow to pages covering the range
+  bool AlignRange(const void *const addr, const uint64_t size, const bool inner, uint8_t *&begin,
+                  uint64_t &len) const {
+    if ((size == 0UL) || (!Contains(addr, size))) {
+      return false;
+    }
+    const uintptr_t page_size = static_cast<uintptr_t>(mmGetPageSize());
+    const uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+    const uintptr_t end = start + size;
+    const uintptr_t aligned_start =
+        inner ? ((start + page_size - 1U) & ~(page_size - 1U)) : (start & ~(page_size - 1U));
+    const uintptr_t aligned_end = inner ? (end & ~(page_size - 1U)) : ((end + page_size - 1U) & ~(page_size - 1U));
+    if (aligned_end <= aligned_start) {
+      return false;
+    }
+    begin = reinterpret_cast<uint8_t *>(aligned_start);
+    len = static_cast<uint64_t>(aligned_end - aligned_start);
+    return true;
+  }
+
+  void Unmap() {
+    if (data_ != nullptr) {
+      (void)mmMunMap(data_, static_cast<mmSize_t>(size_), &map_extra_);
+      GELOGI("Unmap model file %s, released %lu bytes before unmap", path_.c_str(), released_size_.load());
+    }
+    data_ = nullptr;
+    size_ = 0UL;
+    path_.clear();
+  }
+
+  uint8_t *data_ = nullptr;
+  uint64_t size_ = 0UL;
+  mmFd_t map_extra_ = 0;
+  std::string path_;
+  std::atomic<uint64_t> released_size_{0UL};
+};
+using MappedModelFilePtr = std::shared_ptr<MappedModelFile>;
+}  // namespace ge
+#endif  // GE_COMMON_HELPER_MAPPED_MODEL_FILE_H_
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_HELPER_MAPPED_MODEL_LOADER_H_
+#define GE_COMMON_HELPER_MAPPED_MODEL_LOADER_H_
+
+#include "common/helper/mapped_model_file.h"
+#include "common/helper/model_parser_base.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/helper/model_helper.h"
+#include "framework/common/helper/om_file_helper.h"
+
+namespace ge {
+/**
+ * @ingroup domi_ome
+ * @brief give host pages of mapped weights back to the OS once they have been copied to device
+ * @param [in] ge_model  model loaded by LoadModelFromMappedFile
+ */
+inline void ReleaseWeightHostPages(const GeModel &ge_model) {
+  const MappedModelFilePtr &mapped_file = ge_model.GetMappedFile();
+  const uint8_t *const weight_data = ge_model.GetWeightData();
+  const size_t weight_size = ge_model.GetWeightSize();
+  if ((mapped_file != nullptr) && (weight_size > 0U) && mapped_file->Contains(weight_data, weight_size)) {
+    (void)mapped_file->ReleasePages(weight_data, weight_size);
+  }
+}
+
+/**
+ * @ingroup domi_ome
+ * @brief OpKernelBin owns a copy of its bytes, so once the kernel stores are loaded the kernel partitions of the
+ *        mapping are not read again and their host pages are given back
+ */
+inline void ReleaseKernelHostPages(const ModelData &model_data, MappedModelFile &mapped_file) {
+  OmFileLoadHelper om_load_helper;
+  if (om_load_helper.Init(model_data) != SUCCESS) {
+    GELOGW("Parse partitions of mapped file %s failed, kernel pages are kept.", mapped_file.GetPath().c_str());
+    return;
+  }
+  const auto release = [&mapped_file](const std::vector<ModelPartition> &partitions) {
+    for (const auto &partition : partitions) {
+      const bool is_kernel = (partition.type == ModelPartitionType::TBE_KERNELS) ||
+                             (partition.type == ModelPartitionType::CUST_AICPU_KERNELS);
+      if (is_kernel && mapped_file.Contains(partition.data, partition.size)) {
+        (void)mapped_file.ReleasePages(partition.data, partition.size);
+      }
+    }
+  };
+  release(om_load_helper.context_.partition_datas_);
+  for (const auto &context : om_load_helper.model_contexts_) {
+    release(context.partition_datas_);
+  }
+}
+
+/**
+ * @ingroup domi_ome
+ * @brief load an om file through a private mapping instead of a heap copy. The model helper runs in shared weight
+ *        mode, so the weights partition of every loaded GeModel is a view of the mapping, and the GeModels keep the
+ *        mapping alive. Host pages of kernel partitions are given back once the kernel stores hold their copy,
+ *        call ReleaseWeightHostPages once the weights are on device.
+ * @param [in] model_path    model path
+ * @param [in] priority      model priority
+ * @param [in] is_root_model load by LoadRootModel, otherwise by LoadModel
+ * @param [out] model_helper helper holding the loaded models
+ * @return Status  result
+ */
+inline Status LoadModelFromMappedFile(const char_t *const model_path, const int32_t priority,
+                                      const bool is_root_model, ModelHelper &model_helper) {
+  ModelData model_data;
+  MappedModelFilePtr mapped_file;
+  GE_CHK_STATUS_RET(ModelParserBase::LoadFromFileMapped(model_path, priority, model_data, mapped_file),
+                    "[Map][ModelFile] %s failed", (model_path == nullptr) ? "nullptr" : model_path);
+  model_helper.SetSharedWeightFlag(true);
+  if (is_root_model) {
+    GE_CHK_STATUS_RET(model_helper.LoadRootModel(model_data), "[Load][RootModel] from mapped file %s failed",
+                      mapped_file->GetPath().c_str());
+    const GeRootModelPtr root_model = model_helper.GetGeRootModel();
+    GE_CHECK_NOTNULL(root_model);
+    for (const auto &name_to_model : root_model->GetSubgraphInstanceNameToModel()) {
+      if (name_to_model.second != nullptr) {
+        name_to_model.second->SetMappedFile(mapped_file);
+      }
+    }
+  } else {
+    GE_CHK_STATUS_RET(model_helper.LoadModel(model_data), "[Load][Model] from mapped file %s failed",
+                      mapped_file->GetPath().c_str());
+  }
+  const GeModelPtr ge_model = model_helper.GetGeModel();
+  if (ge_model != nullptr) {
+    ge_model->SetMappedFile(mapped_file);
+  }
+  ReleaseKernelHostPages(model_data, *mapped_file);
+  GELOGI("Load model from mapped file %s success, size:%lu", mapped_file->GetPath().c_str(), mapped_file->GetSize());
+  return SUCCESS;
+}
+}  // namespace ge
+#endif  // GE_COMMON_HELPER_MAPPED_MODEL_LOADER_H_
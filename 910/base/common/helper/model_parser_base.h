@@ -23,6 +23,8 @@
 #include "framework/common/ge_types.h"
 #include "framework/common/util.h"
 #include "framework/common/types.h"
+#include "common/helper/mapped_model_file.h"
+#include "common/plugin/ge_util.h"
 
 namespace ge {
 class ModelParserBase {
@@ -37,6 +39,28 @@ class ModelParserBase {
    */
   static Status LoadFromFile(const char_t *const model_path, const int32_t priority, ModelData &model_data);
 
+  /**
+   * @ingroup hiai
+   * @brief Map a model file instead of reading it into heap memory
+   * @param [in] model_path  model path
+   * @param [in] priority    modle priority
+   * @param [out] model_data model data, points into mapped_file and is valid while mapped_file lives
+   * @param [out] mapped_file mapping of model file, see LoadModelFromMappedFile
+   * @return Status  result
+   */
+  static Status LoadFromFileMapped(const char_t *const model_path, const int32_t priority, ModelData &model_data,
+                                   MappedModelFilePtr &mapped_file) {
+    mapped_file = MakeShared<MappedModelFile>();
+    GE_CHECK_NOTNULL(mapped_file);
+    const Status ret = mapped_file->Map(model_path);
+    if (ret != SUCCESS) {
+      mapped_file.reset();
+      return ret;
+    }
+    mapped_file->FillModelData(priority, model_data);
+    return SUCCESS;
+  }
+
   /**
    * @ingroup domi_ome
    * @brief Parse model contents from the ModelData
@@ -15,12 +15,16 @@
  */
 #ifndef BASE_EXEC_RUNTIME_DEPLOY_DEPLOY_PLANNER_H_
 #define BASE_EXEC_RUNTIME_DEPLOY_DEPLOY_PLANNER_H_
+#include <algorithm>
 #include <atomic>
 #include <map>
 #include <set>
 #include <vector>
 #include "common/model/ge_root_model.h"
 #include "common/model/model_deploy_resource.h"
+#include "exec_runtime/deploy/cost_model_placer.h"
+#include "exec_runtime/deploy/exchange_service.h"
+#include "framework/common/debug/log.h"
 
 namespace ge {
 /**
@@ -48,6 +52,7 @@ class DeployPlan {
   struct QueueInfo {
     DeviceInfo device_info;
     uint32_t depth = 2U; // minimal queue depth
+    uint32_t max_depth = 0U; // depth may adapt up to it, 0 for fixed depth
     int32_t ref_index = -1;
     std::string name;
     std::string model_instance_name;
@@ -120,6 +125,31 @@ class DeployPlan {
   const std::vector<HcomCommGroup> &GetCommGroups() const;
   void AddCommGroup(const HcomCommGroup &comm_group);
 
+  /// Let owned queues and group entries adapt their depth up to max_depth under backpressure,
+  /// queues whose depth is not below max_depth keep a fixed depth
+  /// @param max_depth        max depth of queues, 0 for fixed depth
+  void SetQueueMaxDepth(const uint32_t max_depth) {
+    const auto update = [max_depth](QueueInfo &queue_info) {
+      if (queue_info.owned) {
+        queue_info.max_depth = (max_depth > queue_info.depth) ? max_depth : 0U;
+      }
+    };
+    std::for_each(queues_.begin(), queues_.end(), update);
+    std::for_each(group_entries_.begin(), group_entries_.end(), update);
+  }
+
+  /// Create queue of queue_info, its depth adapts up to max_depth if set by SetQueueMaxDepth
+  /// @param exchange_service exchange service of the device
+  /// @param device_id        device id
+  /// @param queue_info       queue info of the plan
+  /// @param work_mode        work mode of queue
+  /// @param queue_id         output queue id
+  static Status CreateQueue(ExchangeService &exchange_service, const int32_t device_id, const QueueInfo &queue_info,
+                            const uint32_t work_mode, uint32_t &queue_id) {
+    return exchange_service.CreateQueue(device_id, queue_info.name, queue_info.depth, queue_info.max_depth,
+                                        work_mode, queue_id);
+  }
+
  private:
   friend class DeployPlannerBase;
   std::string model_name_;
@@ -146,6 +176,16 @@ class DeployPlannerBase {
   /// @param deploy_plan      output DeployPlan
   /// @return                 SUCCESS if built successfully, otherwise returns appropriate error code
   Status BuildPlan(DeployPlan &deploy_plan);
+
+  /// Build DeployPlan whose owned queues adapt their depth up to queue_max_depth under backpressure
+  /// @param deploy_plan      output DeployPlan
+  /// @param queue_max_depth  max depth of queues, 0 for fixed depth
+  /// @return                 SUCCESS if built successfully, otherwise returns appropriate error code
+  Status BuildPlan(DeployPlan &deploy_plan, const uint32_t queue_max_depth) {
+    GE_CHK_STATUS_RET_NOLOG(BuildPlan(deploy_plan));
+    deploy_plan.SetQueueMaxDepth(queue_max_depth);
+    return SUCCESS;
+  }
   Status BuildTransferPlan(const std::pair<DeployPlan::DeviceInfo, DeployPlan::DeviceInfo> &routes,
                            DeployPlan &deploy_plan);
 
@@ -300,5 +340,40 @@ class DeployPlanner : public DeployPlannerBase {
  private:
   const PneModelPtr root_model_;
 };
+
+/**
+ * DeployPlanner placing submodels by cost model instead of static configuration, see CostModelPlacer.
+ * Devices of submodels are taken from the placement, queues and bindings are built from them as usual.
+ */
+class CostModelDeployPlanner : public DeployPlanner {
+ public:
+  CostModelDeployPlanner(const PneModelPtr &root_model, const PlacementCostModel &cost_model)
+      : DeployPlanner(root_model), cost_model_(cost_model) {}
+  ~CostModelDeployPlanner() override = default;
+
+  /// Estimated bottleneck and throughput of the placement of the last BuildPlan
+  const PlacementResult &GetPlacementResult() const {
+    return placement_result_;
+  }
+
+ protected:
+  Status PrepareModelsAndRelation(ModelRelation &model_relation) override {
+    GE_CHK_STATUS_RET_NOLOG(DeployPlanner::PrepareModelsAndRelation(model_relation));
+    CostModelPlacer placer;
+    GE_CHK_STATUS_RET(placer.Place(model_relation, cost_model_, placement_result_),
+                      "[Place][Submodels] by cost model failed");
+    for (const auto &it : placement_result_.device_indices) {
+      const PlacementDeviceProfile &device = cost_model_.devices[it.second];
+      MutableSubmodelInfo(it.first).device_info = DeployPlan::DeviceInfo(device.type, device.node_id, device.device_id);
+      GELOGD("Submodel %s is placed on device %d_%d_%d, load:%.3f us", it.first.c_str(), device.type,
+             device.node_id, device.device_id, placement_result_.device_loads[it.second]);
+    }
+    return SUCCESS;
+  }
+
+ private:
+  const PlacementCostModel cost_model_;
+  PlacementResult placement_result_;
+};
 }  // namespace ge
 #endif  // BASE_EXEC_RUNTIME_DEPLOY_DEPLOY_PLANNER_H_
@@ -29,6 +29,7 @@ struct MemQueueAttr {
   uint32_t depth;
   uint32_t work_mode;
   bool overwrite = false;
+  uint32_t max_depth = 0U;  // larger than depth: depth may grow up to it under backpressure, if supported
 };
 /// Interfaces for data exchange operations
 class ExchangeService {
@@ -62,10 +63,21 @@ class ExchangeService {
                      const uint32_t depth,
                      const uint32_t work_mode,
                      uint32_t &queue_id) {
+    return CreateQueue(device_id, name, depth, 0U, work_mode, queue_id);
+  }
+
+  /// Create queue whose depth may adapt within [depth, max_depth], e.g. from DeployPlan::QueueInfo
+  Status CreateQueue(const int32_t device_id,
+                     const std::string &name,
+                     const uint32_t depth,
+                     const uint32_t max_depth,
+                     const uint32_t work_mode,
+                     uint32_t &queue_id) {
     MemQueueAttr mem_queue_attr{};
     mem_queue_attr.depth = depth;
     mem_queue_attr.work_mode = work_mode;
     mem_queue_attr.overwrite = false;
+    mem_queue_attr.max_depth = max_depth;
     return CreateQueue(device_id, name, mem_queue_attr, queue_id);
   }
 
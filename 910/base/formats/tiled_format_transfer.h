@@ -0,0 +1,276 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_FORMATS_TILED_FORMAT_TRANSFER_H_
+#define GE_COMMON_FORMATS_TILED_FORMAT_TRANSFER_H_
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "external/graph/types.h"
+#include "formats/register_format_transfer.h"
+#include "formats/utils/formats_definitions.h"
+#include "formats/utils/formats_trans_utils.h"
+#include "formats/utils/tiled_transfer_engine.h"
+#include "graph/utils/type_utils.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace ge {
+namespace formats {
+namespace tiled {
+enum TiledDimIndex {
+  kTiledN,
+  kTiledC,
+  kTiledH,
+  kTiledW,
+  kTiledD,
+  kTiledDimsNum
+};
+
+inline TiledAxis Whole(const size_t dim) { return TiledAxis{dim, TiledAxisPart::kWhole}; }
+inline TiledAxis Outer(const size_t dim) { return TiledAxis{dim, TiledAxisPart::kOuter}; }
+inline TiledAxis Inner(const size_t dim) { return TiledAxis{dim, TiledAxisPart::kInner}; }
+
+// axes of a plain 4D/5D format, empty if format is not plain
+inline std::vector<TiledAxis> GetPlainAxes(const Format format) {
+  switch (format) {
+    case FORMAT_NCHW:
+      return {Whole(kTiledN), Whole(kTiledC), Whole(kTiledH), Whole(kTiledW)};
+    case FORMAT_NHWC:
+      return {Whole(kTiledN), Whole(kTiledH), Whole(kTiledW), Whole(kTiledC)};
+    case FORMAT_HWCN:
+      return {Whole(kTiledH), Whole(kTiledW), Whole(kTiledC), Whole(kTiledN)};
+    case FORMAT_CHWN:
+      return {Whole(kTiledC), Whole(kTiledH), Whole(kTiledW), Whole(kTiledN)};
+    case FORMAT_DHWCN:
+      return {Whole(kTiledD), Whole(kTiledH), Whole(kTiledW), Whole(kTiledC), Whole(kTiledN)};
+    default:
+      return {};
+  }
+}
+
+// axes of a packed format, tiles of N and C are set into dims
+inline std::vector<TiledAxis> GetPackedAxes(const Format format, const int64_t c0, std::vector<TiledDim> &dims) {
+  switch (format) {
+    case FORMAT_NC1HWC0:
+      dims[kTiledC].tile = c0;
+      return {Whole(kTiledN), Outer(kTiledC), Whole(kTiledH), Whole(kTiledW), Inner(kTiledC)};
+    case FORMAT_FRACTAL_Z:
+      dims[kTiledC].tile = c0;
+      dims[kTiledN].tile = kNiSize;
+      return {Outer(kTiledC), Whole(kTiledH), Whole(kTiledW), Outer(kTiledN), Inner(kTiledN), Inner(kTiledC)};
+    case FORMAT_FRACTAL_Z_3D:
+      dims[kTiledC].tile = c0;
+      dims[kTiledN].tile = kNiSize;
+      return {Whole(kTiledD), Outer(kTiledC), Whole(kTiledH), Whole(kTiledW),
+              Outer(kTiledN), Inner(kTiledN), Inner(kTiledC)};
+    case FORMAT_C1HWNCoC0:
+      // Co and C0 are the diagonal of the same C tile
+      dims[kTiledC].tile = c0;
+      return {Outer(kTiledC), Whole(kTiledH), Whole(kTiledW), Whole(kTiledN), Inner(kTiledC), Inner(kTiledC)};
+    default:
+      return {};
+  }
+}
+
+inline bool IsPackedPairSupport(const Format plain, const Format packed) {
+  switch (packed) {
+    case FORMAT_NC1HWC0:
+      return (plain == FORMAT_NCHW) || (plain == FORMAT_NHWC);
+    case FORMAT_FRACTAL_Z:
+      return (plain == FORMAT_NCHW) || (plain == FORMAT_NHWC) || (plain == FORMAT_HWCN);
+    case FORMAT_FRACTAL_Z_3D:
+      return plain == FORMAT_DHWCN;
+    case FORMAT_C1HWNCoC0:
+      return plain == FORMAT_HWCN;
+    default:
+      return false;
+  }
+}
+
+inline Status BuildPackedDesc(const Format plain_format, const std::vector<int64_t> &plain_shape,
+                              const Format packed_format, const int64_t c0, const bool to_packed,
+                              TiledTransferDesc &desc) {
+  std::vector<TiledAxis> plain_axes = GetPlainAxes(plain_format);
+  if (plain_axes.size() != plain_shape.size()) {
+    GELOGE(PARAM_INVALID, "[Check][Shape] shape %s does not match format %s", ShapeToString(plain_shape).c_str(),
+           TypeUtils::FormatToSerialString(plain_format).c_str());
+    return PARAM_INVALID;
+  }
+  desc.dims.assign(kTiledDimsNum, TiledDim{1, 1});
+  for (size_t i = 0U; i < plain_axes.size(); ++i) {
+    desc.dims[plain_axes[i].dim].size = plain_shape[i];
+  }
+  std::vector<TiledAxis> packed_axes = GetPackedAxes(packed_format, c0, desc.dims);
+  desc.src_axes = to_packed ? plain_axes : packed_axes;
+  desc.dst_axes = to_packed ? packed_axes : plain_axes;
+  return SUCCESS;
+}
+
+// FRACTAL_NZ is [..., W1, H1, H0, W0] and FRACTAL_ZZ is [..., H1, W1, H0, W0] of ND [..., H, W]
+inline Status BuildFractalDesc(const std::vector<int64_t> &nd_shape, const Format fractal_format, const int64_t c0,
+                               const bool to_fractal, TiledTransferDesc &desc) {
+  constexpr size_t kBatch = 0U;
+  constexpr size_t kHeight = 1U;
+  constexpr size_t kWidth = 2U;
+  if (nd_shape.size() < 2U) {
+    // rank 1 and scalar are padded to 2D by TransDataFormat, not handled here
+    GELOGD("Rank of shape %s is less than 2, tiled transfer is not supported", ShapeToString(nd_shape).c_str());
+    return UNSUPPORTED;
+  }
+  int64_t batch = 1;
+  for (size_t i = 0U; i + 2U < nd_shape.size(); ++i) {
+    batch *= nd_shape[i];
+  }
+  desc.dims = {TiledDim{batch, 1}, TiledDim{nd_shape[nd_shape.size() - 2U], kNiSize},
+               TiledDim{nd_shape.back(), c0}};
+  const std::vector<TiledAxis> nd_axes = {Whole(kBatch), Whole(kHeight), Whole(kWidth)};
+  const std::vector<TiledAxis> fractal_axes =
+      (fractal_format == FORMAT_FRACTAL_NZ)
+          ? std::vector<TiledAxis>{Whole(kBatch), Outer(kWidth), Outer(kHeight), Inner(kHeight), Inner(kWidth)}
+          : std::vector<TiledAxis>{Whole(kBatch), Outer(kHeight), Outer(kWidth), Inner(kHeight), Inner(kWidth)};
+  desc.src_axes = to_fractal ? nd_axes : fractal_axes;
+  desc.dst_axes = to_fractal ? fractal_axes : nd_axes;
+  return SUCCESS;
+}
+
+inline Status BuildTransposeDesc(const TransArgs &args, TiledTransferDesc &desc) {
+  const std::vector<TiledAxis> src_axes = GetPlainAxes(args.src_primary_format);
+  const std::vector<TiledAxis> dst_axes = GetPlainAxes(args.dst_primary_format);
+  if ((src_axes.size() != args.src_shape.size()) || (dst_axes.size() != src_axes.size())) {
+    GELOGE(PARAM_INVALID, "[Check][Shape] shape %s does not match format %s",
+           ShapeToString(args.src_shape).c_str(), TypeUtils::FormatToSerialString(args.src_primary_format).c_str());
+    return PARAM_INVALID;
+  }
+  desc.dims.assign(kTiledDimsNum, TiledDim{1, 1});
+  for (size_t i = 0U; i < src_axes.size(); ++i) {
+    desc.dims[src_axes[i].dim].size = args.src_shape[i];
+  }
+  desc.src_axes = src_axes;
+  desc.dst_axes = dst_axes;
+  return SUCCESS;
+}
+
+inline bool IsNdLike(const Format format) {
+  return (format == FORMAT_ND) || (format == FORMAT_NCHW) || (format == FORMAT_NHWC);
+}
+}  // namespace tiled
+
+/**
+ * Describe the transfer of args as a permutation of split dims
+ * @param args
+ * @param desc
+ * @return UNSUPPORTED if the transfer is not a pure layout permutation, e.g. FRACTAL_Z with groups or FRACTAL_Z_C04
+ */
+inline Status BuildTiledTransferDesc(const TransArgs &args, TiledTransferDesc &desc) {
+  const Format src = args.src_primary_format;
+  const Format dst = args.dst_primary_format;
+  const int32_t type_size = GetSizeByDataType(args.src_data_type);
+  if ((type_size <= 0) || (static_cast<int32_t>(args.src_sub_format) > 1) ||
+      (static_cast<int32_t>(args.dst_sub_format) > 1) || (args.src_c0_format != 0) || (args.dst_c0_format != 0)) {
+    return UNSUPPORTED;
+  }
+  desc.type_size = static_cast<size_t>(type_size);
+  const int64_t c0 = GetCubeSizeByDataType(args.src_data_type);
+  Status ret = UNSUPPORTED;
+  if (tiled::IsPackedPairSupport(src, dst)) {
+    ret = tiled::BuildPackedDesc(src, args.src_shape, dst, c0, true, desc);
+  } else if (tiled::IsPackedPairSupport(dst, src)) {
+    ret = tiled::BuildPackedDesc(dst, args.dst_shape, src, c0, false, desc);
+  } else if (((dst == FORMAT_FRACTAL_NZ) && tiled::IsNdLike(src)) || ((dst == FORMAT_FRACTAL_ZZ) && (src == FORMAT_ND))) {
+    ret = tiled::BuildFractalDesc(args.src_shape, dst, c0, true, desc);
+  } else if (((src == FORMAT_FRACTAL_NZ) && tiled::IsNdLike(dst)) || ((src == FORMAT_FRACTAL_ZZ) && (dst == FORMAT_ND))) {
+    ret = tiled::BuildFractalDesc(args.dst_shape, src, c0, false, desc);
+  } else if ((src != dst) && (!tiled::GetPlainAxes(src).empty()) && (!tiled::GetPlainAxes(dst).empty()) &&
+             (src != FORMAT_DHWCN) && (dst != FORMAT_DHWCN)) {
+    ret = tiled::BuildTransposeDesc(args, desc);
+  }
+  if (ret != SUCCESS) {
+    return ret;
+  }
+  // the layout must agree with the dst shape given by caller, e.g. the same C0
+  if (!args.dst_shape.empty()) {
+    int64_t dst_num = 1;
+    for (const int64_t dim : args.dst_shape) {
+      dst_num *= dim;
+    }
+    if (dst_num != TiledTransferEngine::GetLayoutElementNum(desc.dims, desc.dst_axes)) {
+      GELOGW("Dst shape %s does not match the tiled layout from %s to %s", ShapeToString(args.dst_shape).c_str(),
+             TypeUtils::FormatToSerialString(src).c_str(), TypeUtils::FormatToSerialString(dst).c_str());
+      return UNSUPPORTED;
+    }
+  }
+  return SUCCESS;
+}
+
+inline bool IsTiledTransFormatSupport(const TransArgs &args) {
+  TiledTransferDesc desc;
+  return BuildTiledTransferDesc(args, desc) == SUCCESS;
+}
+
+/**
+ * Convert the data format by the cache blocked and multi-threaded engine
+ * @param args
+ * @param result
+ * @param dst buffer supplied by caller, nullptr to allocate one. If supplied, result.data does not own it.
+ * @param dst_size bytes of dst
+ * @param pool owned by caller and used for large transfers, nullptr to run on caller thread
+ * @return UNSUPPORTED if the transfer should go through TransDataFormat
+ */
+inline Status TransDataFormatTiled(const TransArgs &args, TransResult &result, uint8_t *const dst = nullptr,
+                                   const size_t dst_size = 0U, WorkStealingThreadPool *const pool = nullptr) {
+  TiledTransferDesc desc;
+  const Status ret = BuildTiledTransferDesc(args, desc);
+  if (ret != SUCCESS) {
+    return ret;
+  }
+  const size_t src_size =
+      static_cast<size_t>(TiledTransferEngine::GetLayoutElementNum(desc.dims, desc.src_axes)) * desc.type_size;
+  const size_t total_size =
+      static_cast<size_t>(TiledTransferEngine::GetLayoutElementNum(desc.dims, desc.dst_axes)) * desc.type_size;
+  std::shared_ptr<uint8_t> dst_holder;
+  if (dst != nullptr) {
+    if (dst_size < total_size) {
+      GELOGE(PARAM_INVALID, "[Check][Param] dst size %zu is less than %zu", dst_size, total_size);
+      REPORT_INNER_ERROR("E19999", "dst size %zu is less than %zu", dst_size, total_size);
+      return PARAM_INVALID;
+    }
+    dst_holder.reset(dst, [](const uint8_t *const ptr) { (void)ptr; });
+  } else if (total_size > 0U) {
+    dst_holder.reset(new (std::nothrow) uint8_t[total_size], std::default_delete<uint8_t[]>());
+    if (dst_holder == nullptr) {
+      GELOGE(ACL_ERROR_GE_MEMORY_ALLOCATION, "[Allocate][DSTMemory] failed, memory size %zu", total_size);
+      REPORT_CALL_ERROR("E19999", "Failed to allocate memory for dst buf %zu", total_size);
+      return ACL_ERROR_GE_MEMORY_ALLOCATION;
+    }
+  }
+  const Status run_ret = TiledTransferEngine::Run(desc, args.data, src_size, dst_holder.get(), total_size, pool);
+  if (run_ret != SUCCESS) {
+    GELOGE(run_ret, "[Trans][Format] tiled transfer from %s to %s failed, shape %s",
+           TypeUtils::FormatToSerialString(args.src_format).c_str(),
+           TypeUtils::FormatToSerialString(args.dst_format).c_str(), ShapeToString(args.src_shape).c_str());
+    return run_ret;
+  }
+  result.data = dst_holder;
+  result.length = total_size;
+  return SUCCESS;
+}
+}  // namespace formats
+}  // namespace ge
+#endif  // GE_COMMON_FORMATS_TILED_FORMAT_TRANSFER_H_
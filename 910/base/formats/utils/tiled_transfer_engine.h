@@ -0,0 +1,484 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_FORMATS_UTILS_TILED_TRANSFER_ENGINE_H_
+#define GE_COMMON_FORMATS_UTILS_TILED_TRANSFER_ENGINE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <vector>
+
+#include "common/work_stealing_thread_pool.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace ge {
+namespace formats {
+constexpr int64_t kTiledBlockSize = 64;                       // elements of one cache block on the strided axis
+constexpr size_t kTiledParallelThreshold = 1024U * 1024U;     // bytes, smaller transfers run on caller thread
+
+/**
+ * Which part of a logical dim an axis of a layout holds. A dim with tile T is split into
+ * outer = ceil(size / T) and inner = T, the padded tail of the last tile is filled with zero.
+ */
+enum class TiledAxisPart {
+  kWhole,
+  kOuter,
+  kInner
+};
+
+struct TiledDim {
+  int64_t size;
+  int64_t tile;
+};
+
+struct TiledAxis {
+  size_t dim;
+  TiledAxisPart part;
+};
+
+/**
+ * Layout transfer described as a permutation of split logical dims, both layouts are dense and row major
+ * over their axes. Every transfer between plain and packed formats (5HD, FRACTAL_Z, FRACTAL_NZ, transpose ...)
+ * is such a permutation. An axis listed twice in a layout addresses its diagonal, e.g. Co and C0 of C1HWNCoC0,
+ * off diagonal elements of the dst are filled with zero.
+ */
+struct TiledTransferDesc {
+  std::vector<TiledDim> dims;
+  std::vector<TiledAxis> src_axes;
+  std::vector<TiledAxis> dst_axes;
+  size_t type_size;
+};
+
+class TiledTransferEngine {
+ public:
+  static int64_t GetAxisExtent(const TiledDim &dim, const TiledAxisPart part) {
+    switch (part) {
+      case TiledAxisPart::kOuter:
+        return (dim.size + dim.tile - 1) / dim.tile;
+      case TiledAxisPart::kInner:
+        return dim.tile;
+      default:
+        return dim.size;
+    }
+  }
+
+  static int64_t GetLayoutElementNum(const std::vector<TiledDim> &dims, const std::vector<TiledAxis> &axes) {
+    int64_t num = 1;
+    for (const auto &axis : axes) {
+      num *= GetAxisExtent(dims[axis.dim], axis.part);
+    }
+    return num;
+  }
+
+  /**
+   * Transfer src to dst, dst is supplied by caller and every byte of the dst layout is written
+   * @param desc
+   * @param src
+   * @param src_size bytes of src, at least the size of src layout
+   * @param dst
+   * @param dst_size bytes of dst, at least the size of dst layout
+   * @param pool splits transfers of kTiledParallelThreshold bytes or more, nullptr to run on caller thread.
+   *        Called from a worker of the pool, the transfer runs on caller thread.
+   *        The pool is owned by caller, the engine keeps no thread of its own.
+   * @return
+   */
+  static Status Run(const TiledTransferDesc &desc, const uint8_t *const src, const size_t src_size,
+                    uint8_t *const dst, const size_t dst_size, WorkStealingThreadPool *const pool = nullptr) {
+    Plan plan;
+    const Status ret = BuildPlan(desc, plan);
+    if (ret != SUCCESS) {
+      return ret;
+    }
+    // src is checked against the elements actually read, dst is written as a whole
+    const int64_t src_num = plan.src_extent;
+    const int64_t dst_num = GetLayoutElementNum(desc.dims, desc.dst_axes);
+    if ((static_cast<uint64_t>(src_num) * desc.type_size > src_size) ||
+        (static_cast<uint64_t>(dst_num) * desc.type_size > dst_size)) {
+      GELOGE(PARAM_INVALID, "[Check][Size] src size %zu or dst size %zu is less than %ld/%ld elements of %zu bytes",
+             src_size, dst_size, src_num, dst_num, desc.type_size);
+      return PARAM_INVALID;
+    }
+    if (dst_num == 0) {
+      return SUCCESS;
+    }
+    if ((src == nullptr) || (dst == nullptr)) {
+      GELOGE(PARAM_INVALID, "[Check][Param] src or dst is nullptr");
+      return PARAM_INVALID;
+    }
+    if (plan.has_diagonal) {
+      (void)memset(dst, 0, static_cast<size_t>(dst_num) * desc.type_size);
+    }
+    const int64_t work_num = plan.outer_num * plan.tile_num;
+    const uint64_t total_bytes = static_cast<uint64_t>(dst_num) * desc.type_size;
+    if ((pool == nullptr) || (pool->GetThreadNum() <= 1U) || pool->IsInWorkerThread() ||
+        (total_bytes < kTiledParallelThreshold) || (work_num <= 1)) {
+      RunRange(plan, src, dst, 0, work_num);
+      return SUCCESS;
+    }
+    const int64_t part_num = std::min(work_num, static_cast<int64_t>(pool->GetThreadNum()) * 4);
+    const int64_t part_size = (work_num + part_num - 1) / part_num;
+    std::vector<std::future<void>> futures;
+    futures.reserve(static_cast<size_t>(part_num));
+    for (int64_t begin = 0; begin < work_num; begin += part_size) {
+      const int64_t end = std::min(work_num, begin + part_size);
+      auto future = pool->commit([&plan, src, dst, begin, end]() { RunRange(plan, src, dst, begin, end); });
+      if (!future.valid()) {
+        GELOGW("Tiled transfer runs work items from %ld on caller thread, thread pool is unavailable", begin);
+        RunRange(plan, src, dst, begin, work_num);
+        break;
+      }
+      futures.emplace_back(std::move(future));
+    }
+    // parts in the pool refer to plan and dst, all of them must be done before return
+    Status status = SUCCESS;
+    for (auto &future : futures) {
+      try {
+        future.get();
+      } catch (const std::exception &e) {
+        GELOGE(FAILED, "[Run][Transfer] part of tiled transfer failed: %s", e.what());
+        status = FAILED;
+      } catch (...) {
+        GELOGE(FAILED, "[Run][Transfer] part of tiled transfer failed with unknown exception");
+        status = FAILED;
+      }
+    }
+    return status;
+  }
+
+ private:
+  struct LoopAxis {
+    int64_t extent;
+    int64_t src_stride;
+    int64_t dst_stride;
+    size_t dim;
+    int64_t mult;   // contribution of one step to the coordinate of dim
+    bool checked;   // dim has a partial last tile, coordinates must be compared with dim size
+  };
+
+  struct Plan {
+    std::vector<LoopAxis> axes;    // in dst order, the last one is the innermost
+    std::vector<int64_t> dim_sizes;
+    std::vector<bool> dst_padded;  // dst holds the padding of dim, invalid coordinates are written as zero
+    std::vector<size_t> checked_dims;
+    size_t outer_rank = 0U;        // axes looped outside of a row, blocked axis excluded
+    bool blocked = false;          // second innermost axis is looped per block of innermost axis
+    bool has_diagonal = false;
+    int64_t outer_num = 1;
+    int64_t tile_num = 1;
+    int64_t src_extent = 0;        // 1 + the largest src offset read, 0 if nothing is read
+    size_t type_size = 0U;
+  };
+
+  struct DimStrides {
+    int64_t outer = 0;
+    int64_t inner = 0;
+    int32_t whole_num = 0;
+    int32_t outer_num = 0;
+    int32_t inner_num = 0;
+  };
+
+  static Status CollectStrides(const TiledTransferDesc &desc, const std::vector<TiledAxis> &axes,
+                               std::vector<DimStrides> &strides) {
+    strides.assign(desc.dims.size(), DimStrides());
+    int64_t stride = 1;
+    for (size_t i = axes.size(); i > 0U; --i) {
+      const TiledAxis &axis = axes[i - 1U];
+      if (axis.dim >= desc.dims.size()) {
+        GELOGE(PARAM_INVALID, "[Check][Param] axis %zu refers dim %zu, dim num %zu", i - 1U, axis.dim,
+               desc.dims.size());
+        return PARAM_INVALID;
+      }
+      const TiledDim &dim = desc.dims[axis.dim];
+      DimStrides &dim_strides = strides[axis.dim];
+      if (axis.part == TiledAxisPart::kWhole) {
+        dim_strides.outer += stride * dim.tile;
+        dim_strides.inner += stride;
+        ++dim_strides.whole_num;
+      } else if (axis.part == TiledAxisPart::kOuter) {
+        dim_strides.outer += stride;
+        ++dim_strides.outer_num;
+      } else {
+        dim_strides.inner += stride;
+        ++dim_strides.inner_num;
+      }
+      stride *= GetAxisExtent(dim, axis.part);
+    }
+    for (size_t i = 0U; i < strides.size(); ++i) {
+      const DimStrides &dim_strides = strides[i];
+      const bool is_whole = (dim_strides.whole_num > 0) && (dim_strides.outer_num == 0) && (dim_strides.inner_num == 0);
+      const bool is_split = (dim_strides.whole_num == 0) && (dim_strides.outer_num > 0) && (dim_strides.inner_num > 0);
+      const bool is_unused = (dim_strides.whole_num == 0) && (dim_strides.outer_num == 0) &&
+                             (dim_strides.inner_num == 0) && (desc.dims[i].size == 1);
+      if ((!is_whole) && (!is_split) && (!is_unused)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] dim %zu must be used either whole or as both outer and inner", i);
+        return PARAM_INVALID;
+      }
+    }
+    return SUCCESS;
+  }
+
+  // only coordinates inside the dim sizes are read from src, the offset of a coordinate is the sum over dims
+  static int64_t GetSrcExtent(const TiledTransferDesc &desc, const std::vector<DimStrides> &strides) {
+    int64_t max_offset = 0;
+    for (size_t i = 0U; i < desc.dims.size(); ++i) {
+      const TiledDim &dim = desc.dims[i];
+      if (dim.size == 0) {
+        return 0;
+      }
+      const int64_t last_outer = (dim.size - 1) / dim.tile;
+      const int64_t last_inner = (dim.size - 1) % dim.tile;
+      int64_t dim_max = (last_outer * strides[i].outer) + (last_inner * strides[i].inner);
+      if (last_outer > 0) {
+        dim_max = std::max(dim_max, ((last_outer - 1) * strides[i].outer) + ((dim.tile - 1) * strides[i].inner));
+      }
+      max_offset += dim_max;
+    }
+    return max_offset + 1;
+  }
+
+  static void AddLoopAxis(Plan &plan, const LoopAxis &axis) {
+    if (axis.extent == 1) {
+      return;
+    }
+    if ((!plan.axes.empty()) && (!axis.checked) && (!plan.axes.back().checked) &&
+        (plan.axes.back().src_stride == axis.src_stride * axis.extent) &&
+        (plan.axes.back().dst_stride == axis.dst_stride * axis.extent)) {
+      LoopAxis &merged = plan.axes.back();
+      merged.extent *= axis.extent;
+      merged.src_stride = axis.src_stride;
+      merged.dst_stride = axis.dst_stride;
+      return;
+    }
+    plan.axes.emplace_back(axis);
+  }
+
+  static Status BuildPlan(const TiledTransferDesc &desc, Plan &plan) {
+    if ((desc.type_size == 0U) || desc.dims.empty()) {
+      GELOGE(PARAM_INVALID, "[Check][Param] type size %zu, dim num %zu", desc.type_size, desc.dims.size());
+      return PARAM_INVALID;
+    }
+    for (size_t i = 0U; i < desc.dims.size(); ++i) {
+      if ((desc.dims[i].size < 0) || (desc.dims[i].tile <= 0)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] dim %zu size %ld tile %ld is invalid", i, desc.dims[i].size,
+               desc.dims[i].tile);
+        return PARAM_INVALID;
+      }
+    }
+    std::vector<DimStrides> src_strides;
+    std::vector<DimStrides> dst_strides;
+    if ((CollectStrides(desc, desc.src_axes, src_strides) != SUCCESS) ||
+        (CollectStrides(desc, desc.dst_axes, dst_strides) != SUCCESS)) {
+      return PARAM_INVALID;
+    }
+    plan.type_size = desc.type_size;
+    plan.src_extent = GetSrcExtent(desc, src_strides);
+    plan.dim_sizes.resize(desc.dims.size());
+    plan.dst_padded.resize(desc.dims.size());
+    std::vector<bool> added_outer(desc.dims.size(), false);
+    std::vector<bool> added_inner(desc.dims.size(), false);
+    for (size_t i = 0U; i < desc.dims.size(); ++i) {
+      const TiledDim &dim = desc.dims[i];
+      plan.dim_sizes[i] = dim.size;
+      plan.dst_padded[i] = (dst_strides[i].whole_num == 0);
+      const bool checked = (dim.size % dim.tile) != 0;
+      if (checked) {
+        plan.checked_dims.emplace_back(i);
+      }
+      plan.has_diagonal = plan.has_diagonal || (dst_strides[i].whole_num > 1) || (dst_strides[i].outer_num > 1) ||
+                          (dst_strides[i].inner_num > 1);
+    }
+    for (const auto &axis : desc.dst_axes) {
+      const TiledDim &dim = desc.dims[axis.dim];
+      const bool checked = (dim.size % dim.tile) != 0;
+      const LoopAxis outer{GetAxisExtent(dim, TiledAxisPart::kOuter), src_strides[axis.dim].outer,
+                           dst_strides[axis.dim].outer, axis.dim, dim.tile, checked};
+      const LoopAxis inner{dim.tile, src_strides[axis.dim].inner, dst_strides[axis.dim].inner, axis.dim, 1, checked};
+      if (((axis.part == TiledAxisPart::kWhole) || (axis.part == TiledAxisPart::kOuter)) && (!added_outer[axis.dim])) {
+        added_outer[axis.dim] = true;
+        AddLoopAxis(plan, outer);
+      }
+      if (((axis.part == TiledAxisPart::kWhole) || (axis.part == TiledAxisPart::kInner)) && (!added_inner[axis.dim])) {
+        added_inner[axis.dim] = true;
+        AddLoopAxis(plan, inner);
+      }
+    }
+    if (plan.axes.empty()) {
+      plan.axes.emplace_back(LoopAxis{1, 0, 0, 0U, 0, false});
+    }
+    const size_t rank = plan.axes.size();
+    const LoopAxis &innermost = plan.axes.back();
+    // innermost dst axis is strided in src while the next one is contiguous: loop the next axis inside blocks of
+    // the innermost one, so cache lines of src loaded by one row are reused by the following rows
+    plan.blocked = (rank >= 2U) && (innermost.extent > kTiledBlockSize) && (innermost.src_stride != 1) &&
+                   (plan.axes[rank - 2U].src_stride == 1);
+    plan.outer_rank = plan.blocked ? (rank - 2U) : (rank - 1U);
+    plan.tile_num = plan.blocked ? ((innermost.extent + kTiledBlockSize - 1) / kTiledBlockSize) : 1;
+    for (size_t i = 0U; i < plan.outer_rank; ++i) {
+      plan.outer_num *= plan.axes[i].extent;
+    }
+    return SUCCESS;
+  }
+
+  template <typename T>
+  static void CopyRow(const uint8_t *const src, const int64_t src_stride, uint8_t *const dst, const int64_t dst_stride,
+                      const int64_t num) {
+    if ((src_stride == 1) && (dst_stride == 1)) {
+      (void)memcpy(dst, src, static_cast<size_t>(num) * sizeof(T));
+      return;
+    }
+    const T *const src_data = reinterpret_cast<const T *>(src);
+    T *const dst_data = reinterpret_cast<T *>(dst);
+    for (int64_t i = 0; i < num; ++i) {
+      dst_data[i * dst_stride] = src_data[i * src_stride];
+    }
+  }
+
+  static void CopyRow(const Plan &plan, const uint8_t *const src, const int64_t src_stride, uint8_t *const dst,
+                      const int64_t dst_stride, const int64_t num) {
+    switch (plan.type_size) {
+      case sizeof(uint8_t):
+        CopyRow<uint8_t>(src, src_stride, dst, dst_stride, num);
+        break;
+      case sizeof(uint16_t):
+        CopyRow<uint16_t>(src, src_stride, dst, dst_stride, num);
+        break;
+      case sizeof(uint32_t):
+        CopyRow<uint32_t>(src, src_stride, dst, dst_stride, num);
+        break;
+      case sizeof(uint64_t):
+        CopyRow<uint64_t>(src, src_stride, dst, dst_stride, num);
+        break;
+      default:
+        for (int64_t i = 0; i < num; ++i) {
+          (void)memcpy(dst + static_cast<size_t>(i * dst_stride) * plan.type_size,
+                       src + static_cast<size_t>(i * src_stride) * plan.type_size, plan.type_size);
+        }
+        break;
+    }
+  }
+
+  static void ZeroRow(const Plan &plan, uint8_t *const dst, const int64_t dst_stride, const int64_t num) {
+    if (dst_stride == 1) {
+      (void)memset(dst, 0, static_cast<size_t>(num) * plan.type_size);
+      return;
+    }
+    for (int64_t i = 0; i < num; ++i) {
+      (void)memset(dst + static_cast<size_t>(i * dst_stride) * plan.type_size, 0, plan.type_size);
+    }
+  }
+
+  // elements [begin, end) of the innermost axis, coords hold the coordinates of the other axes
+  static void RunRow(const Plan &plan, const uint8_t *const src, uint8_t *const dst, const int64_t src_offset,
+                     const int64_t dst_offset, const std::vector<int64_t> &coords, const int64_t begin,
+                     const int64_t end) {
+    const LoopAxis &axis = plan.axes.back();
+    bool others_valid = true;
+    for (const size_t dim : plan.checked_dims) {
+      if ((axis.checked && (dim == axis.dim)) || (coords[dim] < plan.dim_sizes[dim])) {
+        continue;
+      }
+      if (!plan.dst_padded[dim]) {
+        return;  // the row does not exist in dst
+      }
+      others_valid = false;
+    }
+    const int64_t num = end - begin;
+    int64_t valid_num = num;
+    if (axis.checked) {
+      const int64_t remain = plan.dim_sizes[axis.dim] - coords[axis.dim];
+      const int64_t valid_end = (remain <= 0) ? 0 : ((remain + axis.mult - 1) / axis.mult);
+      valid_num = std::max(static_cast<int64_t>(0), std::min(valid_end - begin, num));
+    }
+    const bool pad_tail = axis.checked && plan.dst_padded[axis.dim];
+    uint8_t *const dst_row = dst + static_cast<size_t>(dst_offset + begin * axis.dst_stride) * plan.type_size;
+    if (!others_valid) {
+      ZeroRow(plan, dst_row, axis.dst_stride, pad_tail ? num : valid_num);
+      return;
+    }
+    const uint8_t *const src_row = src + static_cast<size_t>(src_offset + begin * axis.src_stride) * plan.type_size;
+    CopyRow(plan, src_row, axis.src_stride, dst_row, axis.dst_stride, valid_num);
+    if (pad_tail && (valid_num < num)) {
+      ZeroRow(plan, dst_row + static_cast<size_t>(valid_num * axis.dst_stride) * plan.type_size, axis.dst_stride,
+              num - valid_num);
+    }
+  }
+
+  static void RunBlock(const Plan &plan, const uint8_t *const src, uint8_t *const dst, const int64_t src_offset,
+                       const int64_t dst_offset, std::vector<int64_t> &coords, const int64_t tile) {
+    if (!plan.blocked) {
+      RunRow(plan, src, dst, src_offset, dst_offset, coords, 0, plan.axes.back().extent);
+      return;
+    }
+    const LoopAxis &row_axis = plan.axes[plan.axes.size() - 2U];
+    const int64_t begin = tile * kTiledBlockSize;
+    const int64_t end = std::min(plan.axes.back().extent, begin + kTiledBlockSize);
+    const int64_t saved_coord = coords[row_axis.dim];
+    for (int64_t i = 0; i < row_axis.extent; ++i) {
+      if (row_axis.checked) {
+        coords[row_axis.dim] = saved_coord + i * row_axis.mult;
+      }
+      RunRow(plan, src, dst, src_offset + i * row_axis.src_stride, dst_offset + i * row_axis.dst_stride, coords,
+             begin, end);
+    }
+    coords[row_axis.dim] = saved_coord;
+  }
+
+  static void RunRange(const Plan &plan, const uint8_t *const src, uint8_t *const dst, const int64_t begin,
+                       const int64_t end) {
+    if (begin >= end) {
+      return;
+    }
+    std::vector<int64_t> counter(plan.outer_rank, 0);
+    std::vector<int64_t> coords(plan.dim_sizes.size(), 0);
+    int64_t src_offset = 0;
+    int64_t dst_offset = 0;
+    int64_t outer_index = begin / plan.tile_num;
+    for (size_t i = plan.outer_rank; i > 0U; --i) {
+      const LoopAxis &axis = plan.axes[i - 1U];
+      counter[i - 1U] = outer_index % axis.extent;
+      outer_index /= axis.extent;
+      src_offset += counter[i - 1U] * axis.src_stride;
+      dst_offset += counter[i - 1U] * axis.dst_stride;
+      coords[axis.dim] += counter[i - 1U] * axis.mult;
+    }
+    for (int64_t work = begin; work < end; ++work) {
+      const int64_t tile = work % plan.tile_num;
+      if ((tile == 0) && (work != begin)) {
+        for (size_t i = plan.outer_rank; i > 0U; --i) {
+          const LoopAxis &axis = plan.axes[i - 1U];
+          src_offset += axis.src_stride;
+          dst_offset += axis.dst_stride;
+          coords[axis.dim] += axis.mult;
+          if (++counter[i - 1U] < axis.extent) {
+            break;
+          }
+          src_offset -= axis.src_stride * axis.extent;
+          dst_offset -= axis.dst_stride * axis.extent;
+          coords[axis.dim] -= axis.mult * axis.extent;
+          counter[i - 1U] = 0;
+        }
+      }
+      RunBlock(plan, src, dst, src_offset, dst_offset, coords, tile);
+    }
+  }
+};
+}  // namespace formats
+}  // namespace ge
+#endif  // GE_COMMON_FORMATS_UTILS_TILED_TRANSFER_ENGINE_H_
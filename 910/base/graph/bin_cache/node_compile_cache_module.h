@@ -17,11 +17,28 @@
 #ifndef AIR_CXX_EXECUTOR_HYBRID_COMMON_BIN_CACHE_NODE_COMPILE_CACHE_MODULE_H_
 #define AIR_CXX_EXECUTOR_HYBRID_COMMON_BIN_CACHE_NODE_COMPILE_CACHE_MODULE_H_
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 #include "graph/op_desc.h"
 #include "ge/ge_api_types.h"
 #include "graph/node.h"
+#include "graph/op_kernel_bin.h"
+#include "graph/debug/ge_attr_define.h"
+#include "graph/utils/attr_utils.h"
 #include "proto/task.pb.h"
 #include "graph/cache_policy/cache_policy.h"
+#include "graph/bin_cache/persistent_compile_cache.h"
+#include "common/plugin/ge_util.h"
+#include "common/tbe_handle_store/bin_register_utils.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/types.h"
+#include "framework/common/util.h"
 #include "register/op_tiling_info.h"
 
 namespace ge {
@@ -82,7 +99,290 @@ class NodeCompileCacheModule {
   NodeCompileCacheItem *FindCompileCache(const NodePtr &node);
   NodeCompileCacheItem *AddCompileCache(const NodePtr &node, NodeCompileCacheItem &item);
 
+  /**
+   * @brief enable on-disk tier behind the in-memory cache, compiled binaries then survive process restart.
+   *        Lookups running meanwhile keep the tier they started with, it is freed after the last of them
+   * @param options cache dir, version and size bound of the tier
+   */
+  Status EnablePersistentCache(const PersistentCompileCacheOptions &options) {
+    const std::shared_ptr<PersistentCompileCache> persistent_cache = MakeShared<PersistentCompileCache>();
+    GE_CHECK_NOTNULL(persistent_cache);
+    GE_CHK_STATUS_RET(persistent_cache->Initialize(options), "[Init][PersistentCache] dir:%s",
+                      options.cache_dir.c_str());
+    const std::lock_guard<std::mutex> lock(persistent_cache_mu_);
+    persistent_cache_ = persistent_cache;
+    return SUCCESS;
+  }
+  std::shared_ptr<PersistentCompileCache> GetPersistentCache() const {
+    const std::lock_guard<std::mutex> lock(persistent_cache_mu_);
+    return persistent_cache_;
+  }
+
+  /**
+   * @brief find compile cache of node in memory, then in the persistent tier. On a persistent hit the compile
+   *        results are restored on op desc of node and restored is set, caller registers the bin as after compiling
+   *        and calls AddCompileCacheAndPersist without compiling the node
+   * @param attr_names names of bin attrs on op desc, the same as used for registering the bin
+   */
+  NodeCompileCacheItem *FindCompileCacheOrRestore(const NodePtr &node, const AttrNameOfBinOnOp &attr_names,
+                                                  bool &restored) {
+    restored = false;
+    NodeCompileCacheItem *const item = FindCompileCache(node);
+    if (item != nullptr) {
+      return item;
+    }
+    const std::shared_ptr<PersistentCompileCache> persistent_cache = GetPersistentCache();
+    if (persistent_cache == nullptr) {
+      return nullptr;
+    }
+    std::string key;
+    std::vector<uint8_t> record;
+    if ((GetPersistentCacheKey(node, key) != SUCCESS) || (!persistent_cache->Load(key, record))) {
+      return nullptr;
+    }
+    if (RestoreCompileResult(record, attr_names, *node->GetOpDesc()) != SUCCESS) {
+      GELOGW("[%s] compile result in persistent cache is invalid, node is compiled again", node->GetName().c_str());
+      return nullptr;
+    }
+    GELOGD("[%s] compile result is restored from persistent cache", node->GetName().c_str());
+    restored = true;
+    return nullptr;
+  }
+
+  /**
+   * @brief add compile cache of node in memory, and write the compile results on op desc of node to the persistent
+   *        tier unless they were restored from it
+   */
+  NodeCompileCacheItem *AddCompileCacheAndPersist(const NodePtr &node, NodeCompileCacheItem &item,
+                                                  const AttrNameOfBinOnOp &attr_names, const bool restored) {
+    NodeCompileCacheItem *const added = AddCompileCache(node, item);
+    if ((added == nullptr) || restored) {
+      return added;
+    }
+    const std::shared_ptr<PersistentCompileCache> persistent_cache = GetPersistentCache();
+    if (persistent_cache == nullptr) {
+      return added;
+    }
+    std::string key;
+    std::string record;
+    if ((GetPersistentCacheKey(node, key) == SUCCESS) &&
+        (SerializeCompileResult(*node->GetOpDesc(), attr_names, record) == SUCCESS)) {
+      (void)persistent_cache->Store(key, reinterpret_cast<const uint8_t *>(record.data()), record.size());
+    }
+    return added;
+  }
+
+  /**
+   * @brief key of node in persistent cache: op type, tensor descs, attrs set before compiling and const input values,
+   *        all serialized in a stable order, so the same node gives the same key in another process
+   * @return NOT_CHANGED if node is not persisted, e.g. it has subgraphs
+   */
+  Status GetPersistentCacheKey(const NodePtr &node, std::string &key) const {
+    GE_CHECK_NOTNULL(node);
+    const OpDescPtr op_desc = node->GetOpDesc();
+    GE_CHECK_NOTNULL(op_desc);
+    if (!op_desc->GetSubgraphInstanceNames().empty()) {
+      return NOT_CHANGED;
+    }
+    key = op_desc->GetType();
+    key.push_back('\0');
+    for (const auto &tensor_desc : op_desc->GetAllInputsDescPtr()) {
+      AppendTensorDesc(tensor_desc, key);
+    }
+    key.push_back('\0');
+    for (const auto &tensor_desc : op_desc->GetAllOutputsDescPtr()) {
+      AppendTensorDesc(tensor_desc, key);
+    }
+    const auto all_attributes = op_desc->GetAllAttrs();
+    std::set<std::string> ordered_attr_names;
+    for (const auto &attr : all_attributes) {
+      if ((!attr.first.empty()) && (attr.first[0] != '_') && (!IsCompileResultAttr(attr.first))) {
+        (void)ordered_attr_names.insert(attr.first);
+      }
+    }
+    size_t attr_size = 0U;
+    GE_CHK_STATUS_RET_NOLOG(GetAttrTotalSize(all_attributes, ordered_attr_names, attr_size));
+    std::unique_ptr<uint8_t[]> attr_mem;
+    GE_CHK_STATUS_RET_NOLOG(CopyAttrToMem(all_attributes, attr_mem, ordered_attr_names, attr_size));
+    AppendValue(static_cast<uint64_t>(attr_size), key);
+    if (attr_size > 0U) {
+      (void)key.append(reinterpret_cast<const char_t *>(attr_mem.get()), attr_size);
+    }
+    for (const auto &in_anchor : node->GetAllInDataAnchors()) {
+      const auto peer_anchor = (in_anchor == nullptr) ? nullptr : in_anchor->GetPeerOutAnchor();
+      if ((peer_anchor == nullptr) || (peer_anchor->GetOwnerNode() == nullptr)) {
+        continue;
+      }
+      const NodePtr &peer_node = peer_anchor->GetOwnerNode();
+      if ((peer_node->GetType() != CONSTANT) && (peer_node->GetType() != CONSTANTOP)) {
+        continue;
+      }
+      ConstGeTensorPtr weight;
+      if (AttrUtils::GetTensor(peer_node->GetOpDesc(), ATTR_NAME_WEIGHTS, weight) && (weight != nullptr)) {
+        AppendValue(static_cast<int64_t>(in_anchor->GetIdx()), key);
+        AppendValue(static_cast<uint64_t>(weight->GetData().size()), key);
+        (void)key.append(reinterpret_cast<const char_t *>(weight->GetData().data()), weight->GetData().size());
+      }
+    }
+    return SUCCESS;
+  }
+
  private:
+  enum class CompileResultField : uint8_t {
+    kStrAttr = 0,
+    kIntAttr,
+    kKernelBin
+  };
+
+  // attrs written by compiling, saved in persistent records and kept out of keys
+  static bool IsCompileResultAttr(const std::string &name) {
+    return (name == COMPILE_INFO_JSON) || (name == COMPILE_INFO_KEY) || (name == kAttrOpParamSize) ||
+           (name == kAttrAtomicOpParamSize);
+  }
+
+  template <typename T>
+  static void AppendValue(const T value, std::string &buffer) {
+    (void)buffer.append(reinterpret_cast<const char_t *>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  static bool ReadValue(const std::vector<uint8_t> &buffer, size_t &offset, T &value) {
+    if ((buffer.size() < sizeof(value)) || (offset > (buffer.size() - sizeof(value)))) {
+      return false;
+    }
+    (void)memcpy(&value, buffer.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+  }
+
+  static void AppendBytes(const char_t *const data, const size_t size, std::string &buffer) {
+    AppendValue(static_cast<uint64_t>(size), buffer);
+    (void)buffer.append(data, size);
+  }
+
+  static bool ReadBytes(const std::vector<uint8_t> &buffer, size_t &offset, std::string &bytes) {
+    uint64_t size = 0UL;
+    if ((!ReadValue(buffer, offset, size)) || (size > (buffer.size() - offset))) {
+      return false;
+    }
+    bytes.assign(reinterpret_cast<const char_t *>(buffer.data() + offset), static_cast<size_t>(size));
+    offset += static_cast<size_t>(size);
+    return true;
+  }
+
+  static void AppendTensorDesc(const GeTensorDescPtr &tensor_desc, std::string &key) {
+    if (tensor_desc == nullptr) {
+      AppendValue(static_cast<int32_t>(-1), key);
+      return;
+    }
+    AppendValue(static_cast<int32_t>(tensor_desc->GetDataType()), key);
+    AppendValue(static_cast<int32_t>(tensor_desc->GetFormat()), key);
+    AppendValue(static_cast<int32_t>(tensor_desc->GetOriginFormat()), key);
+    const std::vector<int64_t> dims = tensor_desc->GetShape().GetDims();
+    AppendValue(static_cast<uint64_t>(dims.size()), key);
+    for (const int64_t dim : dims) {
+      AppendValue(dim, key);
+    }
+    std::vector<std::pair<int64_t, int64_t>> shape_range;
+    (void)tensor_desc->GetShapeRange(shape_range);
+    AppendValue(static_cast<uint64_t>(shape_range.size()), key);
+    for (const auto &range : shape_range) {
+      AppendValue(range.first, key);
+      AppendValue(range.second, key);
+    }
+  }
+
+  static std::vector<std::string> GetCompileResultStrAttrs(const OpDesc &op_desc,
+                                                           const AttrNameOfBinOnOp &attr_names) {
+    return {COMPILE_INFO_JSON, COMPILE_INFO_KEY, ATOMIC_COMPILE_INFO_JSON, ATOMIC_COMPILE_INFO_KEY,
+            attr_names.kTvmMetaData, attr_names.kTvmMagicName, op_desc.GetName() + attr_names.kKernelNameSuffix};
+  }
+
+  // record of the bin and the attrs compiling sets on op desc, fields are [type, name, value]
+  static Status SerializeCompileResult(const OpDesc &op_desc, const AttrNameOfBinOnOp &attr_names,
+                                       std::string &record) {
+    const OpKernelBinPtr kernel_bin = op_desc.TryGetExtAttr(attr_names.kTbeKernel, OpKernelBinPtr());
+    if ((kernel_bin == nullptr) || (kernel_bin->GetBinData() == nullptr)) {
+      GELOGD("[%s] has no kernel bin, compile result is not persisted", op_desc.GetName().c_str());
+      return NOT_CHANGED;
+    }
+    record.clear();
+    AppendValue(CompileResultField::kKernelBin, record);
+    AppendBytes(kernel_bin->GetName().data(), kernel_bin->GetName().size(), record);
+    AppendBytes(reinterpret_cast<const char_t *>(kernel_bin->GetBinData()), kernel_bin->GetBinDataSize(), record);
+    const std::vector<std::string> str_attrs = GetCompileResultStrAttrs(op_desc, attr_names);
+    for (size_t i = 0U; i < str_attrs.size(); ++i) {
+      std::string value;
+      if (AttrUtils::GetStr(op_desc, str_attrs[i], value)) {
+        AppendValue(CompileResultField::kStrAttr, record);
+        AppendValue(static_cast<uint64_t>(i), record);  // kernel name attr depends on node name, saved by index
+        AppendBytes(value.data(), value.size(), record);
+      }
+    }
+    for (const char_t *const name : {kAttrOpParamSize, kAttrAtomicOpParamSize}) {
+      int64_t value = 0;
+      if (AttrUtils::GetInt(op_desc, name, value)) {
+        AppendValue(CompileResultField::kIntAttr, record);
+        AppendBytes(name, strlen(name), record);
+        AppendValue(value, record);
+      }
+    }
+    return SUCCESS;
+  }
+
+  static Status RestoreCompileResult(const std::vector<uint8_t> &record, const AttrNameOfBinOnOp &attr_names,
+                                     OpDesc &op_desc) {
+    const std::vector<std::string> str_attrs = GetCompileResultStrAttrs(op_desc, attr_names);
+    OpKernelBinPtr kernel_bin;
+    std::vector<std::pair<std::string, std::string>> str_values;
+    std::vector<std::pair<std::string, int64_t>> int_values;
+    size_t offset = 0U;
+    while (offset < record.size()) {
+      CompileResultField field = CompileResultField::kStrAttr;
+      if (!ReadValue(record, offset, field)) {
+        return FAILED;
+      }
+      if (field == CompileResultField::kKernelBin) {
+        std::string name;
+        std::string bin;
+        if ((!ReadBytes(record, offset, name)) || (!ReadBytes(record, offset, bin))) {
+          return FAILED;
+        }
+        kernel_bin = MakeShared<OpKernelBin>(name, std::vector<char_t>(bin.begin(), bin.end()));
+        GE_CHECK_NOTNULL(kernel_bin);
+      } else if (field == CompileResultField::kStrAttr) {
+        uint64_t index = 0UL;
+        std::string value;
+        if ((!ReadValue(record, offset, index)) || (index >= str_attrs.size()) ||
+            (!ReadBytes(record, offset, value))) {
+          return FAILED;
+        }
+        str_values.emplace_back(str_attrs[static_cast<size_t>(index)], std::move(value));
+      } else if (field == CompileResultField::kIntAttr) {
+        std::string name;
+        int64_t value = 0;
+        if ((!ReadBytes(record, offset, name)) || (!ReadValue(record, offset, value))) {
+          return FAILED;
+        }
+        int_values.emplace_back(std::move(name), value);
+      } else {
+        return FAILED;
+      }
+    }
+    if (kernel_bin == nullptr) {
+      return FAILED;
+    }
+    // nothing is set on op desc until the whole record is parsed
+    (void)op_desc.SetExtAttr(attr_names.kTbeKernel, kernel_bin);
+    for (const auto &str_value : str_values) {
+      (void)AttrUtils::SetStr(op_desc, str_value.first, str_value.second);
+    }
+    for (const auto &int_value : int_values) {
+      (void)AttrUtils::SetInt(op_desc, int_value.first, int_value.second);
+    }
+    return SUCCESS;
+  }
+
   Status GetCompileCacheDescFromOp(const NodePtr &node, std::shared_ptr<CompileCacheDesc> &cache_desc,
                                    const bool need_range) const;
   Status GetOpAttrMem(OpDesc &op_desc, CompileCacheDesc &cache_desc) const;
@@ -105,6 +405,8 @@ class NodeCompileCacheModule {
   std::unordered_map<CacheItemId, NodeCompileCacheItem> ids_to_cci_;
   std::mutex node_to_cache_desc_map_mu_;
   std::unordered_map<uintptr_t, std::shared_ptr<CompileCacheDesc>> node_to_cache_desc_map_;
+  mutable std::mutex persistent_cache_mu_;
+  std::shared_ptr<PersistentCompileCache> persistent_cache_;
 };
 }  // namespace ge
 
@@ -0,0 +1,521 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AIR_CXX_EXECUTOR_HYBRID_COMMON_BIN_CACHE_PERSISTENT_COMPILE_CACHE_H_
+#define AIR_CXX_EXECUTOR_HYBRID_COMMON_BIN_CACHE_PERSISTENT_COMPILE_CACHE_H_
+#include <sys/file.h>  // flock, mmpa has no wrapper of it
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "mmpa/mmpa_api.h"
+
+namespace ge {
+constexpr uint32_t kCompileCacheMagic = 0x43434547U;  // "GECC"
+constexpr uint32_t kCompileCacheFormatVersion = 1U;
+constexpr uint64_t kDefaultCompileCacheMaxSize = 1024UL * 1024UL * 1024UL;
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037UL;
+constexpr uint64_t kFnvPrime = 1099511628211UL;
+
+/**
+ * @brief FNV-1a hash, the same bytes give the same value in every process and on every host
+ */
+inline uint64_t StableHash64(const void *const data, const size_t len, const uint64_t seed = kFnvOffsetBasis) {
+  const uint8_t *const bytes = static_cast<const uint8_t *>(data);
+  uint64_t hash = seed;
+  for (size_t i = 0U; i < len; ++i) {
+    hash ^= static_cast<uint64_t>(bytes[i]);
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+struct PersistentCompileCacheOptions {
+  std::string cache_dir;
+  // each version, e.g. CANN version and soc, has its own sub dir of cache dir, other versions are not touched
+  std::string version;
+  uint64_t max_size = kDefaultCompileCacheMaxSize;
+  // number of most recently used entries read into memory on initialize
+  size_t preload_num = 0U;
+};
+
+struct PersistentCompileCacheStatistics {
+  uint64_t hit_count = 0UL;
+  uint64_t miss_count = 0UL;
+  uint64_t store_count = 0UL;
+  uint64_t evict_count = 0UL;
+  uint64_t corrupt_count = 0UL;
+};
+
+/**
+ * @brief on-disk tier of compile cache, kept in the sub dir of the version under cache dir. Each entry is one blob
+ *        file named by the stable hash of its key, the index
+ *        records size and last access time of all entries for size bounded LRU eviction. Files are written to a
+ *        temporary name and renamed, index updates are serialized between processes by a lock file.
+ */
+class PersistentCompileCache {
+ public:
+  PersistentCompileCache() = default;
+  ~PersistentCompileCache() {
+    Finalize();
+  }
+  PersistentCompileCache(const PersistentCompileCache &) = delete;
+  PersistentCompileCache &operator=(const PersistentCompileCache &) = delete;
+
+  Status Initialize(const PersistentCompileCacheOptions &options) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (options.cache_dir.empty()) {
+      GELOGE(PARAM_INVALID, "[Check][Param] cache dir of persistent compile cache is empty");
+      return PARAM_INVALID;
+    }
+    const uint64_t version_hash = StableHash64(options.version.data(), options.version.size());
+    char_t version_name[32] = {};
+    (void)snprintf(version_name, sizeof(version_name), "/%016lx", version_hash);
+    const std::string version_dir = options.cache_dir + version_name;
+    if ((!CreateDir(options.cache_dir)) || (!CreateDir(version_dir))) {
+      GELOGE(FAILED, "[Create][Dir] persistent compile cache dir %s failed", version_dir.c_str());
+      return FAILED;
+    }
+    options_ = options;
+    version_hash_ = version_hash;
+    dir_ = version_dir;
+    entries_.clear();
+    total_size_ = 0UL;
+    {
+      const FileLock file_lock(GetLockPath());
+      std::map<uint64_t, IndexEntry> disk_entries;
+      if (ReadIndex(disk_entries) != SUCCESS) {
+        GELOGI("Persistent compile cache %s starts empty", dir_.c_str());
+        ClearDir();
+        disk_entries.clear();
+        (void)WriteIndex();
+      }
+      MergeIndex(disk_entries);
+    }
+    initialized_ = true;
+    Preload();
+    GELOGI("Persistent compile cache %s initialized, entry num:%zu, size:%lu, preloaded:%zu",
+           dir_.c_str(), entries_.size(), total_size_, preloaded_.size());
+    return SUCCESS;
+  }
+
+  /**
+   * @brief write back access times so that other processes see the LRU order of this one
+   */
+  void Finalize() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!initialized_) {
+      return;
+    }
+    const FileLock file_lock(GetLockPath());
+    std::map<uint64_t, IndexEntry> disk_entries;
+    if (ReadIndex(disk_entries) == SUCCESS) {
+      MergeIndex(disk_entries);
+    }
+    (void)WriteIndex();
+    preloaded_.clear();
+    initialized_ = false;
+  }
+
+  /**
+   * @brief find blob of key
+   * @return false if not cached or the cached blob is broken
+   */
+  bool Load(const std::string &key, std::vector<uint8_t> &blob) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!initialized_) {
+      return false;
+    }
+    const uint64_t hash = StableHash64(key.data(), key.size());
+    const auto preloaded = preloaded_.find(hash);
+    // blob evicted by another process is not served from memory either
+    if ((preloaded != preloaded_.end()) && (mmAccess2(GetBlobPath(hash).c_str(), M_F_OK) != EN_OK)) {
+      (void)preloaded_.erase(preloaded);
+    } else if ((preloaded != preloaded_.end()) && (preloaded->second.first == key)) {
+      blob = preloaded->second.second;
+      Touch(hash, GetBlobFileSize(key.size(), blob.size()));
+      ++statistics_.hit_count;
+      return true;
+    }
+    // blob may be stored by another process after the index is read, so always look at the file
+    std::string stored_key;
+    const Status ret = ReadBlob(hash, stored_key, blob);
+    if ((ret == SUCCESS) && (stored_key == key)) {
+      Touch(hash, GetBlobFileSize(key.size(), blob.size()));
+      ++statistics_.hit_count;
+      return true;
+    }
+    if ((ret == FAILED) && RemoveBrokenBlob(hash, key, blob)) {
+      Touch(hash, GetBlobFileSize(key.size(), blob.size()));
+      ++statistics_.hit_count;
+      return true;
+    }
+    ++statistics_.miss_count;
+    return false;
+  }
+
+  Status Store(const std::string &key, const uint8_t *const data, const size_t size) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!initialized_) {
+      return NOT_CHANGED;
+    }
+    if ((data == nullptr) && (size > 0U)) {
+      GELOGE(PARAM_INVALID, "[Check][Param] data is nullptr, size:%zu", size);
+      return PARAM_INVALID;
+    }
+    const uint64_t hash = StableHash64(key.data(), key.size());
+    const std::string blob_path = GetBlobPath(hash);
+    const std::string tmp_path = blob_path + ".tmp." + std::to_string(mmGetPid());
+    // held from the blob write on, so that ClearDir of another process never runs between write and index update
+    const FileLock file_lock(GetLockPath());
+    {
+      std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+      const BlobHeader header{kCompileCacheMagic, kCompileCacheFormatVersion, version_hash_,
+                              static_cast<uint64_t>(key.size()), static_cast<uint64_t>(size),
+                              StableHash64(data, size)};
+      (void)ofs.write(reinterpret_cast<const char_t *>(&header), static_cast<std::streamsize>(sizeof(header)));
+      (void)ofs.write(key.data(), static_cast<std::streamsize>(key.size()));
+      (void)ofs.write(reinterpret_cast<const char_t *>(data), static_cast<std::streamsize>(size));
+      if (!ofs.good()) {
+        GELOGW("Write blob %s of persistent compile cache failed", tmp_path.c_str());
+        (void)mmUnlink(tmp_path.c_str());
+        return FAILED;
+      }
+    }
+    if (std::rename(tmp_path.c_str(), blob_path.c_str()) != 0) {
+      GELOGW("Rename blob %s of persistent compile cache failed", tmp_path.c_str());
+      (void)mmUnlink(tmp_path.c_str());
+      return FAILED;
+    }
+    std::map<uint64_t, IndexEntry> disk_entries;
+    if (ReadIndex(disk_entries) == SUCCESS) {
+      MergeIndex(disk_entries);
+    }
+    Touch(hash, GetBlobFileSize(key.size(), size));
+    ++statistics_.store_count;
+    Evict();
+    return WriteIndex();
+  }
+
+  size_t GetEntryNum() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  uint64_t GetTotalSize() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return total_size_;
+  }
+
+  PersistentCompileCacheStatistics GetStatistics() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+  }
+
+ private:
+  struct IndexHeader {
+    uint32_t magic;
+    uint32_t format_version;
+    uint64_t version_hash;
+    uint64_t entry_num;
+  };
+
+  struct IndexEntry {
+    uint64_t hash;
+    uint64_t size;         // bytes of blob file
+    uint64_t last_access;  // system clock in ns, shared by processes
+  };
+
+  struct BlobHeader {
+    uint32_t magic;
+    uint32_t format_version;
+    uint64_t version_hash;
+    uint64_t key_size;
+    uint64_t blob_size;
+    uint64_t checksum;
+  };
+
+  class FileLock {
+   public:
+    explicit FileLock(const std::string &path)
+        : fd_(mmOpen2(path.c_str(), M_RDWR | M_CREAT, static_cast<MODE>(M_IRUSR | M_IWUSR))) {
+      if ((fd_ >= 0) && (flock(fd_, LOCK_EX) != 0)) {
+        GELOGW("Lock %s failed, index of persistent compile cache is updated without lock", path.c_str());
+      }
+    }
+    ~FileLock() {
+      if (fd_ >= 0) {
+        (void)flock(fd_, LOCK_UN);
+        (void)mmClose(fd_);
+      }
+    }
+    FileLock(const FileLock &) = delete;
+    FileLock &operator=(const FileLock &) = delete;
+
+   private:
+    int32_t fd_;
+  };
+
+  static uint64_t Now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch()).count());
+  }
+
+  static uint64_t GetBlobFileSize(const size_t key_size, const size_t blob_size) {
+    return static_cast<uint64_t>(sizeof(BlobHeader) + key_size + blob_size);
+  }
+
+  static bool CreateDir(const std::string &dir) {
+    return (mmAccess2(dir.c_str(), M_F_OK) == EN_OK) ||
+           (mmMkdir(dir.c_str(), static_cast<mmMode_t>(M_IRUSR | M_IWUSR | M_IXUSR)) == EN_OK) ||
+           (mmAccess2(dir.c_str(), M_F_OK) == EN_OK);
+  }
+
+  std::string GetLockPath() const { return dir_ + "/.lock"; }
+  std::string GetIndexPath() const { return dir_ + "/index"; }
+  std::string GetBlobPath(const uint64_t hash) const {
+    char_t name[32] = {};
+    (void)snprintf(name, sizeof(name), "/%016lx.bin", hash);
+    return dir_ + name;
+  }
+
+  // SUCCESS: blob and key read, NOT_CHANGED: no such file, FAILED: file is broken
+  Status ReadBlob(const uint64_t hash, std::string &key, std::vector<uint8_t> &blob) const {
+    std::ifstream ifs(GetBlobPath(hash), std::ios::binary);
+    if (!ifs.is_open()) {
+      return NOT_CHANGED;
+    }
+    BlobHeader header{};
+    if ((!ifs.read(reinterpret_cast<char_t *>(&header), static_cast<std::streamsize>(sizeof(header)))) ||
+        (header.magic != kCompileCacheMagic) || (header.format_version != kCompileCacheFormatVersion)) {
+      return FAILED;
+    }
+    if (header.version_hash != version_hash_) {
+      return NOT_CHANGED;
+    }
+    const auto begin = ifs.tellg();
+    (void)ifs.seekg(0, std::ios::end);
+    const uint64_t remain = static_cast<uint64_t>(ifs.tellg() - begin);
+    (void)ifs.seekg(begin);
+    if ((header.key_size > remain) || (header.blob_size != (remain - header.key_size))) {
+      return FAILED;
+    }
+    key.resize(static_cast<size_t>(header.key_size));
+    blob.resize(static_cast<size_t>(header.blob_size));
+    if ((!ifs.read(&key[0], static_cast<std::streamsize>(key.size()))) ||
+        (!ifs.read(reinterpret_cast<char_t *>(blob.data()), static_cast<std::streamsize>(blob.size()))) ||
+        (StableHash64(blob.data(), blob.size()) != header.checksum)) {
+      return FAILED;
+    }
+    return SUCCESS;
+  }
+
+  Status ReadIndex(std::map<uint64_t, IndexEntry> &disk_entries) const {
+    std::ifstream ifs(GetIndexPath(), std::ios::binary);
+    if (!ifs.is_open()) {
+      return FAILED;
+    }
+    IndexHeader header{};
+    if ((!ifs.read(reinterpret_cast<char_t *>(&header), static_cast<std::streamsize>(sizeof(header)))) ||
+        (header.magic != kCompileCacheMagic) || (header.format_version != kCompileCacheFormatVersion)) {
+      GELOGW("Index of persistent compile cache %s is broken", dir_.c_str());
+      return FAILED;
+    }
+    for (uint64_t i = 0UL; i < header.entry_num; ++i) {
+      IndexEntry entry{};
+      if (!ifs.read(reinterpret_cast<char_t *>(&entry), static_cast<std::streamsize>(sizeof(entry)))) {
+        GELOGW("Index of persistent compile cache %s is truncated", dir_.c_str());
+        return FAILED;
+      }
+      disk_entries[entry.hash] = entry;
+    }
+    if (header.version_hash != version_hash_) {
+      GELOGW("Index of persistent compile cache %s is of another version", dir_.c_str());
+      return FAILED;
+    }
+    return SUCCESS;
+  }
+
+  Status WriteIndex() const {
+    const std::string tmp_path = GetIndexPath() + ".tmp." + std::to_string(mmGetPid());
+    {
+      std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+      const IndexHeader header{kCompileCacheMagic, kCompileCacheFormatVersion, version_hash_,
+                               static_cast<uint64_t>(entries_.size())};
+      (void)ofs.write(reinterpret_cast<const char_t *>(&header), static_cast<std::streamsize>(sizeof(header)));
+      for (const auto &it : entries_) {
+        (void)ofs.write(reinterpret_cast<const char_t *>(&it.second), static_cast<std::streamsize>(sizeof(it.second)));
+      }
+      if (!ofs.good()) {
+        GELOGW("Write index %s of persistent compile cache failed", tmp_path.c_str());
+        (void)mmUnlink(tmp_path.c_str());
+        return FAILED;
+      }
+    }
+    if (std::rename(tmp_path.c_str(), GetIndexPath().c_str()) != 0) {
+      (void)mmUnlink(tmp_path.c_str());
+      return FAILED;
+    }
+    return SUCCESS;
+  }
+
+  // entries on disk win unless this process accessed them later, entries missing on disk were evicted by others
+  void MergeIndex(const std::map<uint64_t, IndexEntry> &disk_entries) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (disk_entries.count(it->first) == 0U) {
+        total_size_ -= it->second.size;
+        (void)preloaded_.erase(it->first);
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (const auto &it : disk_entries) {
+      const auto found = entries_.find(it.first);
+      if (found == entries_.end()) {
+        entries_[it.first] = it.second;
+        total_size_ += it.second.size;
+      } else {
+        total_size_ = total_size_ - found->second.size + it.second.size;
+        found->second.size = it.second.size;
+        found->second.last_access = std::max(found->second.last_access, it.second.last_access);
+      }
+    }
+  }
+
+  void Touch(const uint64_t hash, const uint64_t size) {
+    auto &entry = entries_[hash];
+    total_size_ = total_size_ - entry.size + size;
+    entry.hash = hash;
+    entry.size = size;
+    entry.last_access = Now();
+  }
+
+  // a blob read as broken may be in the middle of being replaced by another process, it is read again under the
+  // file lock and only removed if it is still broken. Returns true if the blob read again is the one of key
+  bool RemoveBrokenBlob(const uint64_t hash, const std::string &key, std::vector<uint8_t> &blob) {
+    const FileLock file_lock(GetLockPath());
+    std::string stored_key;
+    const Status ret = ReadBlob(hash, stored_key, blob);
+    if (ret != FAILED) {
+      return (ret == SUCCESS) && (stored_key == key);
+    }
+    ++statistics_.corrupt_count;
+    GELOGW("Blob %016lx of persistent compile cache is broken, remove it", hash);
+    std::map<uint64_t, IndexEntry> disk_entries;
+    if (ReadIndex(disk_entries) == SUCCESS) {
+      MergeIndex(disk_entries);
+    }
+    RemoveEntry(hash);
+    (void)WriteIndex();
+    return false;
+  }
+
+  // caller holds the file lock
+  void RemoveEntry(const uint64_t hash) {
+    const auto it = entries_.find(hash);
+    if (it != entries_.end()) {
+      total_size_ -= it->second.size;
+      (void)entries_.erase(it);
+    }
+    (void)preloaded_.erase(hash);
+    (void)mmUnlink(GetBlobPath(hash).c_str());
+  }
+
+  void Evict() {
+    if (total_size_ <= options_.max_size) {
+      return;
+    }
+    std::vector<IndexEntry> lru;
+    lru.reserve(entries_.size());
+    for (const auto &it : entries_) {
+      lru.emplace_back(it.second);
+    }
+    std::sort(lru.begin(), lru.end(), [](const IndexEntry &lhs, const IndexEntry &rhs) {
+      return lhs.last_access < rhs.last_access;
+    });
+    for (const auto &entry : lru) {
+      if (total_size_ <= options_.max_size) {
+        break;
+      }
+      GELOGD("Evict blob %016lx of persistent compile cache, size:%lu", entry.hash, entry.size);
+      RemoveEntry(entry.hash);
+      ++statistics_.evict_count;
+    }
+  }
+
+  // index is missing or broken, blobs of the version dir are not tracked and are removed.
+  // Caller holds mutex_ and the file lock, the same locks Store holds while it writes a blob
+  void ClearDir() const {
+    mmDirent **entries = nullptr;
+    const INT32 entry_num = mmScandir(dir_.c_str(), &entries, nullptr, nullptr);
+    if ((entry_num < 0) || (entries == nullptr)) {
+      return;
+    }
+    const std::string blob_suffix = ".bin";
+    for (INT32 i = 0; i < entry_num; ++i) {
+      const std::string name = entries[i]->d_name;
+      if ((name.size() > blob_suffix.size()) &&
+          (name.compare(name.size() - blob_suffix.size(), blob_suffix.size(), blob_suffix) == 0)) {
+        (void)mmUnlink((dir_ + "/" + name).c_str());
+      }
+    }
+    mmScandirFree(entries, entry_num);
+  }
+
+  void Preload() {
+    if (options_.preload_num == 0U) {
+      return;
+    }
+    std::vector<IndexEntry> mru;
+    for (const auto &it : entries_) {
+      mru.emplace_back(it.second);
+    }
+    std::sort(mru.begin(), mru.end(), [](const IndexEntry &lhs, const IndexEntry &rhs) {
+      return lhs.last_access > rhs.last_access;
+    });
+    for (size_t i = 0U; (i < mru.size()) && (i < options_.preload_num); ++i) {
+      std::pair<std::string, std::vector<uint8_t>> item;
+      if (ReadBlob(mru[i].hash, item.first, item.second) == SUCCESS) {
+        preloaded_[mru[i].hash] = std::move(item);
+      }
+    }
+  }
+
+  mutable std::mutex mutex_;
+  bool initialized_ = false;
+  PersistentCompileCacheOptions options_;
+  uint64_t version_hash_ = 0UL;
+  std::string dir_;
+  std::map<uint64_t, IndexEntry> entries_;
+  uint64_t total_size_ = 0UL;
+  std::unordered_map<uint64_t, std::pair<std::string, std::vector<uint8_t>>> preloaded_;
+  PersistentCompileCacheStatistics statistics_;
+};
+}  // namespace ge
+
+#endif // AIR_CXX_EXECUTOR_HYBRID_COMMON_BIN_CACHE_PERSISTENT_COMPILE_CACHE_H_
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_MANAGER_VAR_INDEX_H_
+#define GE_GRAPH_MANAGER_VAR_INDEX_H_
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ge {
+using VarId = uint32_t;
+constexpr VarId kInvalidVarId = UINT32_MAX;
+
+// Interned index of variables. A variable is a var name with format and data type, as keyed by VarKey, and gets a
+// dense id on first use that stays valid until Clear, so hot paths keep the id and look values up by array index
+// instead of building key strings. Lookups take a shared lock and do not block each other.
+template <typename T>
+class VarIndex {
+ public:
+  VarId Intern(const std::string &var_name, const int32_t format, const int32_t data_type) {
+    {
+      const std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+      const VarId var_id = FindLocked(var_name, format, data_type);
+      if (var_id != kInvalidVarId) {
+        return var_id;
+      }
+    }
+    const std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    VarId var_id = FindLocked(var_name, format, data_type);
+    if (var_id != kInvalidVarId) {
+      return var_id;
+    }
+    const auto it = names_.emplace(var_name, std::vector<VarId>()).first;
+    var_id = static_cast<VarId>(entries_.size());
+    entries_.emplace_back(Entry{&it->first, format, data_type, false, T()});
+    it->second.emplace_back(var_id);
+    return var_id;
+  }
+
+  VarId Find(const std::string &var_name, const int32_t format, const int32_t data_type) const {
+    const std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return FindLocked(var_name, format, data_type);
+  }
+
+  // whether any variable of the name has a value
+  bool HasName(const std::string &var_name) const {
+    const std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    const auto it = names_.find(var_name);
+    if (it == names_.end()) {
+      return false;
+    }
+    for (const VarId var_id : it->second) {
+      if (entries_[var_id].valid) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Set(const VarId var_id, T value) {
+    const std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    if (var_id < entries_.size()) {
+      entries_[var_id].value = std::move(value);
+      entries_[var_id].valid = true;
+    }
+  }
+
+  void Erase(const VarId var_id) {
+    const std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    if (var_id < entries_.size()) {
+      entries_[var_id].value = T();
+      entries_[var_id].valid = false;
+    }
+  }
+
+  // calls visitor(const T &) under shared lock if the variable has a value, returns false otherwise
+  template <typename Visitor>
+  bool Visit(const VarId var_id, Visitor &&visitor) const {
+    const std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    if ((var_id >= entries_.size()) || (!entries_[var_id].valid)) {
+      return false;
+    }
+    visitor(entries_[var_id].value);
+    return true;
+  }
+
+  // calls visitor(var_id, var_name, const T &) for variables with value in id order, which is the order of first use
+  template <typename Visitor>
+  void ForEach(Visitor &&visitor) const {
+    const std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    for (size_t i = 0U; i < entries_.size(); ++i) {
+      if (entries_[i].valid) {
+        visitor(static_cast<VarId>(i), *entries_[i].var_name, entries_[i].value);
+      }
+    }
+  }
+
+  size_t Size() const {
+    const std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  void Reserve(const size_t var_num) {
+    const std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    entries_.reserve(var_num);
+    names_.reserve(var_num);
+  }
+
+  void Clear() {
+    const std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    entries_.clear();
+    names_.clear();
+  }
+
+ private:
+  struct Entry {
+    const std::string *var_name;  // key in names_, node based map keeps it stable
+    int32_t format;
+    int32_t data_type;
+    bool valid;
+    T value;
+  };
+
+  VarId FindLocked(const std::string &var_name, const int32_t format, const int32_t data_type) const {
+    const auto it = names_.find(var_name);
+    if (it == names_.end()) {
+      return kInvalidVarId;
+    }
+    // a name has one variable in most graphs, a few more if formats or data types are transformed
+    for (const VarId var_id : it->second) {
+      if ((entries_[var_id].format == format) && (entries_[var_id].data_type == data_type)) {
+        return var_id;
+      }
+    }
+    return kInvalidVarId;
+  }
+
+  mutable std::shared_timed_mutex mutex_;
+  std::unordered_map<std::string, std::vector<VarId>> names_;
+  std::vector<Entry> entries_;
+};
+}  // namespace ge
+#endif  // GE_GRAPH_MANAGER_VAR_INDEX_H_
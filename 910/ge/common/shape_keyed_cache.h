@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_SHAPE_KEYED_CACHE_H_
+#define GE_COMMON_SHAPE_KEYED_CACHE_H_
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "graph/ge_tensor.h"
+
+namespace ge {
+///
+/// @ingroup ge
+/// @brief Compact byte key of tensor shapes, data types and optional values, e.g. of const inputs
+///
+class ShapeSignature {
+ public:
+  void Clear() {
+    key_.clear();
+  }
+
+  void AddTensor(const GeTensorDesc &tensor_desc) {
+    const GeShape &shape = tensor_desc.GetShape();
+    const size_t dim_num = shape.GetDimNum();
+    Append(static_cast<int64_t>(tensor_desc.GetDataType()));
+    Append(static_cast<int64_t>(tensor_desc.GetFormat()));
+    Append(static_cast<int64_t>(dim_num));
+    for (size_t i = 0U; i < dim_num; ++i) {
+      Append(shape.GetDim(i));
+    }
+  }
+
+  void AddValue(const int64_t value) {
+    Append(value);
+  }
+
+  void AddBytes(const void *const data, const size_t size) {
+    Append(static_cast<int64_t>(size));
+    if ((data != nullptr) && (size > 0U)) {
+      (void)key_.append(static_cast<const char *>(data), size);
+    }
+  }
+
+  const std::string &Key() const {
+    return key_;
+  }
+
+ private:
+  void Append(const int64_t value) {
+    (void)key_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  std::string key_;
+};
+
+struct ShapeKeyedCacheStatistics {
+  uint64_t hit_count = 0UL;
+  uint64_t miss_count = 0UL;
+  uint64_t evict_count = 0UL;
+  uint64_t invalidate_count = 0UL;
+  size_t entry_num = 0U;
+  size_t bytes = 0U;
+};
+
+///
+/// @ingroup ge
+/// @brief LRU cache of per shape results, bounded by entry number and by bytes reported on insert.
+///        Not thread safe, callers keep one cache per op or node and run it under their own serialization.
+///
+template <typename V>
+class ShapeKeyedCache {
+ public:
+  explicit ShapeKeyedCache(const size_t max_entries, const size_t max_bytes = SIZE_MAX)
+      : max_entries_(max_entries), max_bytes_(max_bytes) {}
+
+  V *Find(const std::string &key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+      ++statistics_.miss_count;
+      return nullptr;
+    }
+    ++statistics_.hit_count;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->value;
+  }
+
+  // returns nullptr if the value alone exceeds the bounds and is not cached
+  V *Insert(const std::string &key, V value, const size_t bytes) {
+    if ((max_entries_ == 0U) || (bytes > max_bytes_)) {
+      return nullptr;
+    }
+    Erase(key);
+    while ((!lru_.empty()) && ((lru_.size() >= max_entries_) || ((statistics_.bytes + bytes) > max_bytes_))) {
+      ++statistics_.evict_count;
+      EraseEntry(std::prev(lru_.end()));
+    }
+    lru_.emplace_front(Entry{key, std::move(value), bytes});
+    index_[lru_.front().key] = lru_.begin();
+    statistics_.bytes += bytes;
+    statistics_.entry_num = lru_.size();
+    return &lru_.front().value;
+  }
+
+  void Erase(const std::string &key) {
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      EraseEntry(it->second);
+    }
+  }
+
+  // drop all entries, e.g. when something outside the key that results depend on is changed
+  void Invalidate() {
+    if (!lru_.empty()) {
+      ++statistics_.invalidate_count;
+    }
+    index_.clear();
+    lru_.clear();
+    statistics_.bytes = 0U;
+    statistics_.entry_num = 0U;
+  }
+
+  const ShapeKeyedCacheStatistics &GetStatistics() const {
+    return statistics_;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    V value;
+    size_t bytes;
+  };
+
+  void EraseEntry(const typename std::list<Entry>::iterator &it) {
+    statistics_.bytes -= it->bytes;
+    (void)index_.erase(it->key);
+    (void)lru_.erase(it);
+    statistics_.entry_num = lru_.size();
+  }
+
+  size_t max_entries_;
+  size_t max_bytes_;
+  std::list<Entry> lru_;
+  std::unordered_map<std::string, typename std::list<Entry>::iterator> index_;
+  ShapeKeyedCacheStatistics statistics_;
+};
+
+// launch state of a tbe kernel that only depends on shapes and const values, restored on a hit instead of tiling
+struct TbeLaunchCacheEntry {
+  std::string tiling_data;
+  uint32_t block_dim = 1U;
+  uint32_t tiling_key = 0U;
+  bool clear_atomic = false;
+  std::vector<int64_t> workspace_sizes;
+  std::vector<uint8_t> args_image;  // args of the launch that saved the entry, empty if args are rebuilt each launch
+
+  size_t Bytes() const {
+    return tiling_data.size() + args_image.size() + (workspace_sizes.size() * sizeof(int64_t));
+  }
+};
+}  // namespace ge
+#endif  // GE_COMMON_SHAPE_KEYED_CACHE_H_
@@ -18,6 +18,7 @@
 #define GE_GRAPH_BUILD_MEMORY_BLOCK_MEM_ASSIGNER_H_
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -28,8 +29,12 @@
 #include "framework/common/types.h"
 #include "framework/common/util.h"
 #include "graph/build/memory/mem_assigner.h"
+#include "graph/build/memory/parallel_mem_assign.h"
 #include "graph/compute_graph.h"
+#include "graph/debug/ge_attr_define.h"
+#include "graph/utils/attr_utils.h"
 #include "graph/utils/graph_utils.h"
+#include "graph/utils/tensor_utils.h"
 
 namespace ge {
 const size_t kMaxLifeTime = 0xffffffff;
@@ -252,6 +257,15 @@ class BlockMemAssigner : public MemAssigner {
   void SetOpMemOffset(bool is_zero_copy);
 
   std::string GetMaxBatchLabel() const { return max_batch_label_; }
+
+  ///
+  /// @ingroup GE
+  /// @brief pool for GetOutAndWorkSpaceMemParallel, owned by the caller and shared by all assigners of one build
+  ///
+  void SetAssignThreadPool(ThreadPool *const pool, const uint32_t thread_num) {
+    assign_pool_ = pool;
+    assign_thread_num_ = (thread_num == 0U) ? 1U : thread_num;
+  }
  protected:
   ///
   /// @ingroup domi
@@ -262,6 +276,83 @@ class BlockMemAssigner : public MemAssigner {
 
   void GetOutAndWorkSpaceMem(std::vector<int64_t> &all_memory_size);
 
+  ///
+  /// @ingroup GE
+  /// @brief GetOutAndWorkSpaceMem for GetMemoryRanges with the sizes of nodes read on assign_pool_. Nodes are cut
+  ///        into chunks in GetAllNodes order and merged in that order, so the result equals the serial one.
+  ///        Without pool it is GetOutAndWorkSpaceMem
+  /// @param [out] all_memory_size sizes of outputs and workspaces grouped by batch label
+  /// @return Status result
+  ///
+  Status GetOutAndWorkSpaceMemParallel(std::vector<int64_t> &all_memory_size) {
+    if ((assign_pool_ == nullptr) || (assign_thread_num_ <= 1U)) {
+      GetOutAndWorkSpaceMem(all_memory_size);
+      return SUCCESS;
+    }
+    const auto nodes = compute_graph_->GetAllNodes();
+    const std::vector<NodePtr> all_nodes(nodes.begin(), nodes.end());
+    std::vector<NodeMemSize> node_sizes(all_nodes.size());
+    const size_t chunk_num = std::min(all_nodes.size(), static_cast<size_t>(assign_thread_num_) * kNodeChunkPerThread);
+    const auto read_chunk = [this, &all_nodes, &node_sizes, chunk_num](const size_t chunk) {
+      const size_t begin = (all_nodes.size() * chunk) / chunk_num;
+      const size_t end = (all_nodes.size() * (chunk + 1U)) / chunk_num;
+      for (size_t i = begin; i < end; ++i) {
+        GE_CHK_STATUS_RET_NOLOG(ReadNodeMemSize(all_nodes[i], node_sizes[i]));
+      }
+      return SUCCESS;
+    };
+    GE_CHK_STATUS_RET_NOLOG(ParallelForEach(chunk_num, assign_pool_, assign_thread_num_, read_chunk));
+
+    std::map<std::string, std::vector<int64_t>> batch_all_memory_size;
+    std::map<std::string, int64_t> batch_total_size;
+    for (size_t i = 0U; i < all_nodes.size(); ++i) {
+      const NodeMemSize &node_size = node_sizes[i];
+      if (node_size.skip) {
+        continue;
+      }
+      if (node_size.atomic_addr_clean) {
+        atomic_addr_clean_id_ = all_nodes[i]->GetOpDesc()->GetId();
+      }
+      std::vector<int64_t> &memory_size = batch_all_memory_size[node_size.batch_label];
+      int64_t &total_size = batch_total_size[node_size.batch_label];
+      for (const auto &output : node_size.outputs) {
+        memory_size.emplace_back(output.first);
+        total_size += output.first;
+        if (output.second == nullptr) {
+          continue;
+        }
+        const auto iter = symbol_size_.find(*output.second);
+        if (iter == symbol_size_.end()) {
+          symbol_size_[*output.second] = static_cast<size_t>(output.first);
+        } else if (output.first > static_cast<int64_t>(iter->second)) {
+          iter->second = static_cast<size_t>(output.first);
+        }
+      }
+      memory_size.insert(memory_size.end(), node_size.workspaces.begin(), node_size.workspaces.end());
+      total_size += node_size.workspace_size;
+    }
+    GELOGI("The last atomic_addr_clean node id: %ld", atomic_addr_clean_id_);
+    for (const auto &pair : batch_all_memory_size) {
+      all_memory_size.insert(all_memory_size.end(), pair.second.begin(), pair.second.end());
+    }
+    int64_t max_total_size = 0;
+    for (const auto &pair : batch_total_size) {
+      GELOGI("Batch:%s memory size:%ld", pair.first.c_str(), pair.second);
+      if (pair.second > max_total_size) {
+        max_batch_label_ = pair.first;
+        max_total_size = pair.second;
+      }
+    }
+    GELOGI("Max batch label:%s", max_batch_label_.c_str());
+    {
+      // candidates of one graph run concurrently, and the reuse flags write memory types into the shared op descs
+      const std::lock_guard<std::mutex> lock(GraphWriteMutex());
+      InitReuseFlag();
+    }
+    PrintSymbolMap();
+    return SUCCESS;
+  }
+
   void GetNodeWorkSpaceSize(const ge::NodePtr &node, std::vector<int64_t> &workspace_memory, int64_t &total_size);
 
   ///
@@ -344,8 +435,59 @@ class BlockMemAssigner : public MemAssigner {
   std::map<std::string, bool> post_reuse_flag_;
   std::map<std::string, size_t> symbol_size_;
   std::map<std::string, int64_t> symbol_to_mem_type_;
+  ThreadPool *assign_pool_ = nullptr;
+  uint32_t assign_thread_num_ = 1U;
 
  private:
+  // sizes of one node read by GetOutAndWorkSpaceMemParallel, merged in node order
+  struct NodeMemSize {
+    bool skip = true;
+    bool atomic_addr_clean = false;
+    std::string batch_label;
+    std::vector<std::pair<int64_t, const std::string *>> outputs;  // size, symbol or nullptr
+    std::vector<int64_t> workspaces;
+    int64_t workspace_size = 0;
+  };
+
+  static constexpr size_t kNodeChunkPerThread = 4U;
+
+  static std::mutex &GraphWriteMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  Status ReadNodeMemSize(const NodePtr &node, NodeMemSize &node_size) {
+    const OpDescPtr op_desc = node->GetOpDesc();
+    if ((op_desc == nullptr) || CheckIsZeroMemNodeType(op_desc->GetType())) {
+      return SUCCESS;
+    }
+    node_size.skip = false;
+    node_size.atomic_addr_clean = (op_desc->GetType() == ATOMICADDRCLEAN);
+    (void)AttrUtils::GetStr(op_desc, ATTR_NAME_BATCH_LABEL, node_size.batch_label);
+    for (const auto &out_anchor : node->GetAllOutDataAnchors()) {
+      const GeTensorDesc &output_desc = op_desc->GetOutputDesc(static_cast<uint32_t>(out_anchor->GetIdx()));
+      int64_t size = 0;
+      if (TensorUtils::GetSize(output_desc, size) != GRAPH_SUCCESS) {
+        GELOGI("Get size failed");
+      }
+      if (size < 0) {
+        REPORT_INNER_ERROR("E19999", "tensor_size:%ld is invalid, maybe it is unknown shape node, Node_name:%s",
+                           size, op_desc->GetName().c_str());
+        GELOGE(FAILED, "[Check][TensorSize]tensor_size:%ld is invalid, maybe it is unknown shape node, Node_name:%s",
+               size, op_desc->GetName().c_str());
+        return FAILED;
+      }
+      const std::string *symbol = nullptr;
+      if (!anchor_to_symbol_.empty()) {
+        const auto iter = anchor_to_symbol_.find(NodeIndexIO(node, out_anchor->GetIdx(), kOut).ToString());
+        symbol = (iter == anchor_to_symbol_.end()) ? nullptr : &iter->second;
+      }
+      node_size.outputs.emplace_back(size, symbol);
+    }
+    GetNodeWorkSpaceSize(node, node_size.workspaces, node_size.workspace_size);
+    return SUCCESS;
+  }
+
   ///
   /// @ingroup GE
   /// @brief Traversing the compute_graph_ to apply for output memory while considering reuse
@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_BUILD_MEMORY_INCREMENTAL_MEM_PLAN_CACHE_H_
+#define GE_GRAPH_BUILD_MEMORY_INCREMENTAL_MEM_PLAN_CACHE_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "graph/build/memory/interval_mem_planner.h"
+
+namespace ge {
+constexpr double kDefaultIncrementalChangeRatio = 0.1;
+
+///
+/// @ingroup GE
+/// @brief Plan of the last build of a graph. Buffers are keyed by name, e.g. node name with output or workspace
+///        index, and carry a signature of what survives a rebuild: size, memory type, stream and the key of the
+///        group they belong to. Life times are topo ids and change whenever nodes are renumbered, so they are left
+///        out and the planner releases kept offsets that conflict under the new life times. When a rebuild changes
+///        only a few buffers, the others keep their offsets and only the changed ones are placed into the gaps.
+///        Buffers with an empty key are always placed again.
+///
+class IncrementalMemPlanCache {
+ public:
+  explicit IncrementalMemPlanCache(const double max_change_ratio = kDefaultIncrementalChangeRatio)
+      : max_change_ratio_(max_change_ratio) {}
+
+  /**
+   * @brief remember the plan applied to the graph, keys are in the same order as intervals. A plan that lost to
+   *        the greedy one is not recorded, Clear instead
+   */
+  void Record(const std::vector<MemPlanInterval> &intervals, const std::vector<std::string> &keys,
+              const MemPlanResult &result) {
+    entries_.clear();
+    if (intervals.size() != keys.size()) {
+      return;
+    }
+    const std::vector<uint64_t> signatures = Signatures(intervals, keys);
+    for (size_t i = 0U; i < intervals.size(); ++i) {
+      const auto it = result.offsets.find(intervals[i].id);
+      if ((!keys[i].empty()) && (it != result.offsets.end())) {
+        entries_[keys[i]] = Entry{signatures[i], it->second};
+      }
+    }
+  }
+
+  void Clear() { entries_.clear(); }
+
+  /**
+   * @brief set fixed offset of unchanged buffers
+   * @return true if the plan is reusable, false if too many buffers changed and a full plan is cheaper
+   */
+  bool Prepare(std::vector<MemPlanInterval> &intervals, const std::vector<std::string> &keys) const {
+    if (entries_.empty() || intervals.empty() || (intervals.size() != keys.size())) {
+      return false;
+    }
+    const std::vector<uint64_t> signatures = Signatures(intervals, keys);
+    std::vector<const Entry *> hits(intervals.size(), nullptr);
+    size_t changed = 0U;
+    for (size_t i = 0U; i < intervals.size(); ++i) {
+      const auto it = keys[i].empty() ? entries_.end() : entries_.find(keys[i]);
+      if ((it == entries_.end()) || (it->second.signature != signatures[i])) {
+        ++changed;
+      } else {
+        hits[i] = &it->second;
+      }
+    }
+    const double ratio = static_cast<double>(changed) / static_cast<double>(intervals.size());
+    if (ratio > max_change_ratio_) {
+      GELOGI("Incremental memory plan is not used, %zu of %zu buffers changed", changed, intervals.size());
+      return false;
+    }
+    for (size_t i = 0U; i < intervals.size(); ++i) {
+      if (hits[i] != nullptr) {
+        intervals[i].fixed_offset = hits[i]->offset;
+      }
+    }
+    GELOGI("Incremental memory plan keeps %zu of %zu buffers", intervals.size() - changed, intervals.size());
+    return true;
+  }
+
+  void Clear() {
+    entries_.clear();
+  }
+
+ private:
+  struct Entry {
+    uint64_t signature;
+    size_t offset;
+  };
+
+  static uint64_t Hash(const uint64_t *const values, const size_t num) {
+    uint64_t hash = 14695981039346656037UL;
+    for (size_t i = 0U; i < num; ++i) {
+      hash ^= values[i];
+      hash *= 1099511628211UL;
+    }
+    return hash;
+  }
+
+  // group ids are indexes of the assigner, a group is named by the key of its first member instead
+  static std::vector<uint64_t> Signatures(const std::vector<MemPlanInterval> &intervals,
+                                          const std::vector<std::string> &keys) {
+    std::map<std::pair<int64_t, int64_t>, std::pair<int32_t, uint64_t>> group_names;
+    const std::hash<std::string> hasher;
+    for (size_t i = 0U; i < intervals.size(); ++i) {
+      const MemPlanInterval &interval = intervals[i];
+      if (interval.group == kNoMemPlanGroup) {
+        continue;
+      }
+      const auto ret = group_names.emplace(std::make_pair(interval.memory_type, interval.group),
+                                           std::make_pair(interval.group_index, hasher(keys[i])));
+      if ((!ret.second) && (interval.group_index < ret.first->second.first)) {
+        ret.first->second = std::make_pair(interval.group_index, hasher(keys[i]));
+      }
+    }
+    std::vector<uint64_t> signatures(intervals.size());
+    for (size_t i = 0U; i < intervals.size(); ++i) {
+      const MemPlanInterval &interval = intervals[i];
+      // a negative stream stands for a buffer shared by several streams, its value is an index as well
+      const uint64_t stream = (interval.stream_id < 0) ? UINT64_MAX : static_cast<uint64_t>(interval.stream_id);
+      const uint64_t group = (interval.group == kNoMemPlanGroup) ?
+          0UL : group_names[std::make_pair(interval.memory_type, interval.group)].second;
+      const uint64_t values[] = {static_cast<uint64_t>(interval.size), static_cast<uint64_t>(interval.memory_type),
+                                 stream, group, static_cast<uint64_t>(interval.group_index),
+                                 interval.reuse ? 1UL : 0UL};
+      signatures[i] = Hash(values, sizeof(values) / sizeof(values[0U]));
+    }
+    return signatures;
+  }
+
+  double max_change_ratio_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+}  // namespace ge
+#endif  // GE_GRAPH_BUILD_MEMORY_INCREMENTAL_MEM_PLAN_CACHE_H_
@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_BUILD_WEIGHT_DEDUP_H_
+#define GE_GRAPH_BUILD_WEIGHT_DEDUP_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/ge_local_context.h"
+
+namespace ge {
+// share const weights of all gears of multi batch: gears link to one const, equal weights are stored once
+const char *const kOptionShareConstWeight = "ge.experiment.multiBatchShareWeight";
+
+inline bool IsShareConstWeightEnabled() {
+  std::string share_weight;
+  return (GetThreadLocalContext().GetOption(kOptionShareConstWeight, share_weight) == GRAPH_SUCCESS) &&
+         (share_weight == "1");
+}
+
+struct WeightDedupStatistics {
+  size_t weight_num = 0U;
+  size_t reused_num = 0U;
+  size_t total_size = 0U;   // aligned size of all weights before dedup
+  size_t unique_size = 0U;  // aligned size of weight buffer after dedup
+};
+
+///
+/// @ingroup ge_graph
+/// @brief Content addressed layout of the weight buffer. Const weights with the same bytes get one offset, so
+///        weights of batch branches copied per gear are stored once in om and loaded once to device.
+///        Data of added weights must stay alive until the buffer is merged, e.g. held by the const op desc.
+///
+class WeightDeduplicator {
+ public:
+  explicit WeightDeduplicator(const size_t align) : align_((align == 0U) ? 1U : align) {}
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief get offset of weight in buffer, an equal weight added before gives its offset
+  /// @param [in] data: weight data, nullptr only if size is 0
+  /// @param [in] size: weight size
+  /// @param [out] offset: offset in weight buffer
+  /// @param [out] reused: true if offset is shared with an earlier weight
+  ///
+  Status Add(const uint8_t *const data, const size_t size, size_t &offset, bool &reused) {
+    if ((data == nullptr) && (size != 0U)) {
+      GELOGE(PARAM_INVALID, "[Check][Param] weight data is null, size:%zu", size);
+      return PARAM_INVALID;
+    }
+    const size_t aligned_size = AlignUp(size);
+    ++statistics_.weight_num;
+    statistics_.total_size += aligned_size;
+    const uint64_t hash = Hash(data, size);
+    auto &candidates = entries_[hash];
+    for (const auto &entry : candidates) {
+      if ((entry.size == size) && ((size == 0U) || (memcmp(entry.data, data, size) == 0))) {
+        offset = entry.offset;
+        reused = true;
+        ++statistics_.reused_num;
+        return SUCCESS;
+      }
+    }
+    offset = statistics_.unique_size;
+    reused = false;
+    candidates.emplace_back(Entry{data, size, offset});
+    unique_weights_.emplace_back(data, size);
+    statistics_.unique_size += aligned_size;
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief copy unique weights into buffer of GetStatistics().unique_size bytes, in the order they were added
+  ///
+  Status Merge(uint8_t *const buffer, const size_t buffer_size) const {
+    size_t offset = 0U;
+    for (const auto &weight : unique_weights_) {
+      if ((offset + weight.second) > buffer_size) {
+        GELOGE(INTERNAL_ERROR, "[Check][Param] weight of size %zu at offset %zu exceeds buffer size %zu",
+               weight.second, offset, buffer_size);
+        return INTERNAL_ERROR;
+      }
+      if (weight.second > 0U) {
+        (void)memcpy(buffer + offset, weight.first, weight.second);
+      }
+      offset += AlignUp(weight.second);
+    }
+    GELOGI("Weight dedup merged, weight num:%zu, reused:%zu, size before:%zu, after:%zu", statistics_.weight_num,
+           statistics_.reused_num, statistics_.total_size, statistics_.unique_size);
+    return SUCCESS;
+  }
+
+  const WeightDedupStatistics &GetStatistics() const {
+    return statistics_;
+  }
+
+ private:
+  struct Entry {
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+  };
+
+  size_t AlignUp(const size_t size) const {
+    return ((size + align_ - 1U) / align_) * align_;
+  }
+
+  static uint64_t Hash(const uint8_t *const data, const size_t size) {
+    uint64_t hash = 14695981039346656037UL ^ static_cast<uint64_t>(size);
+    size_t i = 0U;
+    for (; (i + sizeof(uint64_t)) <= size; i += sizeof(uint64_t)) {
+      uint64_t word = 0UL;
+      (void)memcpy(&word, data + i, sizeof(word));
+      hash = (hash ^ word) * 1099511628211UL;
+    }
+    for (; i < size; ++i) {
+      hash = (hash ^ data[i]) * 1099511628211UL;
+    }
+    return hash;
+  }
+
+  size_t align_;
+  std::unordered_map<uint64_t, std::vector<Entry>> entries_;
+  std::vector<std::pair<const uint8_t *, size_t>> unique_weights_;
+  WeightDedupStatistics statistics_;
+};
+}  // namespace ge
+#endif  // GE_GRAPH_BUILD_WEIGHT_DEDUP_H_
@@ -0,0 +1,363 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_LOAD_NEW_MODEL_MANAGER_BATCH_COALESCER_H_
+#define GE_GRAPH_LOAD_NEW_MODEL_MANAGER_BATCH_COALESCER_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "framework/common/ge_types.h"
+
+namespace ge {
+struct BatchCoalesceOptions {
+  std::vector<uint32_t> batch_gears;  // batch sizes of model, e.g. dynamic batch gears
+  uint32_t max_batch = 0U;            // 0 for the largest gear
+  uint64_t max_wait_us = 1000UL;      // from arrival of the oldest request to dispatch
+  size_t queue_capacity = 1024U;
+};
+
+///
+/// @ingroup domi_ome
+/// @brief one user request, blobs hold `rows` rows of every input
+///
+struct BatchRequest {
+  uint32_t rows = 1U;
+  InputData input;
+  // outputs are slices of the batch outputs, only valid during the callback
+  std::function<void(Status, const std::vector<DataBuffer> &)> callback;
+  std::chrono::steady_clock::time_point arrive_time;
+};
+
+struct CoalescedBatch {
+  uint32_t gear = 0U;  // selected batch gear, not less than rows
+  uint32_t rows = 0U;  // rows of all requests, the rest of gear is padding
+  std::vector<std::shared_ptr<BatchRequest>> requests;
+  std::vector<uint32_t> row_offsets;  // first row of each request in batch
+  InputData input;                    // inputs of all requests by row, zero padded to gear rows
+  std::vector<std::vector<uint8_t>> input_buffers;  // memory of input blobs
+};
+
+///
+/// @ingroup domi_ome
+/// @brief run one coalesced batch from batch.input, outputs hold `gear` rows each and must stay valid until it
+///        returns
+///
+using BatchExecuteFunc = std::function<Status(const CoalescedBatch &batch, std::vector<DataBuffer> &outputs)>;
+
+constexpr size_t kLatencyBucketNum = 24U;  // bucket i counts latency in [2^i, 2^(i+1)) us, the last one is open
+
+struct BatchCoalesceStatistics {
+  uint64_t request_num = 0UL;
+  uint64_t batch_num = 0UL;
+  uint64_t row_num = 0UL;
+  uint64_t padding_rows = 0UL;  // gear rows not used by requests
+  size_t queue_depth = 0U;
+  size_t max_queue_depth = 0U;
+  std::array<uint64_t, kLatencyBucketNum> queue_latency_us{};  // arrival to dispatch
+  std::array<uint64_t, kLatencyBucketNum> total_latency_us{};  // arrival to callback
+};
+
+///
+/// @ingroup domi_ome
+/// @brief Request coalescing for models with batch gears. A dispatcher gathers requests until max_batch rows or
+///        max_wait_us after the oldest one, runs them as one batch of the smallest gear that holds them, then
+///        calls every request back with its rows of the outputs. Requests are never split and keep their order.
+///
+class BatchCoalescer {
+ public:
+  BatchCoalescer() = default;
+  ~BatchCoalescer() {
+    Stop();
+  }
+  BatchCoalescer(const BatchCoalescer &) = delete;
+  BatchCoalescer &operator=(const BatchCoalescer &) = delete;
+
+  ///
+  /// @ingroup domi_ome
+  /// @brief set gears and execute func, FAILED while the dispatcher runs
+  ///
+  Status Init(const BatchCoalesceOptions &options, const BatchExecuteFunc &execute) {
+    if (options.batch_gears.empty() || (!execute)) {
+      GELOGE(PARAM_INVALID, "[Check][Param] batch gears is empty or execute func is null");
+      return PARAM_INVALID;
+    }
+    BatchCoalesceOptions sorted_options = options;
+    std::sort(sorted_options.batch_gears.begin(), sorted_options.batch_gears.end());
+    if (sorted_options.batch_gears.front() == 0U) {
+      GELOGE(PARAM_INVALID, "[Check][Param] batch gear 0 is invalid");
+      return PARAM_INVALID;
+    }
+    const std::lock_guard<std::mutex> control_lock(control_mutex_);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (dispatcher_.joinable()) {
+      GELOGE(FAILED, "[Check][Param] batch coalescer is running, stop it before Init");
+      return FAILED;
+    }
+    options_ = std::move(sorted_options);
+    const uint32_t max_gear = options_.batch_gears.back();
+    max_rows_ = (options_.max_batch == 0U) ? max_gear : std::min(options_.max_batch, max_gear);
+    execute_ = execute;
+    GELOGI("Batch coalescer init, gear num:%zu, max rows:%u, max wait:%lu us", options_.batch_gears.size(), max_rows_,
+           options_.max_wait_us);
+    return SUCCESS;
+  }
+
+  Status Start() {
+    const std::lock_guard<std::mutex> control_lock(control_mutex_);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!execute_) {
+      GELOGE(FAILED, "[Check][Param] batch coalescer is not initialized");
+      return FAILED;
+    }
+    if (!dispatcher_.joinable()) {
+      stopped_ = false;
+      dispatcher_ = std::thread(&BatchCoalescer::DispatchLoop, this);
+      dispatcher_id_ = dispatcher_.get_id();
+    }
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup domi_ome
+  /// @brief stop dispatcher, requests still in queue are called back with FAILED. A callback may stop it too,
+  ///        the dispatcher then exits after the current batch
+  ///
+  void Stop() {
+    bool in_dispatcher = false;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      in_dispatcher = (dispatcher_id_ == std::this_thread::get_id());
+    }
+    if (in_dispatcher) {
+      DropQueue();
+      return;
+    }
+    const std::lock_guard<std::mutex> control_lock(control_mutex_);
+    DropQueue();
+    if (dispatcher_.joinable()) {
+      dispatcher_.join();
+    }
+    const std::lock_guard<std::mutex> lock(mutex_);
+    dispatcher_id_ = std::thread::id();
+  }
+
+  Status Push(const std::shared_ptr<BatchRequest> &request) {
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      if ((request == nullptr) || (request->rows == 0U) || (request->rows > max_rows_)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] request rows %u is out of range (0, %u]",
+               (request == nullptr) ? 0U : request->rows, max_rows_);
+        return PARAM_INVALID;
+      }
+      if (stopped_ || (queue_.size() >= options_.queue_capacity)) {
+        GELOGW("Batch coalescer is stopped or full, queue depth:%zu", queue_.size());
+        return INTERNAL_ERROR;
+      }
+      request->arrive_time = Clock::now();
+      queue_.emplace_back(request);
+      queued_rows_ += request->rows;
+      statistics_.queue_depth = queue_.size();
+      statistics_.max_queue_depth = std::max(statistics_.max_queue_depth, queue_.size());
+    }
+    cv_.notify_one();
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup domi_ome
+  /// @brief smallest gear that holds rows, 0 if none
+  ///
+  uint32_t SelectGear(const uint32_t rows) const {
+    const auto it = std::lower_bound(options_.batch_gears.begin(), options_.batch_gears.end(), rows);
+    return (it == options_.batch_gears.end()) ? 0U : *it;
+  }
+
+  BatchCoalesceStatistics GetStatistics() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  static uint64_t ElapsedUs(const Clock::time_point &begin, const Clock::time_point &end) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+  }
+
+  static size_t LatencyBucket(const uint64_t us) {
+    size_t bucket = 0U;
+    while (((us >> (bucket + 1U)) != 0UL) && (bucket < (kLatencyBucketNum - 1U))) {
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  void DropQueue() {
+    std::deque<std::shared_ptr<BatchRequest>> dropped;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+      dropped.swap(queue_);
+      queued_rows_ = 0UL;
+      statistics_.queue_depth = 0U;
+    }
+    cv_.notify_all();
+    for (const auto &request : dropped) {
+      if (request->callback) {
+        request->callback(FAILED, {});
+      }
+    }
+  }
+
+  // called with mutex_ held, takes requests from head while they fit in max rows
+  void TakeBatch(CoalescedBatch &batch) {
+    while ((!queue_.empty()) && ((batch.rows + queue_.front()->rows) <= max_rows_)) {
+      batch.row_offsets.emplace_back(batch.rows);
+      batch.rows += queue_.front()->rows;
+      queued_rows_ -= queue_.front()->rows;
+      batch.requests.emplace_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    statistics_.queue_depth = queue_.size();
+  }
+
+  // copy rows of every request into one blob per input, rows after batch.rows stay zero up to gear
+  static Status Gather(CoalescedBatch &batch) {
+    const BatchRequest &first = *batch.requests.front();
+    const size_t input_num = first.input.blobs.size();
+    batch.input = first.input;
+    batch.input.blobs.clear();
+    batch.input.is_dynamic_batch = true;
+    for (auto &shape : batch.input.shapes) {
+      if (!shape.empty()) {
+        shape[0U] = static_cast<int64_t>(batch.gear);
+      }
+    }
+    batch.input_buffers.assign(input_num, std::vector<uint8_t>());
+    for (size_t j = 0U; j < input_num; ++j) {
+      const uint64_t row_size = first.input.blobs[j].length / first.rows;
+      if ((row_size * first.rows) != first.input.blobs[j].length) {
+        GELOGE(PARAM_INVALID, "[Check][Param] input %zu of size %lu does not hold %u rows", j,
+               first.input.blobs[j].length, first.rows);
+        return PARAM_INVALID;
+      }
+      std::vector<uint8_t> &buffer = batch.input_buffers[j];
+      buffer.assign(static_cast<size_t>(row_size * batch.gear), 0U);
+      for (size_t i = 0U; i < batch.requests.size(); ++i) {
+        const BatchRequest &request = *batch.requests[i];
+        const uint64_t size = row_size * request.rows;
+        if ((request.input.blobs.size() != input_num) || (request.input.blobs[j].length != size) ||
+            ((size != 0UL) && (request.input.blobs[j].data == nullptr))) {
+          GELOGE(PARAM_INVALID, "[Check][Param] input %zu of request %zu does not hold %u rows of %lu bytes", j, i,
+                 request.rows, row_size);
+          return PARAM_INVALID;
+        }
+        if (size != 0UL) {
+          (void)memcpy(&buffer[static_cast<size_t>(row_size * batch.row_offsets[i])], request.input.blobs[j].data,
+                       static_cast<size_t>(size));
+        }
+      }
+      batch.input.blobs.emplace_back(DataBuffer(buffer.data(), buffer.size(), false));
+    }
+    return SUCCESS;
+  }
+
+  void Scatter(const CoalescedBatch &batch, const Status ret, const std::vector<DataBuffer> &outputs) {
+    std::vector<DataBuffer> slices(outputs.size());
+    for (size_t i = 0U; i < batch.requests.size(); ++i) {
+      const auto &request = batch.requests[i];
+      for (size_t j = 0U; (ret == SUCCESS) && (j < outputs.size()); ++j) {
+        const uint64_t row_size = outputs[j].length / batch.gear;
+        slices[j] = DataBuffer(static_cast<uint8_t *>(outputs[j].data) + (row_size * batch.row_offsets[i]),
+                               row_size * request->rows, outputs[j].isDataSupportMemShare, outputs[j].placement);
+      }
+      if (request->callback) {
+        request->callback(ret, (ret == SUCCESS) ? slices : std::vector<DataBuffer>());
+      }
+    }
+  }
+
+  void DispatchLoop() {
+    while (true) {
+      CoalescedBatch batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stopped_ || (!queue_.empty()); });
+        if (stopped_) {
+          return;
+        }
+        const auto deadline = queue_.front()->arrive_time + std::chrono::microseconds(options_.max_wait_us);
+        (void)cv_.wait_until(lock, deadline, [this]() { return stopped_ || (queued_rows_ >= max_rows_); });
+        if (stopped_) {
+          return;
+        }
+        TakeBatch(batch);
+        batch.gear = SelectGear(batch.rows);
+        const auto dispatch_time = Clock::now();
+        for (const auto &request : batch.requests) {
+          ++statistics_.queue_latency_us[LatencyBucket(ElapsedUs(request->arrive_time, dispatch_time))];
+        }
+        ++statistics_.batch_num;
+        statistics_.request_num += batch.requests.size();
+        statistics_.row_num += batch.rows;
+        statistics_.padding_rows += batch.gear - batch.rows;
+      }
+      GELOGD("Dispatch batch, request num:%zu, rows:%u, gear:%u", batch.requests.size(), batch.rows, batch.gear);
+      std::vector<DataBuffer> outputs;
+      Status ret = Gather(batch);
+      if (ret == SUCCESS) {
+        ret = execute_(batch, outputs);
+      }
+      if (ret != SUCCESS) {
+        GELOGE(ret, "[Execute][Batch] failed, request num:%zu, gear:%u", batch.requests.size(), batch.gear);
+      }
+      Scatter(batch, ret, outputs);
+      const auto done_time = Clock::now();
+      const std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto &request : batch.requests) {
+        ++statistics_.total_latency_us[LatencyBucket(ElapsedUs(request->arrive_time, done_time))];
+      }
+    }
+  }
+
+  std::mutex control_mutex_;  // serializes Init, Start and Stop out of the dispatcher
+  BatchCoalesceOptions options_;
+  BatchExecuteFunc execute_;
+  uint32_t max_rows_ = 0U;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<BatchRequest>> queue_;
+  uint64_t queued_rows_ = 0UL;
+  bool stopped_ = false;
+  std::thread dispatcher_;
+  std::thread::id dispatcher_id_;  // read under mutex_, so a callback can tell it runs in the dispatcher
+  BatchCoalesceStatistics statistics_;
+};
+}  // namespace ge
+
+#endif  // GE_GRAPH_LOAD_NEW_MODEL_MANAGER_BATCH_COALESCER_H_
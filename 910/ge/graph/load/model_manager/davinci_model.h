@@ -39,6 +39,7 @@
 #include "graph/load/model_manager/data_inputer.h"
 #include "graph/load/model_manager/model_utils.h"
 #include "graph/load/model_manager/zero_copy_offset.h"
+#include "graph/load/model_manager/zero_copy_patch_plan.h"
 #include "graph/load/model_manager/zero_copy_task.h"
 #include "graph/model.h"
 #include "graph/node.h"
@@ -644,6 +645,86 @@ class DavinciModel {
   Status UpdateIoTaskArgs(const map<uint32_t, ZeroCopyOffset> &data_info, bool is_input,
                           const vector<DataBuffer> &blobs, bool is_dynamic, const string &batch_label);
 
+  ///
+  /// @ingroup ge
+  /// @brief Same as UpdateIoTaskArgs for inputs and outputs followed by DistributeParam of every zero copy task,
+  ///        patch points are compiled on first use and only the patched ranges of task args are uploaded.
+  ///        CopyModelData takes this path in place of the two UpdateIoTaskArgs calls and the DistributeParam loop.
+  /// @param [in] input_data: user input data.
+  /// @param [in] output_data: user output data.
+  /// @param [in] is_dynamic: dynamic batch input flag.
+  /// @return SUCCESS handle successfully / others handle failed
+  ///
+  Status UpdateIoTaskArgsByPlan(const InputData &input_data, const OutputData &output_data, const bool is_dynamic) {
+    const std::lock_guard<std::mutex> lk(outside_addrs_mutex_);
+    if (!zero_copy_patch_plan_.IsBuilt()) {
+      GE_CHK_STATUS_RET(zero_copy_patch_plan_.Build(zero_copy_tasks_, input_data_info_, output_data_info_),
+                        "[Build][ZeroCopyPatchPlan] failed, model_id:%u", model_id_);
+    }
+    GE_CHK_STATUS_RET_NOLOG(PatchIoTaskArgs(input_data_info_, true, input_data.blobs, is_dynamic,
+                                            input_data.batch_label));
+    GE_CHK_STATUS_RET_NOLOG(PatchIoTaskArgs(output_data_info_, false, output_data.blobs, is_dynamic,
+                                            input_data.batch_label));
+    return zero_copy_patch_plan_.Upload(zero_copy_tasks_, is_async_mode_, rt_model_stream_);
+  }
+
+  ///
+  /// @ingroup ge
+  /// @brief Check user buffer of one input or output against model, shared by UpdateIoTaskArgs and PatchIoTaskArgs.
+  /// @param [in] data: { data_index, ZeroCopyOffset } of model input or output.
+  /// @param [in] is_input: input data or output data
+  /// @param [in] blobs: user input/output data list.
+  /// @param [in] is_dynamic: whether is dynamic input
+  /// @return SUCCESS handle successfully / others handle failed
+  ///
+  Status CheckIoDataBuffer(const std::pair<const uint32_t, ZeroCopyOffset> &data, const bool is_input,
+                           const vector<DataBuffer> &blobs, const bool is_dynamic) {
+    if (data.first >= blobs.size()) {
+      REPORT_INNER_ERROR("E19999", "%s index %u is out of range, blobs size:%zu, model_id:%u",
+                         is_input ? "input" : "output", data.first, blobs.size(), model_id_);
+      GELOGE(ACL_ERROR_GE_PARAM_INVALID, "[Check][Param] %s index %u is out of range, blobs size:%zu, model_id:%u",
+             is_input ? "input" : "output", data.first, blobs.size(), model_id_);
+      return ACL_ERROR_GE_PARAM_INVALID;
+    }
+    const DataBuffer &buffer = blobs[data.first];
+    if (buffer.data == nullptr) {
+      REPORT_INNER_ERROR("E19999", "data_buf.data is nullptr, index:%u, model_id:%u", data.first, model_id_);
+      GELOGE(FAILED, "[Check][Param] data_buf.data is nullptr, index:%u, model_id:%u", data.first, model_id_);
+      return FAILED;
+    }
+    if (!CheckUserAndModelSize(static_cast<int64_t>(buffer.length), data.second.GetDataSize(), is_input,
+                               is_dynamic)) {
+      GELOGE(ACL_ERROR_GE_PARAM_INVALID, "[Call][CheckInputAndModelSize] failed, op[%s]",
+             data.second.GetOpName().c_str());
+      return ACL_ERROR_GE_PARAM_INVALID;
+    }
+    return SUCCESS;
+  }
+
+  Status PatchIoTaskArgs(const map<uint32_t, ZeroCopyOffset> &data_info, const bool is_input,
+                         const vector<DataBuffer> &blobs, const bool is_dynamic, const string &batch_label) {
+    for (const auto &data : data_info) {
+      GE_CHK_STATUS_RET_NOLOG(CheckIoDataBuffer(data, is_input, blobs, is_dynamic));
+      const DataBuffer &buffer = blobs[data.first];
+      void *const basic_addr = data.second.GetBasicAddr();
+      if (copy_only_addrs_.count(basic_addr) > 0U) {
+        if (is_input && (buffer.length > 0U)) {
+          const rtError_t rt_ret = rtMemcpy(basic_addr, static_cast<uint64_t>(data.second.GetDataSize()), buffer.data,
+                                            buffer.length, RT_MEMCPY_DEVICE_TO_DEVICE);
+          if (rt_ret != RT_ERROR_NONE) {
+            REPORT_CALL_ERROR("E19999", "Call rtMemcpy failed, size:%lu, ret:0x%X", buffer.length, rt_ret);
+            GELOGE(RT_FAILED, "[Call][RtMemcpy] failed, size:%lu, ret:0x%X", buffer.length, rt_ret);
+            return RT_ERROR_TO_GE_STATUS(rt_ret);
+          }
+        }
+        continue;
+      }
+      GE_CHK_STATUS_RET_NOLOG(zero_copy_patch_plan_.Patch(zero_copy_tasks_, is_input, data.first, buffer.data,
+                                                          batch_label));
+    }
+    return SUCCESS;
+  }
+
   Status CopyInputData(const InputData &input_data);
 
   Status CopyOutputData(uint32_t data_id, OutputData &output_data, rtMemcpyKind_t kind);
@@ -980,6 +1061,7 @@ class DavinciModel {
 
   mutex outside_addrs_mutex_;
   vector<ZeroCopyTask> zero_copy_tasks_;  // Task used Data or NetOutput addr.
+  ZeroCopyPatchPlan zero_copy_patch_plan_;  // Compiled from zero_copy_tasks_ on first UpdateIoTaskArgsByPlan.
   set<const void *> copy_only_addrs_;     // Address need copy to original place.
 
   vector<TaskInfoPtr> task_list_;
@@ -17,6 +17,7 @@
 #ifndef GE_GRAPH_LOAD_NEW_MODEL_MANAGER_ZERO_COPY_TASK_H_
 #define GE_GRAPH_LOAD_NEW_MODEL_MANAGER_ZERO_COPY_TASK_H_
 
+#include <cstring>
 #include <map>
 #include <set>
 #include <vector>
@@ -88,6 +89,32 @@ class ZeroCopyTask {
     return batch_label_;
   }
 
+  const string &GetName() const { return name_; }
+
+  uint8_t *GetArgsAddr() const { return args_addr_; }
+
+  size_t GetArgsSize() const { return args_size_; }
+
+  const vector<uint8_t> &GetOriginalArgs() const { return args_info_; }
+
+  /**
+   * @ingroup ge
+   * @brief Write address into orignal data of task args, the range is uploaded by ZeroCopyPatchPlan.
+   * @param [in] offset: offset in task args.
+   * @param [in] value: address from user.
+   * @return: true / false if offset is out of orignal data
+   */
+  bool PatchArgs(const size_t offset, const uint64_t value) {
+    if ((offset + sizeof(value)) > args_info_.size()) {
+      return false;
+    }
+    (void)memcpy(&args_info_[offset], &value, sizeof(value));
+    return true;
+  }
+
+  // <address from Op, {offset in args}>, compiled into ZeroCopyPatchPlan
+  const map<uintptr_t, set<size_t>> &GetTaskAddrOffset() const { return task_addr_offset_; }
+
  private:
   const string name_;
 
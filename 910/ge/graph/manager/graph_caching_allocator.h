@@ -17,6 +17,8 @@
 #ifndef GE_GRAPH_MANAGER_GRAPH_CACHING_ALLOCATOR_H_
 #define GE_GRAPH_MANAGER_GRAPH_CACHING_ALLOCATOR_H_
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -49,6 +51,31 @@ constexpr size_t kGByteSize = 1073741824;   // 1024 * 1024 * 1024
 
 static const uint32_t kNumBins = 7;
 
+struct CachingBinStatistics {
+  size_t in_use_size = 0U;       // bytes of allocated blocks belong to the bin
+  size_t in_use_block_num = 0U;
+  size_t cached_size = 0U;       // bytes of free blocks in the bin
+  size_t cached_block_num = 0U;
+  size_t max_cached_block_size = 0U;
+};
+
+struct CachingAllocatorStatistics {
+  CachingBinStatistics bins[kNumBins];
+  size_t malloced_size = 0U;        // bytes malloced from device
+  size_t in_use_size = 0U;
+  size_t cached_size = 0U;
+  size_t split_block_num = 0U;      // blocks split from a larger allocation, allocated or cached
+  size_t merge_counts = 0U;         // split blocks merged back on free
+  size_t malloc_counts = 0U;
+  size_t free_counts = 0U;
+  size_t max_cached_block_size = 0U;
+
+  // 0 means all cached memory is one block, close to 1 means cached memory is scattered in small pieces
+  double GetFragmentation() const {
+    return (cached_size == 0U) ? 0.0 : (1.0 - (static_cast<double>(max_cached_block_size) / cached_size));
+  }
+};
+
 class MemoryAllocator;
 
 class CachingAllocator {
@@ -102,6 +129,77 @@ class CachingAllocator {
   ///
   void TryFreeBlocks();
 
+  ///
+  /// @ingroup ge_graph
+  /// @brief get snapshot of the memory statistics in pool
+  /// @param [out] statistics statistics of bins and counters
+  /// @return void
+  ///
+  void GetStatistics(CachingAllocatorStatistics &statistics) const {
+    statistics = CachingAllocatorStatistics();
+    const std::lock_guard<std::recursive_mutex> lock(mutex_);
+    for (uint32_t i = 0U; i < kNumBins; ++i) {
+      if (free_block_bins_[i] == nullptr) {
+        continue;
+      }
+      CachingBinStatistics &bin_statistics = statistics.bins[i];
+      for (const Block *const block : *free_block_bins_[i]) {
+        bin_statistics.cached_size += block->size;
+        ++bin_statistics.cached_block_num;
+        bin_statistics.max_cached_block_size = std::max(bin_statistics.max_cached_block_size, block->size);
+        statistics.split_block_num += block->IsSplit() ? 1U : 0U;
+      }
+      statistics.cached_size += bin_statistics.cached_size;
+      statistics.max_cached_block_size =
+          std::max(statistics.max_cached_block_size, bin_statistics.max_cached_block_size);
+    }
+    for (const auto &allocated : allocated_blocks_) {
+      const Block *const block = allocated.second;
+      if (block == nullptr) {
+        continue;
+      }
+      statistics.in_use_size += block->size;
+      statistics.split_block_num += block->IsSplit() ? 1U : 0U;
+      for (uint32_t i = 0U; i < kNumBins; ++i) {
+        if ((free_block_bins_[i] != nullptr) && (block->bin == free_block_bins_[i])) {
+          statistics.bins[i].in_use_size += block->size;
+          ++statistics.bins[i].in_use_block_num;
+          break;
+        }
+      }
+    }
+    for (const auto &malloced : malloced_memory_) {
+      statistics.malloced_size += malloced.first * malloced.second;
+    }
+    statistics.malloc_counts = called_malloc_counts_.load();
+    statistics.free_counts = called_free_counts_.load();
+    statistics.merge_counts = called_merge_counts_.load();
+  }
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief print the memory info in pool from the statistics snapshot
+  /// @param [in] log level
+  /// @return void
+  ///
+  void LogStatistics(int32_t level = DLOG_INFO) const {
+    if (!IsLogEnable(GE_MODULE_NAME, level)) {
+      return;
+    }
+    CachingAllocatorStatistics statistics;
+    GetStatistics(statistics);
+    GELOGI("[CachingAllocator] memory type:%d malloced:%zu in use:%zu cached:%zu fragmentation:%.3f split:%zu "
+           "merge:%zu malloc:%zu free:%zu", static_cast<int32_t>(memory_type_), statistics.malloced_size,
+           statistics.in_use_size, statistics.cached_size, statistics.GetFragmentation(),
+           statistics.split_block_num, statistics.merge_counts, statistics.malloc_counts, statistics.free_counts);
+    for (uint32_t i = 0U; i < kNumBins; ++i) {
+      const CachingBinStatistics &bin_statistics = statistics.bins[i];
+      GELOGI("[CachingAllocator] bin:%u in use:%zu(%zu blocks) cached:%zu(%zu blocks) max cached block:%zu", i,
+             bin_statistics.in_use_size, bin_statistics.in_use_block_num, bin_statistics.cached_size,
+             bin_statistics.cached_block_num, bin_statistics.max_cached_block_size);
+    }
+  }
+
  private:
 
   ///
@@ -192,7 +290,7 @@ class CachingAllocator {
 
   ///
   /// @ingroup ge_graph
-  /// @brief print the memory info in pool
+  /// @brief print the memory info in pool, superseded by LogStatistics
   /// @param [in] log level
   /// @return void
   ///
@@ -221,6 +319,9 @@ class CachingAllocator {
 
   //user call Free total counts
   std::atomic<size_t> called_free_counts_;
+
+  // split blocks merged by MergeBlocks
+  std::atomic<size_t> called_merge_counts_{0U};
 };
 }  // namespace ge
 #endif  // GE_GRAPH_MANAGER_GRAPH_CACHING_ALLOCATOR_H_
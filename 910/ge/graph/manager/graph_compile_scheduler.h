@@ -0,0 +1,337 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_MANAGER_GRAPH_COMPILE_SCHEDULER_H_
+#define GE_GRAPH_MANAGER_GRAPH_COMPILE_SCHEDULER_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/util/error_manager/error_manager.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/ge_context.h"
+#include "graph/ge_local_context.h"
+
+namespace ge {
+enum class CompileStage : uint32_t {
+  kPrepare = 0U,
+  kOptimize,
+  kPartition,
+  kBuild,
+  kLoad,
+  kStageNum
+};
+
+constexpr size_t kCompileStageNum = static_cast<size_t>(CompileStage::kStageNum);
+
+inline const char *GetCompileStageName(const CompileStage stage) {
+  static const char *const kStageNames[kCompileStageNum] = {"Prepare", "Optimize", "Partition", "Build", "Load"};
+  const size_t index = static_cast<size_t>(stage);
+  return (index < kCompileStageNum) ? kStageNames[index] : "Unknown";
+}
+
+struct CompileStageStatistics {
+  uint64_t count = 0UL;
+  uint64_t total_us = 0UL;
+  uint64_t max_us = 0UL;
+  uint64_t wait_us = 0UL;  // time of jobs ready for this stage but not run yet
+};
+
+struct CompileJobTiming {
+  std::array<uint64_t, kCompileStageNum> stage_us{};
+  uint64_t total_us = 0UL;  // from submit to done
+};
+
+/**
+ * Compile one graph as a sequence of stages, a stage without function is skipped.
+ * The job owns its state between stages, e.g. the compute graph and root model of a PreRun.
+ */
+struct GraphCompileJob {
+  uint32_t graph_id = 0U;
+  int32_t priority = 0;  // larger runs first
+  std::array<std::function<Status()>, kCompileStageNum> stages;
+  std::function<void(Status, const CompileJobTiming &)> callback;
+};
+
+/**
+ * Run compile jobs of many graphs on a pool of workers. Each stage of a job is one schedule unit, so workers overlap
+ * different stages of different graphs. Ready units are picked by priority of job, then by later stage, so that
+ * started graphs are finished first, then by submit order. Stages of one graph run in order, jobs of the same graph
+ * id run one after another, and every stage can be limited in concurrency, e.g. load of models to device.
+ * The thread local context, session id and error context of the submitter follow the job from stage to stage.
+ */
+class GraphCompileScheduler {
+ public:
+  explicit GraphCompileScheduler(const uint32_t thread_num) : thread_num_((thread_num == 0U) ? 1U : thread_num) {
+    stage_limits_.fill(thread_num_);
+  }
+  ~GraphCompileScheduler() {
+    Stop();
+  }
+  GraphCompileScheduler(const GraphCompileScheduler &) = delete;
+  GraphCompileScheduler &operator=(const GraphCompileScheduler &) = delete;
+
+  /**
+   * Limit number of jobs running the stage at the same time, must be called before Start
+   */
+  void SetStageLimit(const CompileStage stage, const uint32_t limit) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stage_limits_[static_cast<size_t>(stage)] = (limit == 0U) ? 1U : limit;
+  }
+
+  Status Start() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!workers_.empty()) {
+      return SUCCESS;
+    }
+    stopped_ = false;
+    for (uint32_t i = 0U; i < thread_num_; ++i) {
+      workers_.emplace_back(&GraphCompileScheduler::WorkerFunc, this);
+    }
+    GELOGI("Graph compile scheduler started, thread num:%u", thread_num_);
+    return SUCCESS;
+  }
+
+  /**
+   * Stop workers, jobs waiting for their next stage are finished with status FAILED.
+   * May be called from a stage or callback, the calling worker is detached instead of joined and exits once the
+   * stage or callback returns. The scheduler itself must not be destroyed from a stage or callback
+   */
+  void Stop() {
+    std::vector<std::thread> workers;
+    std::list<JobState> dropped;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+      workers.swap(workers_);
+      for (auto it = jobs_.begin(); it != jobs_.end();) {
+        if (!it->running) {
+          auto next = std::next(it);
+          dropped.splice(dropped.end(), jobs_, it);
+          it = next;
+        } else {
+          ++it;
+        }
+      }
+    }
+    cv_.notify_all();
+    const auto self_id = std::this_thread::get_id();
+    for (auto &worker : workers) {
+      if (worker.get_id() == self_id) {
+        GELOGW("Graph compile scheduler is stopped by its own worker, which is detached");
+        worker.detach();
+      } else if (worker.joinable()) {
+        worker.join();
+      }
+    }
+    for (auto &job : dropped) {
+      GELOGW("Compile job of graph %u is dropped at stage %s", job.job.graph_id, GetCompileStageName(job.stage));
+      Finish(job, FAILED);
+    }
+  }
+
+  /**
+   * Submit job, returns future of final status. Callback of job is called before future is ready, on worker thread,
+   * or on the calling thread if the job has no stage or the scheduler is not running
+   */
+  std::future<Status> Submit(GraphCompileJob &&job) {
+    JobState state;
+    state.job = std::move(job);
+    auto future = state.promise.get_future();
+    state.submit_time = Clock::now();
+    state.ready_time = state.submit_time;
+    Status status = SUCCESS;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (stopped_ || workers_.empty()) {
+        GELOGE(FAILED, "[Submit][CompileJob] scheduler is not running, graph id:%u", state.job.graph_id);
+        status = FAILED;
+      } else {
+        state.context = GetThreadLocalContext();
+        state.error_context = ErrorManager::GetInstance().GetErrorManagerContext();
+        state.session_id = GetContext().SessionId();
+        SkipEmptyStages(state);
+        if (state.stage != CompileStage::kStageNum) {
+          jobs_.emplace_back(std::move(state));
+          lock.unlock();
+          cv_.notify_one();
+          return future;
+        }
+      }
+    }
+    // callback of a job rejected or without stages runs on the calling thread, never with mutex_ held
+    Finish(state, status);
+    return future;
+  }
+
+  size_t GetPendingNum() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+  }
+
+  std::array<CompileStageStatistics, kCompileStageNum> GetStatistics() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct JobState {
+    GraphCompileJob job;
+    std::promise<Status> promise;
+    CompileStage stage = CompileStage::kPrepare;
+    bool running = false;
+    CompileJobTiming timing;
+    GEThreadLocalContext context;
+    error_message::Context error_context;
+    uint64_t session_id = 0UL;
+    Clock::time_point submit_time;
+    Clock::time_point ready_time;
+  };
+
+  static uint64_t ElapsedUs(const Clock::time_point &begin, const Clock::time_point &end) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+  }
+
+  static void SkipEmptyStages(JobState &state) {
+    while ((state.stage != CompileStage::kStageNum) && (!state.job.stages[static_cast<size_t>(state.stage)])) {
+      state.stage = static_cast<CompileStage>(static_cast<uint32_t>(state.stage) + 1U);
+    }
+  }
+
+  // called with mutex_ held
+  std::list<JobState>::iterator PickReady() {
+    auto best = jobs_.end();
+    std::set<uint32_t> seen_graphs;
+    for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+      // jobs_ is in submit order, only the first job of a graph may run
+      if (!seen_graphs.insert(it->job.graph_id).second) {
+        continue;
+      }
+      const size_t stage_index = static_cast<size_t>(it->stage);
+      if (it->running || (running_num_[stage_index] >= stage_limits_[stage_index])) {
+        continue;
+      }
+      if ((best == jobs_.end()) || (it->job.priority > best->job.priority) ||
+          ((it->job.priority == best->job.priority) && (it->stage > best->stage))) {
+        best = it;
+      }
+    }
+    return best;
+  }
+
+  void Finish(JobState &state, const Status status) {
+    state.timing.total_us = ElapsedUs(state.submit_time, Clock::now());
+    if (state.job.callback) {
+      state.job.callback(status, state.timing);
+    }
+    state.promise.set_value(status);
+  }
+
+  static void WorkerFunc(GraphCompileScheduler *const scheduler) {
+    std::unique_lock<std::mutex> lock(scheduler->mutex_);
+    while (true) {
+      auto it = scheduler->jobs_.end();
+      scheduler->cv_.wait(lock, [scheduler, &it]() {
+        it = scheduler->PickReady();
+        return scheduler->stopped_ || (it != scheduler->jobs_.end());
+      });
+      if (scheduler->stopped_) {
+        return;
+      }
+      JobState &state = *it;
+      const size_t stage_index = static_cast<size_t>(state.stage);
+      const auto start_time = Clock::now();
+      state.running = true;
+      ++scheduler->running_num_[stage_index];
+      scheduler->statistics_[stage_index].wait_us += ElapsedUs(state.ready_time, start_time);
+      lock.unlock();
+
+      // a stage may run on another worker than the one before, it continues in the context left by that stage
+      GetThreadLocalContext() = state.context;
+      ErrorManager::GetInstance().SetErrorContext(state.error_context);
+      GetContext().SetSessionId(state.session_id);
+      GELOGD("Graph %u starts compile stage %s", state.job.graph_id, GetCompileStageName(state.stage));
+      Status ret = SUCCESS;
+      try {
+        ret = state.job.stages[stage_index]();
+      } catch (const std::exception &e) {
+        GELOGE(FAILED, "[Run][CompileStage] graph %u stage %s throws %s", state.job.graph_id,
+               GetCompileStageName(state.stage), e.what());
+        ret = FAILED;
+      }
+      state.context = GetThreadLocalContext();
+      state.error_context = ErrorManager::GetInstance().GetErrorManagerContext();
+      const auto end_time = Clock::now();
+      const uint64_t cost = ElapsedUs(start_time, end_time);
+      state.timing.stage_us[stage_index] = cost;
+      GELOGI("Graph %u finished compile stage %s, ret:%u, cost:%lu us", state.job.graph_id,
+             GetCompileStageName(state.stage), ret, cost);
+
+      lock.lock();
+      --scheduler->running_num_[stage_index];
+      CompileStageStatistics &statistics = scheduler->statistics_[stage_index];
+      ++statistics.count;
+      statistics.total_us += cost;
+      statistics.max_us = std::max(statistics.max_us, cost);
+      state.running = false;
+      state.stage = static_cast<CompileStage>(stage_index + 1U);
+      SkipEmptyStages(state);
+      state.ready_time = end_time;
+      if ((ret == SUCCESS) && (state.stage != CompileStage::kStageNum) && scheduler->stopped_) {
+        GELOGW("Compile job of graph %u is dropped at stage %s", state.job.graph_id, GetCompileStageName(state.stage));
+        ret = FAILED;
+      }
+      if ((ret != SUCCESS) || (state.stage == CompileStage::kStageNum)) {
+        JobState done = std::move(state);
+        scheduler->jobs_.erase(it);
+        lock.unlock();
+        scheduler->cv_.notify_all();
+        scheduler->Finish(done, ret);
+        lock.lock();
+      } else {
+        scheduler->cv_.notify_all();
+      }
+    }
+  }
+
+  const uint32_t thread_num_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::thread> workers_;
+  std::list<JobState> jobs_;  // in submit order
+  bool stopped_ = false;
+  std::array<uint32_t, kCompileStageNum> stage_limits_{};
+  std::array<uint32_t, kCompileStageNum> running_num_{};
+  std::array<CompileStageStatistics, kCompileStageNum> statistics_{};
+};
+}  // namespace ge
+
+#endif  // GE_GRAPH_MANAGER_GRAPH_COMPILE_SCHEDULER_H_
@@ -0,0 +1,257 @@
+/**
+ * Copyright 2019-2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_MANAGER_SHARDED_CACHING_ALLOCATOR_H_
+#define GE_GRAPH_MANAGER_SHARDED_CACHING_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/manager/graph_caching_allocator.h"
+
+namespace ge {
+constexpr size_t kDefaultShardNum = 8U;
+constexpr size_t kDefaultShardCacheSize = 64U * kMByteSize;  // bytes kept in front of the shared bins per shard
+
+struct ShardedCachingStatistics {
+  size_t hit_counts = 0U;          // Malloc served by a shard free list
+  size_t miss_counts = 0U;         // Malloc forwarded to the backing allocator
+  size_t in_use_size = 0U;
+  size_t peak_in_use_size = 0U;
+  size_t cached_size = 0U;         // bytes held by shard free lists
+  size_t cached_block_num = 0U;
+
+  double GetHitRatio() const {
+    const size_t total = hit_counts + miss_counts;
+    return (total == 0U) ? 0.0 : (static_cast<double>(hit_counts) / total);
+  }
+};
+
+///
+/// Per-thread caches in front of a shared allocator. Each thread hashes to one shard, so repeated Malloc/Free of
+/// the same rounded sizes only takes the shard lock and never the recursive lock of the backing CachingAllocator.
+/// Cached blocks stay allocated in the backing allocator until Flush.
+///
+class ShardedCachingAllocator {
+ public:
+  using MallocFunc = std::function<uint8_t *(size_t)>;
+  using FreeFunc = std::function<Status(uint8_t *)>;
+
+  ShardedCachingAllocator(MallocFunc malloc_func, FreeFunc free_func, size_t shard_num = kDefaultShardNum,
+                          size_t shard_cache_size = kDefaultShardCacheSize)
+      : malloc_func_(std::move(malloc_func)), free_func_(std::move(free_func)),
+        shards_((shard_num == 0U) ? 1U : shard_num), shard_cache_size_(shard_cache_size) {}
+
+  ShardedCachingAllocator(const ShardedCachingAllocator &) = delete;
+  ShardedCachingAllocator &operator=(const ShardedCachingAllocator &) = delete;
+
+  // cached blocks are not returned here, the backing allocator releases them on its own finalize
+  ~ShardedCachingAllocator() = default;
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief shard mode in front of a CachingAllocator
+  /// @param [in] allocator shared allocator, must outlive the returned object
+  /// @param [in] device_id device id
+  /// @return sharded allocator
+  ///
+  static std::unique_ptr<ShardedCachingAllocator> Create(CachingAllocator &allocator, uint32_t device_id = 0U,
+                                                         size_t shard_num = kDefaultShardNum,
+                                                         size_t shard_cache_size = kDefaultShardCacheSize) {
+    return std::unique_ptr<ShardedCachingAllocator>(new (std::nothrow) ShardedCachingAllocator(
+        [&allocator, device_id](size_t size) { return allocator.Malloc(size, nullptr, device_id); },
+        [&allocator, device_id](uint8_t *ptr) { return allocator.Free(ptr, device_id); },
+        shard_num, shard_cache_size));
+  }
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief shard mode backed by host memory, used when no device is present
+  /// @return sharded allocator
+  ///
+  static std::unique_ptr<ShardedCachingAllocator> CreateHostStub(size_t shard_num = kDefaultShardNum,
+                                                                 size_t shard_cache_size = kDefaultShardCacheSize) {
+    return std::unique_ptr<ShardedCachingAllocator>(new (std::nothrow) ShardedCachingAllocator(
+        [](size_t size) { return static_cast<uint8_t *>(std::malloc(size)); },
+        [](uint8_t *ptr) {
+          std::free(ptr);
+          return SUCCESS;
+        },
+        shard_num, shard_cache_size));
+  }
+
+  uint8_t *Malloc(size_t size) {
+    const size_t rounded = RoundSize(size);
+    Shard &shard = ThisShard();
+    uint8_t *ptr = nullptr;
+    {
+      const std::lock_guard<std::mutex> lock(shard.mutex);
+      const auto it = shard.free_lists.find(rounded);
+      if ((it != shard.free_lists.end()) && (!it->second.empty())) {
+        ptr = it->second.back();
+        it->second.pop_back();
+        shard.cached_size -= rounded;
+        --shard.cached_block_num;
+      }
+    }
+    if (ptr != nullptr) {
+      (void)hit_counts_.fetch_add(1U, std::memory_order_relaxed);
+    } else {
+      (void)miss_counts_.fetch_add(1U, std::memory_order_relaxed);
+      ptr = malloc_func_(rounded);
+      if (ptr == nullptr) {
+        // memory held by other shards may be what the backing allocator is missing
+        Flush();
+        ptr = malloc_func_(rounded);
+      }
+      if (ptr == nullptr) {
+        GELOGE(MEMALLOC_FAILED, "[Malloc][Memory]failed, size:%zu", rounded);
+        return nullptr;
+      }
+    }
+    Owner &owner = OwnerOf(ptr);
+    {
+      const std::lock_guard<std::mutex> lock(owner.mutex);
+      owner.sizes[ptr] = rounded;
+    }
+    UpdateInUse(rounded);
+    return ptr;
+  }
+
+  Status Free(uint8_t *ptr) {
+    GE_CHECK_NOTNULL(ptr);
+    size_t size = 0U;
+    Owner &owner = OwnerOf(ptr);
+    {
+      const std::lock_guard<std::mutex> lock(owner.mutex);
+      const auto it = owner.sizes.find(ptr);
+      if (it == owner.sizes.end()) {
+        GELOGE(PARAM_INVALID, "[Check][Param]ptr is not allocated by sharded caching allocator");
+        return PARAM_INVALID;
+      }
+      size = it->second;
+      (void)owner.sizes.erase(it);
+    }
+    (void)in_use_size_.fetch_sub(size, std::memory_order_relaxed);
+    Shard &shard = ThisShard();
+    {
+      const std::lock_guard<std::mutex> lock(shard.mutex);
+      if ((shard.cached_size + size) <= shard_cache_size_) {
+        shard.free_lists[size].push_back(ptr);
+        shard.cached_size += size;
+        ++shard.cached_block_num;
+        return SUCCESS;
+      }
+    }
+    return free_func_(ptr);
+  }
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief return blocks cached by all shards to the backing allocator
+  /// @return void
+  ///
+  void Flush() {
+    for (Shard &shard : shards_) {
+      std::unordered_map<size_t, std::vector<uint8_t *>> free_lists;
+      {
+        const std::lock_guard<std::mutex> lock(shard.mutex);
+        free_lists.swap(shard.free_lists);
+        shard.cached_size = 0U;
+        shard.cached_block_num = 0U;
+      }
+      for (const auto &free_list : free_lists) {
+        for (uint8_t *const ptr : free_list.second) {
+          if (free_func_(ptr) != SUCCESS) {
+            GELOGW("Free cached block of size %zu failed.", free_list.first);
+          }
+        }
+      }
+    }
+  }
+
+  void GetStatistics(ShardedCachingStatistics &statistics) const {
+    statistics = ShardedCachingStatistics();
+    statistics.hit_counts = hit_counts_.load(std::memory_order_relaxed);
+    statistics.miss_counts = miss_counts_.load(std::memory_order_relaxed);
+    statistics.in_use_size = in_use_size_.load(std::memory_order_relaxed);
+    statistics.peak_in_use_size = peak_in_use_size_.load(std::memory_order_relaxed);
+    for (const Shard &shard : shards_) {
+      const std::lock_guard<std::mutex> lock(shard.mutex);
+      statistics.cached_size += shard.cached_size;
+      statistics.cached_block_num += shard.cached_block_num;
+    }
+  }
+
+ private:
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<size_t, std::vector<uint8_t *>> free_lists;
+    size_t cached_size = 0U;
+    size_t cached_block_num = 0U;
+  };
+
+  struct Owner {
+    std::mutex mutex;
+    std::unordered_map<uint8_t *, size_t> sizes;
+  };
+
+  static size_t RoundSize(size_t size) {
+    return (size == 0U) ? kRoundBlockSize : (((size + kRoundBlockSize - 1U) / kRoundBlockSize) * kRoundBlockSize);
+  }
+
+  Shard &ThisShard() {
+    return shards_[std::hash<std::thread::id>()(std::this_thread::get_id()) % shards_.size()];
+  }
+
+  // a block may be freed by another thread than the one that malloced it, so ownership is keyed by address
+  Owner &OwnerOf(const uint8_t *ptr) {
+    return owners_[(reinterpret_cast<uintptr_t>(ptr) / kRoundBlockSize) % kOwnerNum];
+  }
+
+  void UpdateInUse(size_t size) {
+    const size_t in_use = in_use_size_.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peak_in_use_size_.load(std::memory_order_relaxed);
+    while ((in_use > peak) &&
+           (!peak_in_use_size_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed))) {
+    }
+  }
+
+  static constexpr size_t kOwnerNum = 16U;
+
+  MallocFunc malloc_func_;
+  FreeFunc free_func_;
+  std::vector<Shard> shards_;
+  Owner owners_[kOwnerNum];
+  size_t shard_cache_size_;
+  std::atomic<size_t> hit_counts_{0U};
+  std::atomic<size_t> miss_counts_{0U};
+  std::atomic<size_t> in_use_size_{0U};
+  std::atomic<size_t> peak_in_use_size_{0U};
+};
+}  // namespace ge
+#endif  // GE_GRAPH_MANAGER_SHARDED_CACHING_ALLOCATOR_H_
@@ -173,11 +173,29 @@ class BaseNodePass {
 
 using NamesToPass = std::vector<std::pair<std::string, BaseNodePass *>>;
 
+struct PassStatistics {
+  std::string name;
+  uint64_t time_us = 0UL;
+  uint64_t visit_count = 0UL;   // times Run is called
+  uint64_t change_count = 0UL;  // runs that reported changed, deleted, suspended or resumed nodes
+  uint64_t skip_count = 0UL;    // runs saved since the node is unchanged since the last visit of the pass
+};
+
 class GEPass {
  public:
   explicit GEPass(ComputeGraphPtr &graph) : graph_(graph), root_graph_(graph), depth_(1) {}
   virtual ~GEPass() = default;
   Status Run(const NamesToPass &names_to_passes);
+
+  ///
+  /// Run passes only on nodes changed since each pass last visited them, see IncrementalPassEngine.
+  /// Passes on sub graphs are run in the same mode. Defined in incremental_pass_engine.h, Run goes here
+  /// when incremental mode is enabled.
+  ///
+  Status RunIncremental(const NamesToPass &names_to_passes);
+  void EnableIncremental(bool enable) { incremental_ = enable; }
+  bool IsIncremental() const { return incremental_; }
+  const std::vector<PassStatistics> &GetPassStatistics() const { return pass_statistics_; }
   /*
 * todo
 * OneGraph: nodes_deleted, nodes_seen, nodes_passed, nodes_suspended
@@ -250,6 +268,8 @@ class GEPass {
   ComputeGraphPtr graph_;
   ComputeGraphPtr root_graph_;
   int depth_;
+  bool incremental_ = false;
+  std::vector<PassStatistics> pass_statistics_;
 };
 }  // namespace ge
 
@@ -0,0 +1,291 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_HYBRID_COMMON_EXECUTION_ARENA_H_
+#define GE_HYBRID_COMMON_EXECUTION_ARENA_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "framework/common/debug/ge_log.h"
+
+namespace ge {
+namespace hybrid {
+const char *const kOptionHybridExecutionArena = "ge.exec.hybridExecutionArena";
+constexpr size_t kArenaDefaultAlign = 32U;
+constexpr size_t kArenaMinBlockSize = 2U * 1024U * 1024U;
+
+struct ExecutionArenaStatistics {
+  uint64_t alloc_num = 0UL;
+  uint64_t overflow_block_num = 0UL;    // blocks allocated since the arena was smaller than the iteration
+  uint64_t reset_num = 0UL;
+  uint64_t escaped_reset_num = 0UL;     // resets with buffers still alive, their blocks are retired
+  size_t capacity = 0U;                 // size of primary block
+  size_t high_water = 0U;               // bytes allocated in the last iteration
+  size_t retired_block_num = 0U;        // blocks kept for buffers that outlive their iteration
+};
+
+// Bump allocator for the tensors of one execution. Buffers are carved from one primary block sized from the high
+// water of the previous iteration, and from overflow blocks when it runs short. Deallocate only counts buffers down,
+// memory comes back at Reset in O(1). Buffers alive at Reset escaped the iteration, e.g. outputs held by the user,
+// their blocks are retired and freed by the last Deallocate, so Reset never hands out memory still in use.
+// Allocate is lock free while the primary block lasts and may run on any thread, but not concurrently with Reset.
+// Deallocate of a buffer of the current primary block only counts down, other buffers take the lock.
+class ExecutionArena {
+ public:
+  using BlockAllocFunc = std::function<void *(size_t size)>;
+  using BlockFreeFunc = std::function<void(void *block)>;
+
+  ExecutionArena(BlockAllocFunc alloc_block, BlockFreeFunc free_block, const size_t align = kArenaDefaultAlign)
+      : alloc_block_(std::move(alloc_block)), free_block_(std::move(free_block)),
+        align_((align == 0U) ? 1U : align), owner_(new (std::nothrow) Generation()), current_(owner_.get()) {}
+
+  ~ExecutionArena() {
+    const std::lock_guard<std::mutex> lk(mu_);
+    if (owner_ != nullptr) {
+      FreeBlocks(*owner_);
+    }
+    for (const auto &retired : retired_) {
+      GELOGW("Execution arena destroyed with %ld buffers alive", retired->live.load());
+      FreeBlocks(*retired);
+    }
+  }
+
+  ExecutionArena(const ExecutionArena &) = delete;
+  ExecutionArena &operator=(const ExecutionArena &) = delete;
+
+  // returns nullptr if no block can be allocated, caller falls back to its allocator
+  void *Allocate(const size_t size) {
+    Generation *const generation = current_.load();
+    if (generation == nullptr) {
+      return nullptr;
+    }
+    const size_t aligned_size = AlignUp(std::max(size, static_cast<size_t>(1U)));
+    const size_t begin = primary_offset_.fetch_add(aligned_size);
+    void *buffer = nullptr;
+    if ((begin <= generation->primary_size) && (aligned_size <= (generation->primary_size - begin))) {
+      buffer = generation->primary + begin;
+    } else {
+      buffer = AllocateOverflow(*generation, aligned_size);
+      if (buffer == nullptr) {
+        return nullptr;
+      }
+    }
+    (void)used_.fetch_add(aligned_size);
+    (void)alloc_num_.fetch_add(1UL);
+    (void)generation->live.fetch_add(1);
+    return buffer;
+  }
+
+  // returns false if buffer is not from this arena
+  bool Deallocate(const void *const buffer) {
+    if (buffer == nullptr) {
+      return false;
+    }
+    const uint8_t *const addr = static_cast<const uint8_t *>(buffer);
+    // primary block of the current generation, counted readers keep a generation replaced meanwhile from deletion
+    (void)fast_readers_.fetch_add(1U);
+    Generation *const generation = current_.load();
+    const bool in_current = (generation != nullptr) && InPrimary(*generation, addr);
+    const bool last = in_current && (generation->live.fetch_sub(1) == 1);
+    (void)fast_readers_.fetch_sub(1U);
+    if (in_current) {
+      if (last) {  // Reset retired the generation meanwhile
+        const std::lock_guard<std::mutex> lk(mu_);
+        ReleaseRetired(generation);
+      }
+      return true;
+    }
+    // overflow blocks and escaped buffers, which may be freed while Reset replaces the generation
+    const std::lock_guard<std::mutex> lk(mu_);
+    if ((owner_ != nullptr) && InOverflow(*owner_, addr)) {
+      (void)owner_->live.fetch_sub(1);
+      return true;
+    }
+    for (const auto &retired : retired_) {
+      if (InPrimary(*retired, addr) || InOverflow(*retired, addr)) {
+        if (retired->live.fetch_sub(1) == 1) {
+          ReleaseRetired(retired.get());
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // end of iteration, the next iteration gets one primary block of the high water of this one
+  void Reset() {
+    const size_t high_water = used_.exchange(0U);
+    primary_offset_.store(0U);
+    const std::lock_guard<std::mutex> lk(mu_);
+    high_water_ = high_water;
+    ++reset_num_;
+    if (owner_ == nullptr) {
+      return;
+    }
+    // drop the reference of the owner, buffers still alive keep the generation
+    const bool escaped = (owner_->live.fetch_sub(1) != 1);
+    if ((!escaped) && owner_->overflow.empty()) {
+      owner_->live.store(1);
+      return;
+    }
+    const size_t capacity = AlignUp(std::max(std::max(high_water, owner_->primary_size), kArenaMinBlockSize));
+    std::unique_ptr<Generation> previous = std::move(owner_);
+    owner_.reset(new (std::nothrow) Generation());
+    if (owner_ != nullptr) {
+      owner_->primary = static_cast<uint8_t *>(alloc_block_(capacity));
+      owner_->primary_size = (owner_->primary == nullptr) ? 0U : capacity;
+      if (owner_->primary == nullptr) {
+        GELOGW("Execution arena failed to allocate primary block of %zu bytes", capacity);
+      }
+    }
+    current_.store(owner_.get());
+    if (escaped) {
+      ++escaped_reset_num_;
+      GELOGD("Execution arena reset with %ld buffers alive, %zu generations retired", previous->live.load(),
+             retired_.size() + 1U);
+      retired_.emplace_back(std::move(previous));
+    } else {
+      FreeBlocks(*previous);
+      Bury(std::move(previous));
+    }
+  }
+
+  ExecutionArenaStatistics GetStatistics() const {
+    const std::lock_guard<std::mutex> lk(mu_);
+    ExecutionArenaStatistics statistics;
+    statistics.alloc_num = alloc_num_.load();
+    statistics.overflow_block_num = overflow_block_num_;
+    statistics.reset_num = reset_num_;
+    statistics.escaped_reset_num = escaped_reset_num_;
+    statistics.capacity = (owner_ == nullptr) ? 0U : owner_->primary_size;
+    statistics.high_water = high_water_;
+    for (const auto &retired : retired_) {
+      statistics.retired_block_num += retired->overflow.size() + ((retired->primary == nullptr) ? 0U : 1U);
+    }
+    return statistics;
+  }
+
+ private:
+  struct Block {
+    uint8_t *base;
+    size_t size;
+    size_t offset;
+  };
+
+  struct Generation {
+    uint8_t *primary = nullptr;
+    size_t primary_size = 0U;
+    std::vector<Block> overflow;  // guarded by mu_
+    std::atomic<int64_t> live{1};  // buffers alive, plus one while the generation is the owner
+  };
+
+  size_t AlignUp(const size_t size) const {
+    return ((size + align_ - 1U) / align_) * align_;
+  }
+
+  static bool InPrimary(const Generation &generation, const uint8_t *const addr) {
+    return (generation.primary != nullptr) && (addr >= generation.primary) &&
+           (addr < (generation.primary + generation.primary_size));
+  }
+
+  static bool InOverflow(const Generation &generation, const uint8_t *const addr) {
+    for (const auto &block : generation.overflow) {
+      if ((addr >= block.base) && (addr < (block.base + block.size))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void *AllocateOverflow(Generation &generation, const size_t aligned_size) {
+    const std::lock_guard<std::mutex> lk(mu_);
+    if (!generation.overflow.empty()) {
+      Block &block = generation.overflow.back();
+      if (aligned_size <= (block.size - block.offset)) {
+        void *const buffer = block.base + block.offset;
+        block.offset += aligned_size;
+        return buffer;
+      }
+    }
+    const size_t block_size = std::max(aligned_size, std::max(generation.primary_size, kArenaMinBlockSize));
+    uint8_t *const base = static_cast<uint8_t *>(alloc_block_(block_size));
+    if (base == nullptr) {
+      GELOGW("Execution arena failed to allocate block of %zu bytes", block_size);
+      return nullptr;
+    }
+    ++overflow_block_num_;
+    generation.overflow.emplace_back(Block{base, block_size, aligned_size});
+    return base;
+  }
+
+  // primary is left as is, the fast path of Deallocate may still compare addresses with it
+  void FreeBlocks(Generation &generation) {
+    if (generation.primary != nullptr) {
+      free_block_(generation.primary);
+    }
+    for (const auto &block : generation.overflow) {
+      free_block_(block.base);
+    }
+    generation.overflow.clear();
+  }
+
+  // the last buffer of a retired generation is gone, called with mu_ held
+  void ReleaseRetired(const Generation *const generation) {
+    for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+      if (it->get() == generation) {
+        FreeBlocks(**it);
+        Bury(std::move(*it));
+        (void)retired_.erase(it);
+        return;
+      }
+    }
+  }
+
+  // a replaced generation is deleted once no fast path Deallocate may be reading it, called with mu_ held
+  void Bury(std::unique_ptr<Generation> generation) {
+    buried_.emplace_back(std::move(generation));
+    if (fast_readers_.load() == 0U) {
+      buried_.clear();
+    }
+  }
+
+  BlockAllocFunc alloc_block_;
+  BlockFreeFunc free_block_;
+  size_t align_;
+  std::unique_ptr<Generation> owner_;  // guarded by mu_
+  std::atomic<Generation *> current_;  // owner_ for lock free Allocate
+  std::atomic<size_t> primary_offset_{0U};
+  std::atomic<size_t> used_{0U};
+  std::atomic<uint64_t> alloc_num_{0UL};
+  mutable std::mutex mu_;
+  std::list<std::unique_ptr<Generation>> retired_;
+  std::atomic<uint32_t> fast_readers_{0U};
+  std::vector<std::unique_ptr<Generation>> buried_;  // blocks freed, guarded by mu_
+  uint64_t overflow_block_num_ = 0UL;
+  uint64_t reset_num_ = 0UL;
+  uint64_t escaped_reset_num_ = 0UL;
+  size_t high_water_ = 0U;
+};
+}  // namespace hybrid
+}  // namespace ge
+#endif  // GE_HYBRID_COMMON_EXECUTION_ARENA_H_
@@ -22,11 +22,12 @@
 #include <memory>
 #include "framework/memory/memory_api.h"
 #include "framework/common/util.h"
+#include "hybrid/common/execution_arena.h"
+#include "hybrid/common/npu_memory_allocator.h"
+#include "runtime/mem.h"
 
 namespace ge {
 namespace hybrid {
-class NpuMemoryAllocator;
-class AllocationAttr;
 
 class TensorBuffer {
  public:
@@ -36,11 +37,46 @@ class TensorBuffer {
 
   static std::unique_ptr<TensorBuffer> Create(void *buffer, size_t size);
 
+  // carve buffer from execution arena, falls back to allocator if arena is null or out of memory, or attr asks for
+  // padding, reuse or another memory type
+  static std::unique_ptr<TensorBuffer> Create(const std::shared_ptr<ExecutionArena> &arena,
+                                              NpuMemoryAllocator *allocator,
+                                              size_t size,
+                                              AllocationAttr *attr = nullptr) {
+    if ((arena == nullptr) || (attr != nullptr) || (size == 0U)) {
+      return Create(allocator, size, attr);
+    }
+    void *const buffer = arena->Allocate(size);
+    if (buffer == nullptr) {
+      return Create(allocator, size, attr);
+    }
+    std::unique_ptr<TensorBuffer> tensor_buffer(new (std::nothrow) TensorBuffer(allocator, buffer, size));
+    if (tensor_buffer == nullptr) {
+      (void)arena->Deallocate(buffer);
+      return nullptr;
+    }
+    tensor_buffer->arena_ = arena;
+    return tensor_buffer;
+  }
+
   TensorBuffer(const TensorBuffer &) = delete;
   TensorBuffer &operator = (const TensorBuffer &) = delete;
-  ~TensorBuffer();
+  ~TensorBuffer() {
+    if ((arena_ != nullptr) && arena_->Deallocate(buffer_)) {
+      buffer_ = nullptr;
+      return;
+    }
+    if (allocator_ != nullptr) {
+      allocator_->Deallocate(buffer_, mem_type_);
+      buffer_ = nullptr;
+    }
+  }
 
+  // released buffer is freed by allocator, buffer of arena is copied to memory of allocator first
   void* Release() {
+    if (arena_ != nullptr) {
+      return ReleaseFromArena();
+    }
     auto ret = buffer_;
     buffer_ = nullptr;
     return ret;
@@ -61,7 +97,24 @@ class TensorBuffer {
  private:
   TensorBuffer(NpuMemoryAllocator *allocator, void *buffer, size_t size, MemStorageType mem_type = HBM);
 
+  void *ReleaseFromArena() {
+    void *const copy = (allocator_ == nullptr) ? nullptr : allocator_->Allocate(size_);
+    if ((copy == nullptr) ||
+        (rtMemcpy(copy, size_, buffer_, size_, RT_MEMCPY_DEVICE_TO_DEVICE) != RT_ERROR_NONE)) {
+      GELOGE(MEMALLOC_FAILED, "[Release][Buffer] copy %zu bytes out of execution arena failed", size_);
+      if (copy != nullptr) {
+        allocator_->Deallocate(copy, mem_type_);
+      }
+      return nullptr;
+    }
+    (void)arena_->Deallocate(buffer_);
+    arena_.reset();
+    buffer_ = nullptr;
+    return copy;
+  }
+
   NpuMemoryAllocator *allocator_ = nullptr;
+  std::shared_ptr<ExecutionArena> arena_;  // buffer is returned to arena instead of allocator if set
   void *buffer_ = nullptr;
   size_t size_ = 0;
   MemStorageType mem_type_;
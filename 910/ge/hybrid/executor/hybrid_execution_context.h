@@ -20,10 +20,13 @@
 #include <atomic>
 #include <unordered_map>
 #include "common/blocking_queue.h"
+#include "common/ge/ge_util.h"
 #include "common/properties_manager.h"
 #include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
 #include "graph/ge_local_context.h"
 #include "graph/load/model_manager/davinci_model.h"
+#include "hybrid/common/execution_arena.h"
 #include "hybrid/common/npu_memory_allocator.h"
 #include "hybrid/common/tensor_value.h"
 #include "hybrid/executor/hybrid_profiler.h"
@@ -57,6 +60,42 @@ struct GraphExecutionContext {
   Status Synchronize(rtStream_t rt_stream);
   Status DumpExceptionInfo(const std::vector<rtExceptionInfo> &exception_infos);
 
+  // carve tensors of one execution from an arena if kOptionHybridExecutionArena is "1", called after allocator is set
+  Status EnableExecutionArena() {
+    arena.reset();
+    std::string option_value;
+    if ((GetThreadLocalContext().GetOption(kOptionHybridExecutionArena, option_value) != GRAPH_SUCCESS) ||
+        (option_value != "1")) {
+      return SUCCESS;
+    }
+    GE_CHECK_NOTNULL(allocator);
+    NpuMemoryAllocator *const block_allocator = allocator;
+    arena = MakeShared<ExecutionArena>([block_allocator](const size_t size) {
+      return block_allocator->Allocate(size);
+    }, [block_allocator](void *const block) {
+      block_allocator->Deallocate(block);
+    });
+    GE_CHECK_NOTNULL(arena);
+    GELOGI("Execution arena enabled, session id:%lu, context id:%lu", session_id, context_id);
+    return SUCCESS;
+  }
+
+  std::unique_ptr<TensorBuffer> AllocateTensorBuffer(const size_t size, AllocationAttr *const attr = nullptr) const {
+    return TensorBuffer::Create(arena, allocator, size, attr);
+  }
+
+  // start of an execution of root graph, buffers of the last one are freed or escaped, e.g. held by the user
+  void ResetExecutionArena() {
+    if (arena == nullptr) {
+      return;
+    }
+    arena->Reset();
+    const ExecutionArenaStatistics statistics = arena->GetStatistics();
+    GELOGD("Execution arena reset, capacity:%zu, high water:%zu, alloc num:%lu, overflow block num:%lu, "
+           "escaped reset num:%lu", statistics.capacity, statistics.high_water, statistics.alloc_num,
+           statistics.overflow_block_num, statistics.escaped_reset_num);
+  }
+
   uint64_t session_id = 0;
   uint64_t context_id = 0;
   const HybridModel *model = nullptr;
@@ -67,6 +106,8 @@ struct GraphExecutionContext {
   rtContext_t rt_gen_context = nullptr;
   std::unique_ptr<CallbackManager> callback_manager = nullptr;
   NpuMemoryAllocator *allocator = nullptr;
+  // set by EnableExecutionArena, shared with the TensorBuffers carved from it, which may outlive the context
+  std::shared_ptr<ExecutionArena> arena = nullptr;
   mutable std::unique_ptr<HybridProfiler> profiler = nullptr;
   DumpProperties dump_properties;
   bool trace_enabled = false;
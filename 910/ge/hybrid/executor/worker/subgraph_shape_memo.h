@@ -0,0 +1,275 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_HYBRID_EXECUTOR_WORKER_SUBGRAPH_SHAPE_MEMO_H_
+#define GE_HYBRID_EXECUTOR_WORKER_SUBGRAPH_SHAPE_MEMO_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "common/shape_keyed_cache.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/types.h"
+#include "graph/utils/tensor_utils.h"
+#include "hybrid/model/graph_item.h"
+#include "hybrid/model/node_item.h"
+
+namespace ge {
+namespace hybrid {
+constexpr size_t kShapeMemoDefaultMaxRecords = 16U;
+
+struct SubgraphShapeMemoStatistics {
+  uint64_t hit_count = 0UL;
+  uint64_t miss_count = 0UL;
+  uint64_t abandon_count = 0UL;   // misses whose record was incomplete and not saved
+  uint64_t evict_count = 0UL;
+  uint64_t infer_cost_us = 0UL;   // per node inference time spent on misses
+  uint64_t saved_us = 0UL;        // inference time of replayed records minus replay time
+  size_t record_num = 0U;
+};
+
+// Memo of the shapes of a whole subgraph keyed by the shapes of its inputs. On a miss nodes infer as before and each
+// dynamic node reports its output descs once inferred; when the subgraph ends the record is saved if every dynamic
+// node reported. On a hit the recorded output descs of all nodes are written in one pass before any node is
+// scheduled and nodes skip inference, input shapes still arrive through the shape inference states by propagation.
+// Only subgraphs whose shapes are a function of input shapes are memoized, see IsMemoizable.
+// Replay, ReplayRecord and Commit are called at subgraph begin and end, RecordNode may run concurrently on pre-run
+// threads.
+class SubgraphShapeMemo {
+ public:
+  explicit SubgraphShapeMemo(const size_t max_records = kShapeMemoDefaultMaxRecords) : records_(max_records) {}
+  ~SubgraphShapeMemo() = default;
+
+  SubgraphShapeMemo(const SubgraphShapeMemo &) = delete;
+  SubgraphShapeMemo &operator=(const SubgraphShapeMemo &) = delete;
+
+  // shapes must not depend on tensor values computed in the subgraph or on the order of execution
+  static bool IsMemoizable(const GraphItem &graph_item, std::string &reason) {
+    if (graph_item.HasCtrlFlowOp()) {
+      reason = "has control flow op";
+      return false;
+    }
+    for (const NodeItem *const node_item : graph_item.GetAllNodes()) {
+      if ((node_item->shape_inference_type == DEPEND_COMPUTE) ||
+          (node_item->shape_inference_type == DEPEND_SHAPE_RANGE)) {
+        reason = "output shape of " + node_item->NodeName() + " is known after execution";
+        return false;
+      }
+      for (const auto &src_node : node_item->dependents_for_shape_inference) {
+        const std::string &src_type = src_node->GetType();
+        if ((src_type != SHAPE) && (src_type != SHAPEN) && (src_type != SIZE) && (src_type != RANK) &&
+            (src_type != CONSTANT) && (src_type != CONSTANTOP)) {
+          reason = "shape of " + node_item->NodeName() + " depends on value of " + src_node->GetName();
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void Init(const GraphItem &graph_item) {
+    const std::lock_guard<std::mutex> lk(mu_);
+    dynamic_node_num_ = 0U;
+    for (const NodeItem *const node_item : graph_item.GetAllNodes()) {
+      if (!node_item->is_output_shape_static) {
+        ++dynamic_node_num_;
+      }
+    }
+  }
+
+  // true if a record of the signature is to be replayed by ReplayRecord in this execution, otherwise it is started
+  bool Replay(const std::vector<ConstGeTensorDescPtr> &input_desc) {
+    const std::lock_guard<std::mutex> lk(mu_);
+    recording_ = false;
+    replaying_.reset();
+    ShapeSignature signature;
+    for (const auto &tensor_desc : input_desc) {
+      if (tensor_desc == nullptr) {
+        ++statistics_.miss_count;
+        return false;
+      }
+      signature.AddTensor(*tensor_desc);
+    }
+    const std::shared_ptr<const Record> *const record = records_.Find(signature.Key());
+    if (record == nullptr) {
+      ++statistics_.miss_count;
+      key_ = signature.Key();
+      pending_.reset(new (std::nothrow) Record());
+      recorded_nodes_.clear();
+      recording_ = (pending_ != nullptr);
+      return false;
+    }
+    replaying_ = *record;
+    ++statistics_.hit_count;
+    statistics_.saved_us += replaying_->infer_cost_us;
+    return true;
+  }
+
+  // writes the recorded output descs of every node to its op desc as inference does, then calls replayed for it
+  Status ReplayRecord(const std::function<Status(const NodeItem &)> &replayed) {
+    std::shared_ptr<const Record> record;
+    {
+      const std::lock_guard<std::mutex> lk(mu_);
+      record = replaying_;
+    }
+    if (record == nullptr) {
+      return SUCCESS;
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto &node_shapes : record->nodes) {
+      ReplayTensors(node_shapes.outputs, *node_shapes.node_item);
+      const Status ret = replayed(*node_shapes.node_item);
+      if (ret != SUCCESS) {
+        return ret;
+      }
+    }
+    const uint64_t replay_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+    const std::lock_guard<std::mutex> lk(mu_);
+    statistics_.saved_us -= std::min(statistics_.saved_us, replay_us);
+    return SUCCESS;
+  }
+
+  // called once a dynamic node is inferred and its output sizes are calculated
+  void RecordNode(const NodeItem &node_item, const uint64_t infer_cost_us) {
+    const std::lock_guard<std::mutex> lk(mu_);
+    if (!recording_) {
+      return;
+    }
+    if (!recorded_nodes_.insert(&node_item).second) {
+      GELOGD("[%s] inferred more than once, shapes of subgraph are not recorded", node_item.NodeName().c_str());
+      recording_ = false;
+      ++statistics_.abandon_count;
+      return;
+    }
+    NodeShapes node_shapes;
+    node_shapes.node_item = &node_item;
+    SaveTensors(node_item, node_shapes.outputs);
+    pending_->nodes.emplace_back(std::move(node_shapes));
+    pending_->infer_cost_us += infer_cost_us;
+    statistics_.infer_cost_us += infer_cost_us;
+  }
+
+  // end of subgraph, saves the record if every dynamic node reported
+  void Commit() {
+    const std::lock_guard<std::mutex> lk(mu_);
+    if (!recording_) {
+      return;
+    }
+    recording_ = false;
+    if (recorded_nodes_.size() != dynamic_node_num_) {
+      GELOGD("Shapes of %zu/%zu dynamic nodes are recorded, record dropped", recorded_nodes_.size(),
+             dynamic_node_num_);
+      ++statistics_.abandon_count;
+      return;
+    }
+    size_t bytes = key_.size();
+    for (const auto &node_shapes : pending_->nodes) {
+      for (const auto &tensor : node_shapes.outputs) {
+        bytes += (tensor.dims.size() + tensor.origin_dims.size() + 1U) * sizeof(int64_t);
+      }
+    }
+    (void)records_.Insert(key_, std::shared_ptr<const Record>(std::move(pending_)), bytes);
+    recorded_nodes_.clear();
+  }
+
+  // drop the record in progress, e.g. on execution failure
+  void Abandon() {
+    const std::lock_guard<std::mutex> lk(mu_);
+    if (recording_) {
+      recording_ = false;
+      ++statistics_.abandon_count;
+    }
+  }
+
+  SubgraphShapeMemoStatistics GetStatistics() const {
+    const std::lock_guard<std::mutex> lk(mu_);
+    SubgraphShapeMemoStatistics statistics = statistics_;
+    statistics.evict_count = records_.GetStatistics().evict_count;
+    statistics.record_num = records_.GetStatistics().entry_num;
+    return statistics;
+  }
+
+ private:
+  struct TensorShape {
+    int index;
+    std::vector<int64_t> dims;
+    std::vector<int64_t> origin_dims;
+    int64_t tensor_size;
+  };
+
+  struct NodeShapes {
+    const NodeItem *node_item = nullptr;
+    std::vector<TensorShape> outputs;
+  };
+
+  // a replayed record is shared with ReplayRecord, an eviction meanwhile does not free it
+  struct Record {
+    std::vector<NodeShapes> nodes;
+    uint64_t infer_cost_us = 0UL;
+  };
+
+  static void SaveTensors(const NodeItem &node_item, std::vector<TensorShape> &tensors) {
+    tensors.reserve(static_cast<size_t>(node_item.num_outputs));
+    for (int i = 0; i < node_item.num_outputs; ++i) {
+      const GeTensorDescPtr tensor_desc = node_item.MutableOutputDesc(i);
+      if (tensor_desc == nullptr) {
+        continue;
+      }
+      TensorShape tensor;
+      tensor.index = i;
+      tensor.dims = tensor_desc->GetShape().GetDims();
+      tensor.origin_dims = tensor_desc->GetOriginShape().GetDims();
+      tensor.tensor_size = 0;
+      (void)TensorUtils::GetSize(*tensor_desc, tensor.tensor_size);
+      tensors.emplace_back(std::move(tensor));
+    }
+  }
+
+  static void ReplayTensors(const std::vector<TensorShape> &tensors, const NodeItem &node_item) {
+    for (const auto &tensor : tensors) {
+      if (tensor.index >= node_item.num_outputs) {
+        continue;
+      }
+      const GeTensorDescPtr tensor_desc = node_item.MutableOutputDesc(tensor.index);
+      if (tensor_desc == nullptr) {
+        continue;
+      }
+      tensor_desc->SetShape(GeShape(tensor.dims));
+      tensor_desc->SetOriginShape(GeShape(tensor.origin_dims));
+      TensorUtils::SetSize(*tensor_desc, tensor.tensor_size);
+    }
+  }
+
+  mutable std::mutex mu_;
+  ShapeKeyedCache<std::shared_ptr<const Record>> records_;
+  SubgraphShapeMemoStatistics statistics_;
+  size_t dynamic_node_num_ = 0U;
+  bool recording_ = false;
+  std::string key_;
+  std::unique_ptr<Record> pending_;
+  std::shared_ptr<const Record> replaying_;
+  std::unordered_set<const NodeItem *> recorded_nodes_;
+};
+}  // namespace hybrid
+}  // namespace ge
+#endif  // GE_HYBRID_EXECUTOR_WORKER_SUBGRAPH_SHAPE_MEMO_H_
@@ -0,0 +1,271 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_HYBRID_MODEL_FLAT_GRAPH_LAYOUT_H_
+#define GE_HYBRID_MODEL_FLAT_GRAPH_LAYOUT_H_
+
+#include <cstdint>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/util.h"
+#include "hybrid/model/node_item.h"
+#include "hybrid/model/schedule_graph.h"
+#include "mmpa/mmpa_api.h"
+
+namespace ge {
+namespace hybrid {
+constexpr uint32_t kFlatNodeDynamic = 1U;
+constexpr uint32_t kFlatNodeCtrlFlow = 1U << 1U;
+constexpr uint32_t kFlatNodeMerge = 1U << 2U;
+constexpr uint32_t kFlatNodeRoot = 1U << 3U;
+constexpr uint32_t kFlatNodeOutputShapeStatic = 1U << 4U;
+constexpr uint32_t kFlatNodeEnter = 1U << 5U;
+constexpr uint32_t kFlatNodeRecvRootData = 1U << 6U;   // root_data_ not empty, fed when the subgraph starts
+constexpr uint32_t kFlatNodeRecvEnterData = 1U << 7U;  // enter_data_ not empty, fed on each loop iteration
+
+// index based range of one CSR array
+struct FlatRange {
+  int32_t begin;
+  int32_t end;
+};
+
+struct FlatOutputEdge {
+  int32_t src_output;
+  int32_t dst_input;
+  int32_t dst_node;  // index in FlatGraphLayout, -1 if dst is not a node of this graph
+};
+
+// fixed size record of one node, 64 bytes so that one record is one cache line
+struct alignas(64) FlatNodeRecord {
+  int32_t group;
+  int32_t num_inputs;
+  int32_t num_outputs;
+  int32_t input_start;
+  int32_t output_start;
+  int32_t data_recv_num;   // size of data_recv_, Merge is ready on any of them
+  int32_t ctrl_recv_num;   // size of ctrl_recv_
+  uint32_t flags;
+  FlatRange data_send;     // in data_send_nodes
+  FlatRange ctrl_send;     // in ctrl_send_nodes
+  FlatRange output_edges;  // in output_edges, ordered by src output
+  int32_t shape_inference_type;
+};
+
+// std::allocator only guarantees alignof(std::max_align_t) before C++17, records need their own alignment
+template <typename T>
+struct FlatAlignedAllocator {
+  using value_type = T;
+
+  FlatAlignedAllocator() = default;
+  template <typename U>
+  explicit FlatAlignedAllocator(const FlatAlignedAllocator<U> &) {}
+
+  T *allocate(const size_t n) {
+    void *const ptr = mmAlignMalloc(static_cast<mmSize>(n * sizeof(T)), static_cast<mmSize>(alignof(T)));
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(ptr);
+  }
+
+  void deallocate(T *const ptr, const size_t) {
+    mmAlignFree(ptr);
+  }
+
+  template <typename U>
+  bool operator==(const FlatAlignedAllocator<U> &) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const FlatAlignedAllocator<U> &) const {
+    return false;
+  }
+};
+
+/**
+ * Immutable flat copy of the topology of a GraphItem, built once after the graph is loaded.
+ * Nodes are referenced by their index in GraphItem::GetAllNodes(), so the executor walks contiguous arrays
+ * instead of the sets and maps of NodeItem, which stay as they are for building and debugging.
+ * The recv counts and flags keep what NodeState needs for Merge, Enter and data fed from root or Enter nodes.
+ * The schedule graph counts one dependency per distinct sender, it only describes readiness of graphs without
+ * control flow, where every node waits for all of its senders.
+ */
+class FlatGraphLayout {
+ public:
+  Status Build(const std::vector<NodeItem *> &node_items) {
+    Clear();
+    std::unordered_map<const NodeItem *, int32_t> indices;
+    indices.reserve(node_items.size());
+    for (size_t i = 0U; i < node_items.size(); ++i) {
+      GE_CHECK_NOTNULL(node_items[i]);
+      indices[node_items[i]] = static_cast<int32_t>(i);
+    }
+    const auto get_index = [&indices](const NodeItem *const node_item) -> int32_t {
+      const auto it = indices.find(node_item);
+      return (it == indices.end()) ? -1 : it->second;
+    };
+
+    node_items_ = node_items;
+    records_.resize(node_items.size());
+    for (size_t i = 0U; i < node_items.size(); ++i) {
+      const NodeItem &node_item = *node_items[i];
+      FlatNodeRecord &record = records_[i];
+      record.group = node_item.group;
+      record.num_inputs = node_item.num_inputs;
+      record.num_outputs = node_item.num_outputs;
+      record.input_start = node_item.input_start;
+      record.output_start = node_item.output_start;
+      record.data_recv_num = static_cast<int32_t>(node_item.data_recv_.size());
+      record.ctrl_recv_num = static_cast<int32_t>(node_item.ctrl_recv_.size());
+      record.shape_inference_type = static_cast<int32_t>(node_item.shape_inference_type);
+      record.flags = (node_item.is_dynamic ? kFlatNodeDynamic : 0U) |
+                     (node_item.IsControlFlowOp() ? kFlatNodeCtrlFlow : 0U) |
+                     (node_item.IsMergeOp() ? kFlatNodeMerge : 0U) |
+                     (node_item.is_root_node_ ? kFlatNodeRoot : 0U) |
+                     (node_item.is_output_shape_static ? kFlatNodeOutputShapeStatic : 0U) |
+                     (node_item.IsEnterOp() ? kFlatNodeEnter : 0U) |
+                     (node_item.root_data_.empty() ? 0U : kFlatNodeRecvRootData) |
+                     (node_item.enter_data_.empty() ? 0U : kFlatNodeRecvEnterData);
+      record.data_send.begin = static_cast<int32_t>(data_send_nodes_.size());
+      AppendSendNodes(node_item.data_send_, get_index, data_send_nodes_);
+      record.data_send.end = static_cast<int32_t>(data_send_nodes_.size());
+      record.ctrl_send.begin = static_cast<int32_t>(ctrl_send_nodes_.size());
+      AppendSendNodes(node_item.ctrl_send_, get_index, ctrl_send_nodes_);
+      record.ctrl_send.end = static_cast<int32_t>(ctrl_send_nodes_.size());
+      record.output_edges.begin = static_cast<int32_t>(output_edges_.size());
+      for (size_t output_idx = 0U; output_idx < node_item.outputs.size(); ++output_idx) {
+        for (const auto &edge : node_item.outputs[output_idx]) {
+          output_edges_.emplace_back(FlatOutputEdge{static_cast<int32_t>(output_idx), edge.first,
+                                                    get_index(edge.second)});
+        }
+      }
+      record.output_edges.end = static_cast<int32_t>(output_edges_.size());
+    }
+    BuildSchedule();
+    GELOGD("Flat layout built, node num:%zu, data send:%zu, ctrl send:%zu, output edge:%zu, memory:%zu bytes",
+           records_.size(), data_send_nodes_.size(), ctrl_send_nodes_.size(), output_edges_.size(), MemorySize());
+    return SUCCESS;
+  }
+
+  void Clear() {
+    node_items_.clear();
+    records_.clear();
+    data_send_nodes_.clear();
+    ctrl_send_nodes_.clear();
+    output_edges_.clear();
+    schedule_ = ScheduleGraph();
+  }
+
+  size_t NodeNum() const {
+    return records_.size();
+  }
+
+  const FlatNodeRecord &GetRecord(const int32_t index) const {
+    return records_[static_cast<size_t>(index)];
+  }
+
+  const NodeItem *GetNodeItem(const int32_t index) const {
+    return node_items_[static_cast<size_t>(index)];
+  }
+
+  const int32_t *DataSendBegin(const FlatNodeRecord &record) const {
+    return data_send_nodes_.data() + record.data_send.begin;
+  }
+
+  const int32_t *DataSendEnd(const FlatNodeRecord &record) const {
+    return data_send_nodes_.data() + record.data_send.end;
+  }
+
+  const int32_t *CtrlSendBegin(const FlatNodeRecord &record) const {
+    return ctrl_send_nodes_.data() + record.ctrl_send.begin;
+  }
+
+  const int32_t *CtrlSendEnd(const FlatNodeRecord &record) const {
+    return ctrl_send_nodes_.data() + record.ctrl_send.end;
+  }
+
+  const FlatOutputEdge *OutputEdgeBegin(const FlatNodeRecord &record) const {
+    return output_edges_.data() + record.output_edges.begin;
+  }
+
+  const FlatOutputEdge *OutputEdgeEnd(const FlatNodeRecord &record) const {
+    return output_edges_.data() + record.output_edges.end;
+  }
+
+  /**
+   * Dependency graph of data and ctrl notify, successors of one node are deduplicated
+   */
+  const ScheduleGraph &GetScheduleGraph() const {
+    return schedule_;
+  }
+
+  size_t MemorySize() const {
+    return (records_.capacity() * sizeof(FlatNodeRecord)) + (node_items_.capacity() * sizeof(NodeItem *)) +
+           ((data_send_nodes_.capacity() + ctrl_send_nodes_.capacity()) * sizeof(int32_t)) +
+           (output_edges_.capacity() * sizeof(FlatOutputEdge)) +
+           ((schedule_.in_degrees.capacity() + schedule_.succ_offsets.capacity() + schedule_.succs.capacity()) *
+            sizeof(int32_t));
+  }
+
+ private:
+  template <typename GetIndex>
+  static void AppendSendNodes(const std::set<const NodeItem *> &send_nodes, const GetIndex &get_index,
+                              std::vector<int32_t> &flat_nodes) {
+    for (const auto send_node : send_nodes) {
+      const int32_t index = get_index(send_node);
+      if (index >= 0) {
+        flat_nodes.emplace_back(index);
+      }
+    }
+  }
+
+  void BuildSchedule() {
+    schedule_.in_degrees.assign(records_.size(), 0);
+    schedule_.succ_offsets.assign(records_.size() + 1U, 0);
+    std::vector<int32_t> last_pred(records_.size(), -1);
+    for (size_t i = 0U; i < records_.size(); ++i) {
+      const int32_t pred = static_cast<int32_t>(i);
+      const auto add_succ = [this, &last_pred, pred](const int32_t succ) {
+        if (last_pred[static_cast<size_t>(succ)] != pred) {
+          last_pred[static_cast<size_t>(succ)] = pred;
+          schedule_.succs.emplace_back(succ);
+          ++schedule_.in_degrees[static_cast<size_t>(succ)];
+        }
+      };
+      for (auto it = DataSendBegin(records_[i]); it != DataSendEnd(records_[i]); ++it) {
+        add_succ(*it);
+      }
+      for (auto it = CtrlSendBegin(records_[i]); it != CtrlSendEnd(records_[i]); ++it) {
+        add_succ(*it);
+      }
+      schedule_.succ_offsets[i + 1U] = static_cast<int32_t>(schedule_.succs.size());
+    }
+  }
+
+  std::vector<NodeItem *> node_items_;
+  std::vector<FlatNodeRecord, FlatAlignedAllocator<FlatNodeRecord>> records_;
+  std::vector<int32_t> data_send_nodes_;
+  std::vector<int32_t> ctrl_send_nodes_;
+  std::vector<FlatOutputEdge> output_edges_;
+  ScheduleGraph schedule_;
+};
+}  // namespace hybrid
+}  // namespace ge
+#endif  // GE_HYBRID_MODEL_FLAT_GRAPH_LAYOUT_H_
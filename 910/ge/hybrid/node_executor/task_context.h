@@ -25,13 +25,13 @@
 #include "framework/common/ge_types.h"
 #include "hybrid/common/tensor_value.h"
 #include "hybrid/common/npu_memory_allocator.h"
+#include "hybrid/executor/hybrid_execution_context.h"
 #include "hybrid/executor/node_state.h"
 #include "hybrid/executor/rt_callback_manager.h"
 #include "hybrid/model/node_item.h"
 
 namespace ge {
 namespace hybrid {
-struct GraphExecutionContext;
 class SubgraphContext;
 
 class TaskContext {
@@ -89,7 +89,17 @@ class TaskContext {
     return execution_context_;
   }
 
-  Status AllocateTensor(size_t size, TensorValue &tensor, AllocationAttr *attr = nullptr);
+  // carved from execution arena of the context if enabled, see GraphExecutionContext::EnableExecutionArena
+  Status AllocateTensor(size_t size, TensorValue &tensor, AllocationAttr *attr = nullptr) {
+    auto buffer = execution_context_->AllocateTensorBuffer(size, attr);
+    if (buffer == nullptr) {
+      REPORT_CALL_ERROR("E19999", "[Allocate][Tensor] failed, size = %zu", size);
+      GELOGE(MEMALLOC_FAILED, "[Allocate][Tensor] failed, size = %zu", size);
+      return MEMALLOC_FAILED;
+    }
+    tensor = TensorValue(std::shared_ptr<TensorBuffer>(buffer.release()));
+    return SUCCESS;
+  }
   void *MutableWorkspace(int index);
   const void *GetVarBaseAddr();
 
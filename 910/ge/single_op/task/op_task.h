@@ -17,14 +17,20 @@
 #ifndef GE_SINGLE_OP_TASK_OP_TASK_H_
 #define GE_SINGLE_OP_TASK_OP_TASK_H_
 
+#include <cstring>
 #include <memory>
+#include <new>
 #include <string>
 #include <external/graph/tensor.h>
 
 #include "common/dump/dump_op.h"
 #include "common/dump/dump_properties.h"
+#include "common/shape_keyed_cache.h"
+#include "framework/common/debug/log.h"
 #include "framework/common/ge_inner_error_codes.h"
 #include "graph/op_kernel_bin.h"
+#include "graph/debug/ge_attr_define.h"
+#include "graph/utils/attr_utils.h"
 #include "runtime/stream.h"
 #include "graph/node.h"
 #include "cce/aicpu_engine_struct.h"
@@ -39,6 +45,9 @@ const int kAddressNum = 2;
 
 class StreamResource;
 struct SingleOpModelParam;
+
+constexpr size_t kDefaultLaunchCacheCapacity = 64U;
+
 class OpTask {
  public:
   OpTask() = default;
@@ -82,7 +91,24 @@ class TbeOpTask : public OpTask {
                       const std::vector<DataBuffer> &input_buffers,
                       std::vector<GeTensorDesc> &output_desc,
                       std::vector<DataBuffer> &output_buffers,
-                      rtStream_t stream) override;
+                      rtStream_t stream) override {
+    GELOGD("[%s] Start to launch kernel", node_->GetName().c_str());
+    GE_CHK_STATUS_RET_NOLOG(UpdateNodeByShape(input_desc, output_desc));
+    BuildLaunchCacheKey(input_desc, output_desc);
+    bool cache_hit = false;
+    GE_CHK_STATUS_RET_NOLOG(UpdateRunInfoWithCache(cache_hit));
+    GE_CHK_STATUS_RET(UpdateIoAddr(input_buffers, output_buffers), "[Update][IoAddr] failed.");
+    GE_CHK_STATUS_RET(AllocateWorkspaces(run_info_workspaces_), "[Allocate][Workspaces] failed.");
+    GE_CHK_STATUS_RET(CheckAndExecuteAtomic(input_desc, input_buffers, output_desc, output_buffers, stream),
+                      "[Execute][AtomicTask] failed.");
+    GE_CHK_STATUS_RET(UpdateTilingArgs(stream), "[Update][TilingArgs] failed.");
+    if (!cache_hit) {
+      SaveLaunchState();
+    }
+    GELOGD("[%s] Start to invoke rtKernelLaunch", node_->GetName().c_str());
+    GE_CHK_STATUS_RET(DoLaunchKernel(stream), "Failed to do launch kernel.");
+    return SUCCESS;
+  }
   void GetIoAddr(uintptr_t *&arg_base, size_t &arg_count) override;
   void SetSmDesc(void *sm_desc);
   void SetStubFunc(const std::string &name, const void *stub_func);
@@ -101,7 +127,89 @@ class TbeOpTask : public OpTask {
   const std::string &GetTaskType() const override;
   void SetHandle(void *handle);
 
+  // cache launch state of up to capacity shape signatures, 0 disables it
+  void SetLaunchCacheCapacity(const size_t capacity) {
+    launch_cache_capacity_ = capacity;
+    launch_cache_.reset();
+  }
+
+  const ShapeKeyedCacheStatistics *GetLaunchCacheStatistics() const {
+    return (launch_cache_ == nullptr) ? nullptr : &launch_cache_->GetStatistics();
+  }
+
  protected:
+  // key of input and output shapes and of const values tiling reads from op desc, e.g. of host memory inputs.
+  // The cache of launch_cache_capacity_ is created on first use, the key is empty if the cache is off
+  void BuildLaunchCacheKey(const std::vector<GeTensorDesc> &input_desc, const std::vector<GeTensorDesc> &output_desc) {
+    launch_cache_key_.Clear();
+    if (launch_cache_capacity_ == 0U) {
+      return;
+    }
+    if (launch_cache_ == nullptr) {
+      launch_cache_.reset(new (std::nothrow) ShapeKeyedCache<TbeLaunchCacheEntry>(launch_cache_capacity_));
+      if (launch_cache_ == nullptr) {
+        return;
+      }
+    }
+    for (const auto &tensor_desc : input_desc) {
+      launch_cache_key_.AddTensor(tensor_desc);
+    }
+    for (const auto &tensor_desc : output_desc) {
+      launch_cache_key_.AddTensor(tensor_desc);
+    }
+    const size_t input_num = op_desc_->GetAllInputsSize();
+    for (size_t i = 0U; i < input_num; ++i) {
+      const GeTensorDescPtr tensor_desc = op_desc_->MutableInputDesc(static_cast<uint32_t>(i));
+      ConstGeTensorPtr value;
+      if ((tensor_desc != nullptr) && AttrUtils::GetTensor(tensor_desc, ATTR_NAME_VALUE, value) && (value != nullptr)) {
+        launch_cache_key_.AddValue(static_cast<int64_t>(i));
+        launch_cache_key_.AddBytes(value->GetData().GetData(), value->GetData().GetSize());
+      }
+    }
+  }
+
+  // on hit, tiling data, block dim, atomic clean decision, workspace sizes and args are those saved for the key
+  bool RestoreLaunchState() {
+    if ((launch_cache_ == nullptr) || launch_cache_key_.Key().empty()) {
+      return false;
+    }
+    const TbeLaunchCacheEntry *const entry = launch_cache_->Find(launch_cache_key_.Key());
+    if ((entry == nullptr) || (entry->args_image.size() != arg_size_)) {
+      return false;
+    }
+    tiling_data_ = entry->tiling_data;
+    block_dim_ = entry->block_dim;
+    tiling_key_ = entry->tiling_key;
+    clear_atomic_ = entry->clear_atomic;
+    run_info_workspaces_ = entry->workspace_sizes;
+    if (arg_size_ > 0U) {
+      (void)memcpy(args_.get(), entry->args_image.data(), arg_size_);
+    }
+    return true;
+  }
+
+  // UpdateRunInfo through the launch cache, a hit restores the saved state instead of tiling again
+  Status UpdateRunInfoWithCache(bool &cache_hit) {
+    cache_hit = RestoreLaunchState();
+    return cache_hit ? SUCCESS : UpdateRunInfo();
+  }
+
+  // called on a miss once io, workspace and tiling addresses are patched into args
+  void SaveLaunchState() {
+    if ((launch_cache_ == nullptr) || launch_cache_key_.Key().empty()) {
+      return;
+    }
+    TbeLaunchCacheEntry entry;
+    entry.tiling_data = tiling_data_;
+    entry.block_dim = block_dim_;
+    entry.tiling_key = tiling_key_;
+    entry.clear_atomic = clear_atomic_;
+    entry.workspace_sizes = run_info_workspaces_;
+    entry.args_image.assign(args_.get(), args_.get() + arg_size_);
+    const size_t bytes = entry.Bytes();
+    (void)launch_cache_->Insert(launch_cache_key_.Key(), std::move(entry), bytes);
+  }
+
   NodePtr node_;
   std::unique_ptr<uint8_t[]> args_;
   size_t arg_size_ = 0;
@@ -144,6 +252,9 @@ class TbeOpTask : public OpTask {
   std::vector<size_t> arg_index_; // data index in args
 
   std::unique_ptr<OpTask> atomic_task_;
+  size_t launch_cache_capacity_ = kDefaultLaunchCacheCapacity;
+  std::unique_ptr<ShapeKeyedCache<TbeLaunchCacheEntry>> launch_cache_;
+  ShapeSignature launch_cache_key_;
 };
 
 class AtomicAddrCleanOpTask : public TbeOpTask {
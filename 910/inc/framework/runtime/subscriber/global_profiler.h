@@ -18,41 +18,123 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include "mmpa/mmpa_api.h"
 #include "built_in_subscriber_definitions.h"
+#include "profiling_ring_buffer.h"
 #include "common/debug/ge_log.h"
 #include "framework/common/ge_visibility.h"
 #include "runtime/subscriber/executor_subscriber_c.h"
 
 namespace gert {
-struct ProfilingData {
-  uint64_t name_idx;
-  uint64_t type_idx;
-  ExecutorEvent event;
-  std::chrono::time_point<std::chrono::system_clock> timestamp;
-  int64_t thread_id;
+enum class ProfilingMode {
+  kFixed,       // records into a fixed array and stops when it is full
+  kContinuous   // records into per thread ring buffers, the oldest records are overwritten
 };
+
 class GlobalProfiler {
  public:
-  GlobalProfiler() = default;
-  void Record(uint64_t name_idx, uint64_t type_idx, ExecutorEvent event,
-                  std::chrono::time_point<std::chrono::system_clock> timestamp) {
+  explicit GlobalProfiler(const ProfilingMode mode = ProfilingMode::kFixed,
+                          const size_t ring_capacity = kProfilingRingCap)
+      : mode_(mode), generation_(NextGeneration()) {
+    if (mode_ == ProfilingMode::kContinuous) {
+      buffer_registry_ = std::make_shared<ProfilingBufferRegistry>(ring_capacity);
+    }
+  }
+  void Record(uint64_t name_idx, uint64_t type_idx, ExecutorEvent event, ProfilingTimePoint timestamp) {
+    thread_local static auto tid = static_cast<int64_t>(mmGetTid());
+    if (mode_ == ProfilingMode::kContinuous) {
+      ProfilingRingBuffer *const buffer = GetThreadBuffer();
+      if (buffer != nullptr) {
+        buffer->Push({name_idx, type_idx, event, timestamp, tid});
+      }
+      return;
+    }
     auto index = count_++;
     if (index >= kProfilingDataCap) {
       return;
     }
-    thread_local static auto tid = static_cast<int64_t>(mmGetTid());
     records_[index] = {name_idx, type_idx, event, timestamp, tid};
   }
+  void Record(uint64_t name_idx, uint64_t type_idx, ExecutorEvent event,
+              std::chrono::time_point<std::chrono::system_clock> timestamp) {
+    Record(name_idx, type_idx, event, ToProfilingTimePoint(timestamp));
+  }
   void Dump(std::ostream &out_stream, std::vector<std::string> &idx_to_str) const;
   size_t GetCount() const {
+    if (mode_ == ProfilingMode::kContinuous) {
+      return static_cast<size_t>(buffer_registry_->GetCount());
+    }
     return count_;
   }
+  ProfilingMode GetMode() const {
+    return mode_;
+  }
+
+  /**
+   * copy records without stopping the recording threads, in continuous mode only the records still in the
+   * ring buffers are returned
+   */
+  void Snapshot(std::vector<ProfilingData> &records) const {
+    if (mode_ == ProfilingMode::kContinuous) {
+      buffer_registry_->Snapshot(records);
+      return;
+    }
+    const size_t count = std::min(count_.load(), kProfilingDataCap);
+    records.insert(records.end(), &records_[0UL], &records_[0UL] + count);
+  }
+
+  void ExportChromeTrace(std::ostream &out_stream, const std::vector<std::string> &idx_to_str) const {
+    std::vector<ProfilingData> records;
+    Snapshot(records);
+    ChromeTraceExporter::Export(records, idx_to_str, out_stream);
+  }
 
  private:
+  static uint64_t NextGeneration() {
+    static std::atomic<uint64_t> generation{0UL};
+    return ++generation;
+  }
+
+  ProfilingRingBuffer *GetThreadBuffer() {
+    // ring of the calling thread, handed back to its registry when the thread exits
+    struct ThreadBuffer {
+      ~ThreadBuffer() {
+        Release();
+      }
+      void Release() {
+        const std::shared_ptr<ProfilingBufferRegistry> owner = registry.lock();
+        if ((owner != nullptr) && (buffer != nullptr)) {
+          owner->Retire(buffer);
+        }
+        registry.reset();
+        buffer = nullptr;
+        generation = 0UL;
+      }
+      uint64_t generation = 0UL;
+      std::weak_ptr<ProfilingBufferRegistry> registry;
+      ProfilingRingBuffer *buffer = nullptr;
+    };
+    thread_local static ThreadBuffer thread_buffer;
+    if (thread_buffer.generation == generation_) {
+      return thread_buffer.buffer;
+    }
+    thread_buffer.Release();
+    ProfilingRingBuffer *const buffer = buffer_registry_->Create();
+    if (buffer != nullptr) {
+      thread_buffer.generation = generation_;
+      thread_buffer.registry = buffer_registry_;
+      thread_buffer.buffer = buffer;
+    }
+    return buffer;
+  }
+
+  ProfilingMode mode_;
+  uint64_t generation_;
   std::atomic<size_t> count_{0UL};
   ProfilingData records_[kProfilingDataCap];
+  std::shared_ptr<ProfilingBufferRegistry> buffer_registry_;
 };
 
 class VISIBILITY_EXPORT GlobalProfilingWrapper {
@@ -71,6 +153,15 @@ class VISIBILITY_EXPORT GlobalProfilingWrapper {
 
   void Init(uint64_t enable_flags);
 
+  /**
+   * start profiling in continuous mode, records are kept in per thread ring buffers of ring_capacity records
+   * and can be exported at any time by ExportChromeTrace
+   */
+  void InitContinuous(const uint64_t enable_flags, const size_t ring_capacity = kProfilingRingCap) {
+    global_profiler_.reset(new (std::nothrow) GlobalProfiler(ProfilingMode::kContinuous, ring_capacity));
+    SetEnableFlags((global_profiler_ == nullptr) ? 0UL : enable_flags);
+  }
+
   void Free() {
     global_profiler_.reset(nullptr);
     SetEnableFlags(0UL);
@@ -104,8 +195,32 @@ class VISIBILITY_EXPORT GlobalProfilingWrapper {
     Free();
   }
   void Dump(std::ostream &out_stream) {
+    if (global_profiler_ == nullptr) {
+      return;
+    }
+    if (global_profiler_->GetMode() == ProfilingMode::kContinuous) {
+      GELOGW("Global profiler is streaming %zu records into ring buffers, use ExportChromeTrace to export them.",
+             global_profiler_->GetCount());
+      return;
+    }
+    global_profiler_->Dump(out_stream, idx_to_str_);
+  }
+  /**
+   * export records as Chrome trace json, can be called while executing
+   */
+  void ExportChromeTrace(std::ostream &out_stream) {
     if (global_profiler_ != nullptr) {
-      global_profiler_->Dump(out_stream, idx_to_str_);
+      std::vector<std::string> idx_to_str;
+      {
+        const std::lock_guard<std::mutex> lk(register_mutex_);
+        idx_to_str = idx_to_str_;
+      }
+      global_profiler_->ExportChromeTrace(out_stream, idx_to_str);
+    }
+  }
+  void Record(uint64_t name_idx, uint64_t type_idx, ExecutorEvent event, ProfilingTimePoint timestamp) {
+    if (global_profiler_ != nullptr) {
+      global_profiler_->Record(name_idx, type_idx, event, timestamp);
     }
   }
   void Record(uint64_t name_idx, uint64_t type_idx, ExecutorEvent event,
@@ -117,17 +232,23 @@ class VISIBILITY_EXPORT GlobalProfilingWrapper {
 
   uint64_t RegisterString(const std::string &name) {
     const std::lock_guard<std::mutex> lk(register_mutex_);
-    const auto iter = std::find(idx_to_str_.begin(), idx_to_str_.end(), name);
-    if (iter == idx_to_str_.end()) {
-      idx_to_str_[str_idx_] = name;
-      ++str_idx_;
-      if (str_idx_ >= idx_to_str_.size()) {
-        idx_to_str_.resize(idx_to_str_.size() * kDouble);
-      }
-      return str_idx_ - 1UL;
-    } else {
-      return iter - idx_to_str_.begin();
+    StringIndex &index = GetStringIndex();
+    // strings registered without RegisterString, e.g. the built-in ones, are indexed on first use
+    for (; index.indexed_idx < str_idx_; ++index.indexed_idx) {
+      (void)index.str_to_idx.emplace(idx_to_str_[index.indexed_idx], index.indexed_idx);
     }
+    const auto iter = index.str_to_idx.find(name);
+    if (iter != index.str_to_idx.end()) {
+      return iter->second;
+    }
+    idx_to_str_[str_idx_] = name;
+    (void)index.str_to_idx.emplace(name, str_idx_);
+    ++str_idx_;
+    index.indexed_idx = str_idx_;
+    if (str_idx_ >= idx_to_str_.size()) {
+      idx_to_str_.resize(idx_to_str_.size() * kDouble);
+    }
+    return str_idx_ - 1UL;
   }
 
   static uint64_t RegisterStringHash(const std::string &str);
@@ -139,6 +260,17 @@ class VISIBILITY_EXPORT GlobalProfilingWrapper {
  private:
   GlobalProfilingWrapper();
 
+  struct StringIndex {
+    std::unordered_map<std::string, uint64_t> str_to_idx;
+    uint64_t indexed_idx{0UL};  // idx_to_str_ before it are in str_to_idx
+  };
+
+  // the wrapper is a singleton, the index is kept out of it so that the layout of the exported class is unchanged
+  static StringIndex &GetStringIndex() {
+    static StringIndex index;
+    return index;
+  }
+
  private:
   std::unique_ptr<GlobalProfiler> global_profiler_{nullptr};
   uint64_t enable_flags_{0UL};
@@ -151,7 +283,7 @@ class ScopeProfiler {
  public:
   ScopeProfiler(const size_t element, const size_t event) : element_(element), event_(event) {
     if (GlobalProfilingWrapper::GetInstance()->IsEnable(ProfilingType::kGeHost)) {
-      start_trace_ = std::chrono::system_clock::now();
+      start_trace_ = ProfilingClock::now();
     }
   }
 
@@ -162,21 +294,21 @@ class ScopeProfiler {
   ~ScopeProfiler() {
     if (GlobalProfilingWrapper::GetInstance()->IsEnable(ProfilingType::kGeHost)) {
       GlobalProfilingWrapper::GetInstance()->Record(element_, event_, kExecuteStart, start_trace_);
-      GlobalProfilingWrapper::GetInstance()->Record(element_, event_, kExecuteEnd, std::chrono::system_clock::now());
+      GlobalProfilingWrapper::GetInstance()->Record(element_, event_, kExecuteEnd, ProfilingClock::now());
     }
   }
 
  private:
-  std::chrono::time_point<std::chrono::system_clock> start_trace_;
+  ProfilingTimePoint start_trace_;
   size_t element_;
   size_t event_;
 };
 }  // namespace gert
 
 #define GE_PROFILING_START(event)                                                            \
-  std::chrono::time_point<std::chrono::system_clock> event##start_time;                      \
+  gert::ProfilingTimePoint event##start_time;                                                \
   if (gert::GlobalProfilingWrapper::GetInstance()->IsEnable(gert::ProfilingType::kGeHost)) { \
-    event##start_time = std::chrono::system_clock::now();                                    \
+    event##start_time = gert::ProfilingClock::now();                                         \
   }
 
 #define GE_PROFILING_END(name_idx, type_idx, event)                                                         \
@@ -185,7 +317,7 @@ class ScopeProfiler {
       gert::GlobalProfilingWrapper::GetInstance()->Record(name_idx, type_idx, ExecutorEvent::kExecuteStart, \
                                                           event##start_time);                               \
       gert::GlobalProfilingWrapper::GetInstance()->Record(name_idx, type_idx, ExecutorEvent::kExecuteEnd,   \
-                                                          std::chrono::system_clock::now());                \
+                                                          gert::ProfilingClock::now());                     \
     }                                                                                                       \
   } while (false)
 
@@ -21,6 +21,7 @@
 #include <functional>
 #include <vector>
 
+#include "common/broadcast_engine.h"
 #include "common/debug/log.h"
 #include "common/types.h"
 #include "framework/common/debug/ge_log.h"
@@ -68,48 +69,33 @@ class BCast {
   template <typename InT, typename OutT>
   Status BCastCompute(const std::vector<ConstGeTensorPtr> &input, std::vector<OutT> &v_output,
                       const std::function<OutT(InT const &, InT const &)> &func) {
-    Status ret;
     if (func == nullptr) {
       REPORT_INNER_ERROR("E19999", "Check param func nullptr");
       GELOGE(domi::PARAM_INVALID, "Param func is null");
       return domi::PARAM_INVALID;
     }
-    // Min input num is 2
-    const size_t kMinDimNum = 2U;
-    if (input.size() < kMinDimNum) {
-      REPORT_INNER_ERROR("E19999", "Param input.size():%zu < %zu, check invalid",
-                         input.size(), kMinDimNum);
-      GELOGE(domi::PARAM_INVALID, "Input size is smaller than two.");
-      return domi::PARAM_INVALID;
-    }
-    // Only broadcast shape
-    ret =
-      GenerateBcastInfo(TransShapeToDimVec(input[0U]->GetTensorDesc()),
-                        TransShapeToDimVec(input[1U]->GetTensorDesc()));
-    if (ret != domi::SUCCESS) {
-      GELOGE(ret, "Greater broadcasting failed.");
-      return ret;
-    }
-
-    kVecInt x_indexes;
-    kVecInt y_indexes;
-    BCastIndexes(x_indexes, y_indexes);
-
-    const void *const x1_data = input[0U]->GetData().data();
-    const void *const x2_data = input[1U]->GetData().data();
-    const size_t x1_size = input[0U]->GetData().size();
-    const size_t x2_size = input[1U]->GetData().size();
+    return BCastComputeTyped<InT, OutT>(input, v_output, func);
+  }
 
-    for (size_t i = 0U; i < x_indexes.size(); i++) {
-      const int64_t x_index = x_indexes[i];
-      const int64_t y_index = y_indexes[i];
-      const InT *const ptr_x1 = reinterpret_cast<const InT *>(x1_data);
-      const InT *const ptr_x2 = reinterpret_cast<const InT *>(x2_data);
-      const auto value = func(*(PtrAdd<const InT>(ptr_x1, x1_size, x_index)),
-                              *(PtrAdd<const InT>(ptr_x2, x2_size, y_index)));
-      v_output.push_back(value);
+  /// @ingroup domi_calibration
+  /// @brief broadcast compute with a typed operator, op is called directly in the block loops of
+  ///        BroadcastEngine and can be inlined, output is resized once before computing
+  /// @param [in] input   two input tensors
+  /// @param [out] v_output   results are appended
+  /// @param [in] op   callable of OutT(const InT &, const InT &)
+  /// @return     SUCCESS broadcast compute successfully
+  template <typename InT, typename OutT, typename Op>
+  Status BCastComputeTyped(const std::vector<ConstGeTensorPtr> &input, std::vector<OutT> &v_output, Op op) {
+    BroadcastEngine engine;
+    const Status ret = PrepareBroadcast<InT>(input, engine);
+    if (ret != SUCCESS) {
+      return ret;
     }
-
+    const size_t offset = v_output.size();
+    v_output.resize(offset + static_cast<size_t>(engine.GetOutputSize()));
+    engine.Compute(reinterpret_cast<const InT *>(input[0U]->GetData().data()),
+                   reinterpret_cast<const InT *>(input[1U]->GetData().data()),
+                   v_output.begin() + static_cast<std::ptrdiff_t>(offset), op);
     return domi::SUCCESS;
   }
 
@@ -121,53 +107,73 @@ class BCast {
       GELOGE(PARAM_INVALID, "Param func is null");
       return PARAM_INVALID;
     }
+    BroadcastEngine engine;
+    const Status prepare_ret = PrepareBroadcast<InT>(input, engine);
+    if (prepare_ret != SUCCESS) {
+      return prepare_ret;
+    }
+    DataType data_type = input[0U]->GetTensorDesc().GetDataType();
+    const auto op = [&func, &data_type](InT const &x, InT const &y, Status &status) -> OutT {
+      return func(x, y, data_type, status);
+    };
+    const size_t offset = v_output.size();
+    v_output.resize(offset + static_cast<size_t>(engine.GetOutputSize()));
+    // computing stops at the first element func fails on
+    const Status ret = engine.ComputeChecked(reinterpret_cast<const InT *>(input[0U]->GetData().data()),
+                                             reinterpret_cast<const InT *>(input[1U]->GetData().data()),
+                                             v_output.begin() + static_cast<std::ptrdiff_t>(offset), op);
+    if (ret != SUCCESS) {
+      // drop the outputs of this call, v_output keeps only what it held before
+      v_output.resize(offset);
+      REPORT_INNER_ERROR("E19999", "BCastComputeCheck func execute failed, datatype is %d.", data_type);
+      GELOGE(ret, "BCastComputeCheck func execute failed, datatype is %d.", data_type);
+      return ret;
+    }
+    return SUCCESS;
+  }
+
+ private:
+  /// @ingroup domi_calibration
+  /// @brief generate broadcast info and init engine, check data size of inputs
+  /// @param [in] input   two input tensors
+  /// @param [out] engine   broadcast engine of the input shapes
+  /// @return     SUCCESS inputs can be broadcast
+  template <typename InT>
+  Status PrepareBroadcast(const std::vector<ConstGeTensorPtr> &input, BroadcastEngine &engine) {
     // Min input num is 2
     const size_t kMinDimNum = 2U;
     if (input.size() < kMinDimNum) {
       REPORT_INNER_ERROR("E19999", "Param input.size():%zu < %zu, check invalid",
                          input.size(), kMinDimNum);
-      GELOGE(PARAM_INVALID, "Input size is smaller than two.");
-      return PARAM_INVALID;
+      GELOGE(domi::PARAM_INVALID, "Input size is smaller than two.");
+      return domi::PARAM_INVALID;
     }
+    const kVecInt x_dims = TransShapeToDimVec(input[0U]->GetTensorDesc());
+    const kVecInt y_dims = TransShapeToDimVec(input[1U]->GetTensorDesc());
     // Only broadcast shape
-    Status ret =
-      GenerateBcastInfo(TransShapeToDimVec(input[0U]->GetTensorDesc()),
-                        TransShapeToDimVec(input[1U]->GetTensorDesc()));
+    Status ret = GenerateBcastInfo(x_dims, y_dims);
+    if (ret != domi::SUCCESS) {
+      GELOGE(ret, "[Generate][BcastInfo] failed, x dim num:%zu, y dim num:%zu.", x_dims.size(), y_dims.size());
+      return ret;
+    }
+    ret = engine.Init(x_dims, y_dims);
     if (ret != SUCCESS) {
-      GELOGE(ret, "Greater broadcasting failed.");
+      GELOGE(ret, "Init broadcast engine failed.");
       return ret;
     }
-
-    DataType data_type = input[0U]->GetTensorDesc().GetDataType();
-    kVecInt x_indexes;
-    kVecInt y_indexes;
-    BCastIndexes(x_indexes, y_indexes);
-
-    const void *const x1_data = input[0U]->GetData().data();
-    const void *const x2_data = input[1U]->GetData().data();
     const size_t x1_size = input[0U]->GetData().size();
     const size_t x2_size = input[1U]->GetData().size();
-
-    for (size_t i = 0U; i < x_indexes.size(); i++) {
-      const int64_t x_index = x_indexes[i];
-      const int64_t y_index = y_indexes[i];
-      const InT *const ptr_x1 = reinterpret_cast<const InT *>(x1_data);
-      const InT *const ptr_x2 = reinterpret_cast<const InT *>(x2_data);
-      const auto value = func(*(PtrAdd<const InT>(ptr_x1, x1_size, x_index)),
-                              *(PtrAdd<const InT>(ptr_x2, x2_size, y_index)), data_type, ret);
-      
-      if (ret != SUCCESS) {
-        REPORT_INNER_ERROR("E19999", "BCastComputeCheck func execute failed, datatype is %d.", data_type);
-        GELOGE(ret, "BCastComputeCheck func execute failed, datatype is %d.", data_type);
-        return ret;
-      }
-      v_output.push_back(value);
+    if ((x1_size < (static_cast<size_t>(engine.GetXSize()) * sizeof(InT))) ||
+        (x2_size < (static_cast<size_t>(engine.GetYSize()) * sizeof(InT)))) {
+      REPORT_INNER_ERROR("E19999", "Input data size [%zu, %zu] is smaller than shape size [%ld, %ld].",
+                         x1_size, x2_size, engine.GetXSize(), engine.GetYSize());
+      GELOGE(domi::PARAM_INVALID, "Input data size [%zu, %zu] is smaller than shape size [%ld, %ld].",
+             x1_size, x2_size, engine.GetXSize(), engine.GetYSize());
+      return domi::PARAM_INVALID;
     }
-
     return SUCCESS;
   }
 
- private:
   /// @ingroup domi_calibration
   /// @brief reverse elements in kVecInt
   /// @param [in] shape   dim info
@@ -0,0 +1,447 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_FP16_BATCH_CONVERT_H_
+#define GE_COMMON_FP16_BATCH_CONVERT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GE_BATCH_CONVERT_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define GE_BATCH_CONVERT_NEON
+#endif
+
+namespace ge {
+/// @ingroup fp16 batch conversion
+/// @brief   instruction set used by batch conversion, selected once by cpu features at runtime.
+///          SSE has no half precision conversion instruction, cpus without F16C use the scalar path.
+enum class BatchConvertIsa {
+  kScalar = 0,
+  kAvx2F16c,
+  kAvx512,
+  kNeon,
+};
+
+namespace batch_convert {
+constexpr uint32_t kFp16SatMax = 0x7BFFU;        // fp16_t result of fp32 exponent above 0x8F, inf and nan
+constexpr uint32_t kFp16AbsMax = 0x7FFFU;        // fp16_t result of values rounded to fp16 exponent 0x1F
+constexpr uint32_t kFp32ExpOfFp16MaxExp = 0x8FU; // fp16 exponent 0x1F rebased to fp32 exponent, 31 - 15 + 127
+constexpr uint32_t kFp32AbsBitsOfSatMax = (kFp32ExpOfFp16MaxExp + 1U) << 23U; // smallest abs bits saturated
+
+inline uint32_t FloatBits(const float value) {
+  uint32_t bits;
+  (void)std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline float BitsFloat(const uint32_t bits) {
+  float value;
+  (void)std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// round to nearest even on the low shift bits
+inline bool IsRoundUp(const uint64_t man, const uint32_t shift) {
+  const uint64_t half = 1ULL << (shift - 1U);
+  const uint64_t rest = man & ((1ULL << shift) - 1ULL);
+  return (rest > half) || ((rest == half) && (((man >> shift) & 1ULL) != 0ULL));
+}
+
+/// @brief   fp32 to fp16 with the same result as fp16_t::operator=(float32_t)
+inline uint16_t Fp32ToFp16(const float value) {
+  const uint32_t bits = FloatBits(value);
+  const uint16_t sign = static_cast<uint16_t>((bits >> 16U) & 0x8000U);
+  const uint32_t exp = (bits >> 23U) & 0xFFU;
+  const uint32_t man = bits & 0x7FFFFFU;
+  if (exp > kFp32ExpOfFp16MaxExp) {
+    return static_cast<uint16_t>(sign | kFp16SatMax);
+  }
+  if (exp <= 0x70U) {  // 127 - 15, denormal or zero in fp16
+    if (exp >= 0x67U) {  // 127 - 24
+      const uint64_t shifted = static_cast<uint64_t>(man | 0x800000U) << (exp - 0x67U);
+      uint32_t ret = static_cast<uint32_t>(shifted >> 23U);
+      if (IsRoundUp(shifted, 23U)) {
+        ++ret;  // 0x400 carries into the smallest normal value
+      }
+      return static_cast<uint16_t>(sign | ret);
+    }
+    return ((exp == 0x66U) && (man > 0U)) ? static_cast<uint16_t>(sign | 1U) : sign;
+  }
+  uint32_t ret_exp = exp - 0x70U;
+  uint32_t ret_man = man >> 13U;
+  if (IsRoundUp(man, 13U)) {
+    ++ret_man;
+  }
+  if ((ret_man & 0x400U) != 0U) {
+    ++ret_exp;
+    ret_man = 0U;
+  }
+  if (ret_exp >= 0x1FU) {  // fp16_t normalizes exponent 0x1F to max exponent and mantissa
+    return static_cast<uint16_t>(sign | kFp16AbsMax);
+  }
+  return static_cast<uint16_t>(sign | (ret_exp << 10U) | ret_man);
+}
+
+/// @brief   fp16 to fp32 with the same result as fp16_t::ToFloat, exponent 0x1F is decoded as a normal exponent
+inline float Fp16ToFp32(const uint16_t value) {
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000U) << 16U;
+  int32_t exp = static_cast<int32_t>((value >> 10U) & 0x1FU);
+  uint32_t man = value & 0x3FFU;
+  if (exp == 0) {
+    if (man == 0U) {
+      return BitsFloat(sign);
+    }
+    exp = 1;
+    while ((man & 0x400U) == 0U) {
+      man <<= 1U;
+      --exp;
+    }
+    man &= 0x3FFU;
+  }
+  return BitsFloat(sign | (static_cast<uint32_t>(exp + 112) << 23U) | (man << 13U));  // 112 = 127 - 15
+}
+
+/// @brief   fp32 to bf16, round to nearest even, nan keeps sign and becomes quiet nan
+inline uint16_t Fp32ToBf16(const float value) {
+  const uint32_t bits = FloatBits(value);
+  if ((bits & 0x7FFFFFFFU) > 0x7F800000U) {
+    return static_cast<uint16_t>((bits >> 16U) | 0x40U);
+  }
+  return static_cast<uint16_t>((bits + 0x7FFFU + ((bits >> 16U) & 1U)) >> 16U);
+}
+
+inline float Bf16ToFp32(const uint16_t value) {
+  return BitsFloat(static_cast<uint32_t>(value) << 16U);
+}
+
+inline void Fp32ToFp16Scalar(const float *const src, uint16_t *const dst, const size_t num) {
+  for (size_t i = 0U; i < num; ++i) {
+    dst[i] = Fp32ToFp16(src[i]);
+  }
+}
+
+inline void Fp16ToFp32Scalar(const uint16_t *const src, float *const dst, const size_t num) {
+  for (size_t i = 0U; i < num; ++i) {
+    dst[i] = Fp16ToFp32(src[i]);
+  }
+}
+
+inline void Fp32ToBf16Scalar(const float *const src, uint16_t *const dst, const size_t num) {
+  for (size_t i = 0U; i < num; ++i) {
+    dst[i] = Fp32ToBf16(src[i]);
+  }
+}
+
+inline void Bf16ToFp32Scalar(const uint16_t *const src, float *const dst, const size_t num) {
+  for (size_t i = 0U; i < num; ++i) {
+    dst[i] = Bf16ToFp32(src[i]);
+  }
+}
+
+inline void Int8ToFp32Scalar(const int8_t *const src, float *const dst, const size_t num) {
+  for (size_t i = 0U; i < num; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+// int8 values are exact in fp16, no rounding needed
+inline void Int8ToFp16Scalar(const int8_t *const src, uint16_t *const dst, const size_t num) {
+  for (size_t i = 0U; i < num; ++i) {
+    dst[i] = Fp32ToFp16(static_cast<float>(src[i]));
+  }
+}
+
+#ifdef GE_BATCH_CONVERT_X86
+// lanes converted to inf or nan are replaced as fp16_t does: signed 0x7FFF if the fp32 exponent is at most 0x8F,
+// otherwise signed 0x7BFF. large is all ones in lanes whose fp32 abs bits are kFp32AbsBitsOfSatMax or more.
+__attribute__((target("avx2,f16c"))) inline __m128i SaturateFp16Avx2(const __m128i half, const __m128i large) {
+  const __m128i abs = _mm_and_si128(half, _mm_set1_epi16(0x7FFF));
+  const __m128i overflow = _mm_cmpgt_epi16(abs, _mm_set1_epi16(static_cast<int16_t>(kFp16SatMax)));
+  const __m128i max_value = _mm_andnot_si128(_mm_and_si128(large, _mm_set1_epi16(0x0400)),
+                                             _mm_set1_epi16(static_cast<int16_t>(kFp16AbsMax)));
+  const __m128i saturated =
+      _mm_or_si128(_mm_and_si128(half, _mm_set1_epi16(static_cast<int16_t>(0x8000))), max_value);
+  return _mm_blendv_epi8(half, saturated, overflow);
+}
+
+__attribute__((target("avx2,f16c"))) inline __m256i IsFp16SatMaxAvx2(const __m256 value) {
+  const __m256i abs_bits = _mm256_and_si256(_mm256_castps_si256(value), _mm256_set1_epi32(0x7FFFFFFF));
+  return _mm256_cmpgt_epi32(abs_bits, _mm256_set1_epi32(static_cast<int32_t>(kFp32AbsBitsOfSatMax - 1U)));
+}
+
+__attribute__((target("avx2,f16c"))) inline __m256 Fp16ToFp32Avx2Block(const __m128i half) {
+  const __m256 converted = _mm256_cvtph_ps(half);
+  const __m256i wide = _mm256_cvtepu16_epi32(half);
+  const __m256i exp = _mm256_and_si256(_mm256_srli_epi32(wide, 10), _mm256_set1_epi32(0x1F));
+  const __m256i is_max_exp = _mm256_cmpeq_epi32(exp, _mm256_set1_epi32(0x1F));
+  const __m256i fixed = _mm256_or_si256(
+      _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(wide, _mm256_set1_epi32(0x8000)), 16),
+                      _mm256_set1_epi32(static_cast<int32_t>(kFp32ExpOfFp16MaxExp << 23U))),
+      _mm256_slli_epi32(_mm256_and_si256(wide, _mm256_set1_epi32(0x3FF)), 13));
+  return _mm256_blendv_ps(converted, _mm256_castsi256_ps(fixed), _mm256_castsi256_ps(is_max_exp));
+}
+
+__attribute__((target("avx2,f16c"))) inline void Fp32ToFp16Avx2(const float *const src, uint16_t *const dst,
+                                                               const size_t num) {
+  size_t i = 0U;
+  for (; (i + 8U) <= num; i += 8U) {
+    const __m256 value = _mm256_loadu_ps(src + i);
+    const __m128i half = _mm256_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __m256i large = IsFp16SatMaxAvx2(value);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     SaturateFp16Avx2(half, _mm_packs_epi32(_mm256_castsi256_si128(large),
+                                                            _mm256_extracti128_si256(large, 1))));
+  }
+  Fp32ToFp16Scalar(src + i, dst + i, num - i);
+}
+
+__attribute__((target("avx2,f16c"))) inline void Fp16ToFp32Avx2(const uint16_t *const src, float *const dst,
+                                                               const size_t num) {
+  size_t i = 0U;
+  for (; (i + 8U) <= num; i += 8U) {
+    _mm256_storeu_ps(dst + i, Fp16ToFp32Avx2Block(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))));
+  }
+  Fp16ToFp32Scalar(src + i, dst + i, num - i);
+}
+
+__attribute__((target("avx2"))) inline void Fp32ToBf16Avx2(const float *const src, uint16_t *const dst,
+                                                          const size_t num) {
+  size_t i = 0U;
+  const __m256i rounding_bias = _mm256_set1_epi32(0x7FFF);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i abs_mask = _mm256_set1_epi32(0x7FFFFFFF);
+  const __m256i inf = _mm256_set1_epi32(0x7F800000);
+  const __m256i quiet_bit = _mm256_set1_epi32(0x40);
+  for (; (i + 16U) <= num; i += 16U) {
+    __m256i rounded[2];
+    for (size_t j = 0U; j < 2U; ++j) {
+      const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + (j * 8U)));
+      const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), one);
+      const __m256i round = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(bits, rounding_bias), lsb), 16);
+      const __m256i nan = _mm256_or_si256(_mm256_srli_epi32(bits, 16), quiet_bit);
+      const __m256i is_nan = _mm256_cmpgt_epi32(_mm256_and_si256(bits, abs_mask), inf);
+      rounded[j] = _mm256_blendv_epi8(round, nan, is_nan);
+    }
+    // packus works in 128 bit lanes, reorder 64 bit blocks back to element order
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(rounded[0], rounded[1]), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), packed);
+  }
+  Fp32ToBf16Scalar(src + i, dst + i, num - i);
+}
+
+__attribute__((target("avx2"))) inline void Bf16ToFp32Avx2(const uint16_t *const src, float *const dst,
+                                                          const size_t num) {
+  size_t i = 0U;
+  for (; (i + 8U) <= num; i += 8U) {
+    const __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16)));
+  }
+  Bf16ToFp32Scalar(src + i, dst + i, num - i);
+}
+
+__attribute__((target("avx2"))) inline void Int8ToFp32Avx2(const int8_t *const src, float *const dst,
+                                                          const size_t num) {
+  size_t i = 0U;
+  for (; (i + 8U) <= num; i += 8U) {
+    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes)));
+  }
+  Int8ToFp32Scalar(src + i, dst + i, num - i);
+}
+
+__attribute__((target("avx2,f16c"))) inline void Int8ToFp16Avx2(const int8_t *const src, uint16_t *const dst,
+                                                               const size_t num) {
+  size_t i = 0U;
+  for (; (i + 8U) <= num; i += 8U) {
+    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+    const __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Int8ToFp16Scalar(src + i, dst + i, num - i);
+}
+
+__attribute__((target("avx512f,avx2,f16c"))) inline void Fp32ToFp16Avx512(const float *const src,
+                                                                         uint16_t *const dst, const size_t num) {
+  size_t i = 0U;
+  for (; (i + 16U) <= num; i += 16U) {
+    const __m512 value = _mm512_loadu_ps(src + i);
+    const __m256i half = _mm512_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __mmask16 is_large = _mm512_cmpge_epu32_mask(
+        _mm512_and_si512(_mm512_castps_si512(value), _mm512_set1_epi32(0x7FFFFFFF)),
+        _mm512_set1_epi32(static_cast<int32_t>(kFp32AbsBitsOfSatMax)));
+    const __m256i large = _mm512_cvtepi32_epi16(_mm512_maskz_set1_epi32(is_large, -1));
+    const __m256i abs = _mm256_and_si256(half, _mm256_set1_epi16(0x7FFF));
+    const __m256i overflow = _mm256_cmpgt_epi16(abs, _mm256_set1_epi16(static_cast<int16_t>(kFp16SatMax)));
+    const __m256i max_value = _mm256_andnot_si256(_mm256_and_si256(large, _mm256_set1_epi16(0x0400)),
+                                                  _mm256_set1_epi16(static_cast<int16_t>(kFp16AbsMax)));
+    const __m256i saturated =
+        _mm256_or_si256(_mm256_and_si256(half, _mm256_set1_epi16(static_cast<int16_t>(0x8000))), max_value);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_blendv_epi8(half, saturated, overflow));
+  }
+  Fp32ToFp16Avx2(src + i, dst + i, num - i);
+}
+
+__attribute__((target("avx512f,avx2,f16c"))) inline void Fp16ToFp32Avx512(const uint16_t *const src,
+                                                                         float *const dst, const size_t num) {
+  size_t i = 0U;
+  for (; (i + 16U) <= num; i += 16U) {
+    const __m256i half = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m512 converted = _mm512_cvtph_ps(half);
+    const __m512i wide = _mm512_cvtepu16_epi32(half);
+    const __m512i exp = _mm512_and_si512(_mm512_srli_epi32(wide, 10), _mm512_set1_epi32(0x1F));
+    const __mmask16 is_max_exp = _mm512_cmpeq_epi32_mask(exp, _mm512_set1_epi32(0x1F));
+    const __m512i fixed = _mm512_or_si512(
+        _mm512_or_si512(_mm512_slli_epi32(_mm512_and_si512(wide, _mm512_set1_epi32(0x8000)), 16),
+                        _mm512_set1_epi32(static_cast<int32_t>(kFp32ExpOfFp16MaxExp << 23U))),
+        _mm512_slli_epi32(_mm512_and_si512(wide, _mm512_set1_epi32(0x3FF)), 13));
+    _mm512_storeu_ps(dst + i, _mm512_mask_blend_ps(is_max_exp, converted, _mm512_castsi512_ps(fixed)));
+  }
+  Fp16ToFp32Avx2(src + i, dst + i, num - i);
+}
+#endif  // GE_BATCH_CONVERT_X86
+
+#ifdef GE_BATCH_CONVERT_NEON
+inline void Fp32ToFp16Neon(const float *const src, uint16_t *const dst, const size_t num) {
+  size_t i = 0U;
+  const uint16x4_t abs_mask = vdup_n_u16(0x7FFFU);
+  const uint16x4_t sign_mask = vdup_n_u16(0x8000U);
+  const uint16x4_t sat_max = vdup_n_u16(static_cast<uint16_t>(kFp16SatMax));
+  const uint16x4_t abs_max = vdup_n_u16(static_cast<uint16_t>(kFp16AbsMax));
+  for (; (i + 4U) <= num; i += 4U) {
+    const float32x4_t value = vld1q_f32(src + i);
+    const uint16x4_t half = vreinterpret_u16_f16(vcvt_f16_f32(value));
+    const uint16x4_t large = vmovn_u32(vcgeq_u32(vandq_u32(vreinterpretq_u32_f32(value), vdupq_n_u32(0x7FFFFFFFU)),
+                                                 vdupq_n_u32(kFp32AbsBitsOfSatMax)));
+    const uint16x4_t overflow = vcgt_u16(vand_u16(half, abs_mask), sat_max);
+    const uint16x4_t saturated = vorr_u16(vand_u16(half, sign_mask), vbsl_u16(large, sat_max, abs_max));
+    vst1_u16(dst + i, vbsl_u16(overflow, saturated, half));
+  }
+  Fp32ToFp16Scalar(src + i, dst + i, num - i);
+}
+
+inline void Fp16ToFp32Neon(const uint16_t *const src, float *const dst, const size_t num) {
+  size_t i = 0U;
+  for (; (i + 4U) <= num; i += 4U) {
+    const uint16x4_t half = vld1_u16(src + i);
+    const float32x4_t converted = vcvt_f32_f16(vreinterpret_f16_u16(half));
+    const uint32x4_t wide = vmovl_u16(half);
+    const uint32x4_t is_max_exp = vceqq_u32(vandq_u32(vshrq_n_u32(wide, 10), vdupq_n_u32(0x1FU)), vdupq_n_u32(0x1FU));
+    const uint32x4_t fixed = vorrq_u32(vorrq_u32(vshlq_n_u32(vandq_u32(wide, vdupq_n_u32(0x8000U)), 16),
+                                                 vdupq_n_u32(kFp32ExpOfFp16MaxExp << 23U)),
+                                       vshlq_n_u32(vandq_u32(wide, vdupq_n_u32(0x3FFU)), 13));
+    vst1q_f32(dst + i, vbslq_f32(is_max_exp, vreinterpretq_f32_u32(fixed), converted));
+  }
+  Fp16ToFp32Scalar(src + i, dst + i, num - i);
+}
+
+inline void Bf16ToFp32Neon(const uint16_t *const src, float *const dst, const size_t num) {
+  size_t i = 0U;
+  for (; (i + 4U) <= num; i += 4U) {
+    vst1q_f32(dst + i, vreinterpretq_f32_u32(vshlq_n_u32(vmovl_u16(vld1_u16(src + i)), 16)));
+  }
+  Bf16ToFp32Scalar(src + i, dst + i, num - i);
+}
+#endif  // GE_BATCH_CONVERT_NEON
+
+struct BatchConvertFuncs {
+  BatchConvertIsa isa;
+  void (*fp32_to_fp16)(const float *, uint16_t *, size_t);
+  void (*fp16_to_fp32)(const uint16_t *, float *, size_t);
+  void (*fp32_to_bf16)(const float *, uint16_t *, size_t);
+  void (*bf16_to_fp32)(const uint16_t *, float *, size_t);
+  void (*int8_to_fp32)(const int8_t *, float *, size_t);
+  void (*int8_to_fp16)(const int8_t *, uint16_t *, size_t);
+};
+
+inline BatchConvertFuncs SelectBatchConvertFuncs() {
+  BatchConvertFuncs funcs{BatchConvertIsa::kScalar, &Fp32ToFp16Scalar, &Fp16ToFp32Scalar, &Fp32ToBf16Scalar,
+                          &Bf16ToFp32Scalar,        &Int8ToFp32Scalar, &Int8ToFp16Scalar};
+#if defined(GE_BATCH_CONVERT_X86)
+  __builtin_cpu_init();
+  if ((__builtin_cpu_supports("avx2") != 0) && (__builtin_cpu_supports("f16c") != 0)) {
+    funcs = {BatchConvertIsa::kAvx2F16c, &Fp32ToFp16Avx2, &Fp16ToFp32Avx2, &Fp32ToBf16Avx2,
+             &Bf16ToFp32Avx2,            &Int8ToFp32Avx2, &Int8ToFp16Avx2};
+    if (__builtin_cpu_supports("avx512f") != 0) {
+      funcs.isa = BatchConvertIsa::kAvx512;
+      funcs.fp32_to_fp16 = &Fp32ToFp16Avx512;
+      funcs.fp16_to_fp32 = &Fp16ToFp32Avx512;
+    }
+  }
+#elif defined(GE_BATCH_CONVERT_NEON)
+  funcs.isa = BatchConvertIsa::kNeon;
+  funcs.fp32_to_fp16 = &Fp32ToFp16Neon;
+  funcs.fp16_to_fp32 = &Fp16ToFp32Neon;
+  funcs.bf16_to_fp32 = &Bf16ToFp32Neon;
+#endif
+  return funcs;
+}
+
+inline const BatchConvertFuncs &GetBatchConvertFuncs() {
+  static const BatchConvertFuncs funcs = SelectBatchConvertFuncs();
+  return funcs;
+}
+}  // namespace batch_convert
+
+/// @ingroup fp16 batch conversion
+/// @brief   instruction set selected for current cpu
+inline BatchConvertIsa GetBatchConvertIsa() {
+  return batch_convert::GetBatchConvertFuncs().isa;
+}
+
+/// @ingroup fp16 batch conversion
+/// @brief   convert num fp32 values to fp16, results are the same as fp16_t with round to nearest even
+inline void BatchConvertFp32ToFp16(const float *const src, uint16_t *const dst, const size_t num) {
+  batch_convert::GetBatchConvertFuncs().fp32_to_fp16(src, dst, num);
+}
+
+/// @ingroup fp16 batch conversion
+/// @brief   convert num fp16 values to fp32, results are the same as fp16_t::ToFloat
+inline void BatchConvertFp16ToFp32(const uint16_t *const src, float *const dst, const size_t num) {
+  batch_convert::GetBatchConvertFuncs().fp16_to_fp32(src, dst, num);
+}
+
+/// @ingroup fp16 batch conversion
+/// @brief   convert num fp32 values to bf16 with round to nearest even
+inline void BatchConvertFp32ToBf16(const float *const src, uint16_t *const dst, const size_t num) {
+  batch_convert::GetBatchConvertFuncs().fp32_to_bf16(src, dst, num);
+}
+
+/// @ingroup fp16 batch conversion
+/// @brief   convert num bf16 values to fp32
+inline void BatchConvertBf16ToFp32(const uint16_t *const src, float *const dst, const size_t num) {
+  batch_convert::GetBatchConvertFuncs().bf16_to_fp32(src, dst, num);
+}
+
+/// @ingroup fp16 batch conversion
+/// @brief   convert num int8 values to fp32
+inline void BatchConvertInt8ToFp32(const int8_t *const src, float *const dst, const size_t num) {
+  batch_convert::GetBatchConvertFuncs().int8_to_fp32(src, dst, num);
+}
+
+/// @ingroup fp16 batch conversion
+/// @brief   convert num int8 values to fp16
+inline void BatchConvertInt8ToFp16(const int8_t *const src, uint16_t *const dst, const size_t num) {
+  batch_convert::GetBatchConvertFuncs().int8_to_fp16(src, dst, num);
+}
+}  // namespace ge
+
+#endif  // GE_COMMON_FP16_BATCH_CONVERT_H_
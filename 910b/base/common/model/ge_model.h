@@ -33,6 +33,10 @@
 #include "proto/task.pb.h"
 
 namespace ge {
+// complete in common/helper/mapped_model_file.h, kept out of here so that no mapping header reaches model users
+class MappedModelFile;
+using MappedModelFilePtr = std::shared_ptr<MappedModelFile>;
+
 class GeModel : public std::enable_shared_from_this<GeModel>, public AttrHolder {
  public:
   GeModel();
@@ -52,6 +56,10 @@ class GeModel : public std::enable_shared_from_this<GeModel>, public AttrHolder
   void SetWeightDataBuf(const DataBuffer &data_buffer);
   void ClearWeightDataBuf();
 
+  // om file whose mapping holds the weight data buf, kept as long as the model
+  void SetMappedFile(const MappedModelFilePtr &mapped_file) { mapped_file_ = mapped_file; }
+  const MappedModelFilePtr &GetMappedFile() const { return mapped_file_; }
+
   std::string GetName() const;
   uint32_t GetVersion() const;
   std::string GetPlatformVersion() const;
@@ -98,6 +106,7 @@ class GeModel : public std::enable_shared_from_this<GeModel>, public AttrHolder
   Buffer weights_buffer_;  /*lint !e148*/
   // weight_data_buffer is high priority than weights_buffer_
   DataBuffer weight_data_buffer_;
+  MappedModelFilePtr mapped_file_;
   std::string name_;
   uint32_t version_ = {0U};
   std::string platform_version_;
@@ -0,0 +1,435 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_COMMON_WORK_STEALING_THREAD_POOL_H_
+#define GE_COMMON_WORK_STEALING_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace ge {
+///
+/// @brief move-only type erased task, callables not larger than kInlineSize are stored without heap allocation.
+///        The wrapper of commit is inline, the shared state of its packaged_task is still allocated on heap
+///
+class SmallTask {
+ public:
+  static constexpr size_t kInlineSize = 48U;
+
+  SmallTask() = default;
+
+  template <typename Func, typename Decayed = typename std::decay<Func>::type,
+            typename = typename std::enable_if<!std::is_same<Decayed, SmallTask>::value>::type>
+  SmallTask(Func &&func) {  // implicit, so that lambdas convert like std::function
+    Construct<Decayed>(std::forward<Func>(func), std::integral_constant<bool, IsInline<Decayed>()>());
+  }
+
+  SmallTask(SmallTask &&other) noexcept {
+    MoveFrom(other);
+  }
+
+  SmallTask &operator=(SmallTask &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  SmallTask(const SmallTask &) = delete;
+  SmallTask &operator=(const SmallTask &) = delete;
+
+  ~SmallTask() {
+    Reset();
+  }
+
+  void operator()() {
+    ops_->invoke(&storage_);
+  }
+
+  explicit operator bool() const {
+    return ops_ != nullptr;
+  }
+
+  void Reset() {
+    if (ops_ != nullptr) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void *storage);
+    void (*move)(void *dst, void *src);
+    void (*destroy)(void *storage);
+  };
+
+  template <typename T>
+  static constexpr bool IsInline() {
+    return (sizeof(T) <= kInlineSize) && (alignof(T) <= alignof(std::max_align_t)) &&
+           std::is_nothrow_move_constructible<T>::value;
+  }
+
+  template <typename T>
+  static const Ops *InlineOps() {
+    static const Ops ops{[](void *storage) { (*static_cast<T *>(storage))(); },
+                         [](void *dst, void *src) {
+                           new (dst) T(std::move(*static_cast<T *>(src)));
+                           static_cast<T *>(src)->~T();
+                         },
+                         [](void *storage) { static_cast<T *>(storage)->~T(); }};
+    return &ops;
+  }
+
+  template <typename T>
+  static const Ops *HeapOps() {
+    static const Ops ops{[](void *storage) { (**static_cast<T **>(storage))(); },
+                         [](void *dst, void *src) {
+                           *static_cast<T **>(dst) = *static_cast<T **>(src);
+                           *static_cast<T **>(src) = nullptr;
+                         },
+                         [](void *storage) { delete *static_cast<T **>(storage); }};
+    return &ops;
+  }
+
+  template <typename T, typename Func>
+  void Construct(Func &&func, std::true_type) {
+    new (&storage_) T(std::forward<Func>(func));
+    ops_ = InlineOps<T>();
+  }
+
+  template <typename T, typename Func>
+  void Construct(Func &&func, std::false_type) {
+    *reinterpret_cast<T **>(&storage_) = new T(std::forward<Func>(func));
+    ops_ = HeapOps<T>();
+  }
+
+  void MoveFrom(SmallTask &other) noexcept {
+    if (other.ops_ != nullptr) {
+      other.ops_->move(&storage_, &other.storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  typename std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type storage_;
+  const Ops *ops_ = nullptr;
+};
+
+///
+/// @brief thread pool with one task deque per worker. Worker takes tasks from the front of its own deque and steals
+///        from the back of others when idle. Interface of commit is the same as ThreadPool.
+///
+class WorkStealingThreadPool {
+ public:
+  static constexpr uint32_t kNoAffinity = UINT32_MAX;
+
+  explicit WorkStealingThreadPool(const uint32_t size = 4U) : is_stoped_(false) {
+    const uint32_t thread_num = (size == 0U) ? 1U : size;
+    queues_.reserve(thread_num);
+    for (uint32_t i = 0U; i < thread_num; ++i) {
+      queues_.emplace_back(new (std::nothrow) WorkerQueue());
+      if (queues_.back() == nullptr) {
+        GELOGE(FAILED, "[New][WorkerQueue] failed, index:%u", i);
+        is_stoped_.store(true);
+        return;
+      }
+    }
+    for (uint32_t i = 0U; i < thread_num; ++i) {
+      pool_.emplace_back(&WorkStealingThreadPool::ThreadFunc, this, i);
+    }
+  }
+
+  ~WorkStealingThreadPool() {
+    Stop();
+  }
+
+  WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+  WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+
+  template <class Func, class... Args>
+  auto commit(Func &&func, Args &&... args) -> std::future<decltype(func(args...))> {
+    return CommitWithAffinity(kNoAffinity, std::forward<Func>(func), std::forward<Args>(args)...);
+  }
+
+  ///
+  /// @brief commit task with a preferred worker, tasks with the same affinity run in commit order
+  ///        unless they are stolen by idle workers
+  ///
+  template <class Func, class... Args>
+  auto CommitWithAffinity(const uint32_t affinity, Func &&func, Args &&... args)
+      -> std::future<decltype(func(args...))> {
+    using retType = decltype(func(args...));
+    std::packaged_task<retType()> task(std::bind(std::forward<Func>(func), std::forward<Args>(args)...));
+    std::future<retType> future = task.get_future();
+    if (!Push(SmallTask(std::move(task)), affinity)) {
+      return std::future<retType>();
+    }
+    return future;
+  }
+
+  ///
+  /// @brief fire and forget, no completion handle and no heap allocation for small callables.
+  ///        Exceptions thrown by func are logged and dropped
+  /// @return false if pool has been stopped
+  ///
+  template <class Func>
+  bool Post(Func &&func, const uint32_t affinity = kNoAffinity) {
+    return Push(SmallTask(std::forward<Func>(func)), affinity);
+  }
+
+  ///
+  /// @brief run func(index) for index in [0, task_num), tasks are chunked and spread over workers
+  /// @return one future for all tasks, which holds the first exception thrown if any
+  ///
+  template <class Func>
+  std::future<void> CommitBatch(const size_t task_num, Func &&func) {
+    struct BatchState {
+      typename std::decay<Func>::type func;
+      std::atomic<size_t> remain_chunks;
+      std::promise<void> promise;
+      std::once_flag error_flag;
+      std::exception_ptr error;
+    };
+    std::shared_ptr<BatchState> state(new (std::nothrow) BatchState{std::forward<Func>(func), {0U}, {}, {}, nullptr});
+    if (state == nullptr) {
+      GELOGE(FAILED, "[New][BatchState] failed.");
+      return std::future<void>();
+    }
+    std::future<void> future = state->promise.get_future();
+    if (task_num == 0U) {
+      state->promise.set_value();
+      return future;
+    }
+    const size_t chunk_num = std::min(task_num, queues_.size() * kChunksPerWorker);
+    const size_t chunk_size = (task_num + chunk_num - 1U) / chunk_num;
+    const size_t real_chunk_num = (task_num + chunk_size - 1U) / chunk_size;
+    state->remain_chunks.store(real_chunk_num);
+    // all chunks are queued under one lock, so that a concurrent Stop never leaves part of the batch queued
+    {
+      const std::lock_guard<std::mutex> lock(wait_mutex_);
+      if (is_stoped_.load()) {
+        GELOGE(FAILED, "[Commit][Batch] thread pool has been stopped, %zu chunks dropped.", real_chunk_num);
+        return std::future<void>();
+      }
+      for (size_t chunk = 0U; chunk < real_chunk_num; ++chunk) {
+        const size_t begin = chunk * chunk_size;
+        const size_t end = std::min(task_num, begin + chunk_size);
+        PushLocked(SmallTask([state, begin, end]() {
+                               try {
+                                 for (size_t i = begin; i < end; ++i) {
+                                   state->func(i);
+                                 }
+                               } catch (...) {
+                                 std::call_once(state->error_flag,
+                                                [&state]() { state->error = std::current_exception(); });
+                               }
+                               if (state->remain_chunks.fetch_sub(1U) == 1U) {
+                                 if (state->error != nullptr) {
+                                   state->promise.set_exception(state->error);
+                                 } else {
+                                   state->promise.set_value();
+                                 }
+                               }
+                             }),
+                   static_cast<uint32_t>(chunk % queues_.size()));
+      }
+    }
+    cond_var_.notify_all();
+    return future;
+  }
+
+  uint32_t GetThreadNum() const {
+    return static_cast<uint32_t>(queues_.size());
+  }
+
+  ///
+  /// @brief whether the caller runs on a worker of this pool, such callers must not block on tasks of the pool
+  ///
+  bool IsInWorkerThread() const {
+    return CurrentWorker().pool == this;
+  }
+
+  ///
+  /// @brief stop accepting tasks, wait until committed tasks are done and join workers. Called from a task of this
+  ///        pool, the calling worker is detached instead of joined and exits once the task returns
+  ///
+  void Stop() {
+    // workers are taken out under the lock, so that concurrent Stop calls never join the same thread twice
+    std::vector<std::thread> pool;
+    {
+      const std::lock_guard<std::mutex> lock(wait_mutex_);
+      is_stoped_.store(true);
+      pool.swap(pool_);
+    }
+    cond_var_.notify_all();
+    const std::thread::id self = std::this_thread::get_id();
+    for (auto &thd : pool) {
+      if (thd.get_id() == self) {
+        GELOGW("Thread pool is stopped by its worker %u, the worker is detached.", CurrentWorker().worker_id);
+        CurrentWorker().pool = nullptr;
+        thd.detach();
+      } else if (thd.joinable()) {
+        thd.join();
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kChunksPerWorker = 4U;
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<SmallTask> tasks;
+  };
+
+  struct WorkerContext {
+    const WorkStealingThreadPool *pool = nullptr;
+    uint32_t worker_id = 0U;
+  };
+
+  static WorkerContext &CurrentWorker() {
+    static thread_local WorkerContext context;
+    return context;
+  }
+
+  bool Push(SmallTask &&task, const uint32_t affinity) {
+    bool has_idle = false;
+    {
+      // checked under the lock of Stop, a task queued here is always drained before the workers exit
+      const std::lock_guard<std::mutex> lock(wait_mutex_);
+      if (is_stoped_.load()) {
+        GELOGE(FAILED, "thread pool has been stopped.");
+        return false;
+      }
+      PushLocked(std::move(task), affinity);
+      has_idle = (idle_thread_num_ > 0U);
+    }
+    if (has_idle) {
+      cond_var_.notify_one();
+    }
+    return true;
+  }
+
+  // wait_mutex_ must be held
+  void PushLocked(SmallTask &&task, const uint32_t affinity) {
+    uint32_t index = affinity;
+    if (index == kNoAffinity) {
+      const WorkerContext &context = CurrentWorker();
+      // task committed by a worker goes to its own queue for locality
+      index = (context.pool == this) ? context.worker_id : next_queue_.fetch_add(1U, std::memory_order_relaxed);
+    }
+    WorkerQueue &queue = *queues_[index % queues_.size()];
+    const std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.emplace_back(std::move(task));
+    (void)pending_task_num_.fetch_add(1U);
+  }
+
+  bool TryPop(const uint32_t worker_id, SmallTask &task) {
+    {
+      WorkerQueue &own = *queues_[worker_id];
+      const std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.front());
+        own.tasks.pop_front();
+        (void)pending_task_num_.fetch_sub(1U);
+        return true;
+      }
+    }
+    // victims are tried without blocking first, busy ones are locked in a second pass so that a pending task is
+    // never missed and the worker does not spin on the wait predicate
+    const size_t queue_num = queues_.size();
+    for (size_t pass = 0U; pass < 2U; ++pass) {
+      for (size_t i = 1U; i < queue_num; ++i) {
+        WorkerQueue &victim = *queues_[(worker_id + i) % queue_num];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::defer_lock);
+        if (pass == 0U) {
+          (void)lock.try_lock();
+        } else {
+          lock.lock();
+        }
+        if (lock.owns_lock() && (!victim.tasks.empty())) {
+          task = std::move(victim.tasks.back());
+          victim.tasks.pop_back();
+          (void)pending_task_num_.fetch_sub(1U);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  static void ThreadFunc(WorkStealingThreadPool *const pool, const uint32_t worker_id) {
+    CurrentWorker().pool = pool;
+    CurrentWorker().worker_id = worker_id;
+    SmallTask task;
+    while (true) {
+      if (pool->TryPop(worker_id, task)) {
+        // tasks of commit keep exceptions in their future, only posted tasks may throw here
+        try {
+          task();
+        } catch (const std::exception &e) {
+          GELOGE(FAILED, "[Run][Task] worker %u, task threw exception: %s", worker_id, e.what());
+        } catch (...) {
+          GELOGE(FAILED, "[Run][Task] worker %u, task threw unknown exception", worker_id);
+        }
+        task.Reset();
+        // pool may be gone if the task stopped it, see Stop
+        if (CurrentWorker().pool != pool) {
+          return;
+        }
+        continue;
+      }
+      // pending_task_num_ only counts queued tasks, it is raised under wait_mutex_ so no wakeup is lost
+      std::unique_lock<std::mutex> lock(pool->wait_mutex_);
+      (void)pool->idle_thread_num_.fetch_add(1U);
+      pool->cond_var_.wait(lock, [pool]() { return pool->is_stoped_.load() || (pool->pending_task_num_.load() > 0U); });
+      (void)pool->idle_thread_num_.fetch_sub(1U);
+      if (pool->is_stoped_.load() && (pool->pending_task_num_.load() == 0U)) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> pool_;
+  std::mutex wait_mutex_;
+  std::condition_variable cond_var_;
+  std::atomic<bool> is_stoped_;
+  std::atomic<size_t> pending_task_num_{0U};
+  std::atomic<uint32_t> idle_thread_num_{0U};
+  std::atomic<uint32_t> next_queue_{0U};
+};
+}  // namespace ge
+
+#endif  // GE_COMMON_WORK_STEALING_THREAD_POOL_H_
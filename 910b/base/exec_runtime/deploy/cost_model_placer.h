@@ -0,0 +1,354 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BASE_EXEC_RUNTIME_DEPLOY_COST_MODEL_PLACER_H_
+#define BASE_EXEC_RUNTIME_DEPLOY_COST_MODEL_PLACER_H_
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/model/model_relation.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace ge {
+struct SubmodelCostProfile {
+  double compute_us = 0.0;        // time of one sample on a device of compute scale 1.0, measured or estimated
+  uint64_t memory_size = 0UL;     // device memory of weights, features and workspace
+  int32_t pinned_device = -1;     // index of device the submodel must run on, -1 for free placement
+};
+
+struct PlacementDeviceProfile {
+  int32_t type = 0;
+  int32_t node_id = 0;
+  int32_t device_id = 0;
+  uint64_t memory_capacity = UINT64_MAX;
+  double compute_scale = 1.0;     // relative speed, compute time of a submodel is divided by it
+};
+
+struct PlacementCostModel {
+  // key: model_instance_name, submodels without profile cost nothing
+  std::map<std::string, SubmodelCostProfile> submodel_costs;
+  // key: queue name, tensor bytes of one sample on the relation edge
+  std::map<std::string, uint64_t> queue_sizes;
+  std::vector<PlacementDeviceProfile> devices;
+  double intra_node_bytes_per_us = 16384.0;  // between devices of one node
+  double inter_node_bytes_per_us = 2048.0;   // between nodes
+  uint32_t max_refine_rounds = 256U;
+};
+
+struct PlacementResult {
+  // key: model_instance_name, value: index of device in PlacementCostModel::devices
+  std::map<std::string, size_t> device_indices;
+  std::vector<double> device_loads;  // estimated time of one sample of every device, compute and transfer
+  std::vector<uint64_t> device_memory;
+  double bottleneck_us = 0.0;
+  double throughput = 0.0;           // samples per second of the pipeline
+  uint64_t plan_time_us = 0UL;
+};
+
+/**
+ * Placement of submodels of a flow model for pipelined execution. Every device is a pipeline stage whose time of
+ * one sample is the compute time of its submodels plus the transfer time of relation edges that cross devices,
+ * paid by both ends. The placer minimizes the slowest stage within device memory: a greedy pass puts submodels in
+ * descending cost on the device giving the lowest bottleneck, then moves and swaps off the bottleneck device are
+ * applied while they lower the bottleneck, or keep it and balance the other stages.
+ */
+class CostModelPlacer {
+ public:
+  Status Place(const ModelRelation &model_relation, const PlacementCostModel &cost_model, PlacementResult &result) {
+    const auto start = std::chrono::steady_clock::now();
+    GE_CHK_STATUS_RET(Initialize(model_relation, cost_model), "[Init][Placer] failed");
+    GE_CHK_STATUS_RET(PlaceGreedy(), "[Place][Submodels] greedy placement failed");
+    Refine();
+    result = PlacementResult();
+    const Cost cost = Evaluate(placement_, result.device_loads);
+    result.device_memory.assign(devices_->size(), 0UL);
+    for (size_t i = 0U; i < submodels_.size(); ++i) {
+      result.device_indices[submodels_[i].name] = placement_[i];
+      result.device_memory[placement_[i]] += submodels_[i].memory_size;
+    }
+    result.bottleneck_us = cost.first;
+    result.throughput = (cost.first > 0.0) ? (1000000.0 / cost.first) : 0.0;
+    result.plan_time_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    GELOGI("Cost model placement done, submodel num:%zu, device num:%zu, bottleneck:%.3f us, "
+           "throughput:%.1f samples/s, plan time:%lu us", submodels_.size(), devices_->size(), result.bottleneck_us,
+           result.throughput, result.plan_time_us);
+    return SUCCESS;
+  }
+
+ private:
+  struct Submodel {
+    std::string name;
+    double compute_us;
+    uint64_t memory_size;
+    int32_t pinned_device;
+    std::vector<size_t> edges;
+  };
+
+  struct Edge {
+    size_t src;
+    size_t dst;
+    uint64_t bytes;
+  };
+
+  static constexpr size_t kNotPlaced = SIZE_MAX;
+
+  // bottleneck, then sum of squared loads to prefer balanced stages when bottleneck is even
+  using Cost = std::pair<double, double>;
+
+  static bool Better(const Cost &lhs, const Cost &rhs) {
+    constexpr double kEpsilon = 1e-9;
+    if (lhs.first < (rhs.first - kEpsilon)) {
+      return true;
+    }
+    return (lhs.first <= (rhs.first + kEpsilon)) && (lhs.second < (rhs.second - kEpsilon));
+  }
+
+  Status Initialize(const ModelRelation &model_relation, const PlacementCostModel &cost_model) {
+    if (cost_model.devices.empty() || (cost_model.intra_node_bytes_per_us <= 0.0) ||
+        (cost_model.inter_node_bytes_per_us <= 0.0)) {
+      GELOGE(PARAM_INVALID, "[Check][Param] no device or bandwidth is not positive");
+      return PARAM_INVALID;
+    }
+    for (const auto &device : cost_model.devices) {
+      if (device.compute_scale <= 0.0) {
+        GELOGE(PARAM_INVALID, "[Check][Param] compute scale of device %d_%d_%d is not positive", device.type,
+               device.node_id, device.device_id);
+        return PARAM_INVALID;
+      }
+    }
+    cost_model_ = &cost_model;
+    devices_ = &cost_model.devices;
+    submodels_.clear();
+    edges_.clear();
+    std::map<std::string, std::vector<size_t>> producers;
+    for (const auto &it : model_relation.submodel_queue_infos) {
+      Submodel submodel{it.first, 0.0, 0UL, -1, {}};
+      const auto cost_it = cost_model.submodel_costs.find(it.first);
+      if (cost_it != cost_model.submodel_costs.end()) {
+        submodel.compute_us = cost_it->second.compute_us;
+        submodel.memory_size = cost_it->second.memory_size;
+        submodel.pinned_device = cost_it->second.pinned_device;
+      }
+      if (submodel.pinned_device >= static_cast<int32_t>(devices_->size())) {
+        GELOGE(PARAM_INVALID, "[Check][Param] submodel %s is pinned to device %d, but device num is %zu",
+               it.first.c_str(), submodel.pinned_device, devices_->size());
+        return PARAM_INVALID;
+      }
+      for (const auto &queue_name : it.second.output_queue_names) {
+        producers[queue_name].emplace_back(submodels_.size());
+      }
+      submodels_.emplace_back(std::move(submodel));
+    }
+    size_t dst = 0U;
+    for (const auto &it : model_relation.submodel_queue_infos) {
+      for (const auto &queue_name : it.second.input_queue_names) {
+        const auto producer_it = producers.find(queue_name);
+        if (producer_it == producers.end()) {
+          continue;  // fed by root model inputs
+        }
+        const auto size_it = cost_model.queue_sizes.find(queue_name);
+        const uint64_t bytes = (size_it == cost_model.queue_sizes.end()) ? 0UL : size_it->second;
+        for (const size_t src : producer_it->second) {
+          if (src != dst) {
+            submodels_[src].edges.emplace_back(edges_.size());
+            submodels_[dst].edges.emplace_back(edges_.size());
+            edges_.emplace_back(Edge{src, dst, bytes});
+          }
+        }
+      }
+      ++dst;
+    }
+    return SUCCESS;
+  }
+
+  double TransferUs(const Edge &edge, const size_t src_device, const size_t dst_device) const {
+    if (src_device == dst_device) {
+      return 0.0;
+    }
+    const double bandwidth = ((*devices_)[src_device].node_id == (*devices_)[dst_device].node_id)
+                             ? cost_model_->intra_node_bytes_per_us
+                             : cost_model_->inter_node_bytes_per_us;
+    return static_cast<double>(edge.bytes) / bandwidth;
+  }
+
+  Cost Evaluate(const std::vector<size_t> &placement, std::vector<double> &loads) const {
+    loads.assign(devices_->size(), 0.0);
+    for (size_t i = 0U; i < submodels_.size(); ++i) {
+      loads[placement[i]] += submodels_[i].compute_us / (*devices_)[placement[i]].compute_scale;
+    }
+    for (const auto &edge : edges_) {
+      const double transfer_us = TransferUs(edge, placement[edge.src], placement[edge.dst]);
+      loads[placement[edge.src]] += transfer_us;
+      loads[placement[edge.dst]] += transfer_us;
+    }
+    Cost cost{0.0, 0.0};
+    for (const double load : loads) {
+      cost.first = std::max(cost.first, load);
+      cost.second += load * load;
+    }
+    return cost;
+  }
+
+  bool Fits(const std::vector<uint64_t> &memory, const size_t device, const uint64_t size) const {
+    return size <= ((*devices_)[device].memory_capacity - std::min(memory[device], (*devices_)[device].memory_capacity));
+  }
+
+  // load increase of every device if submodel is put on device, edges to submodels not placed yet cost nothing
+  void PlacementDeltas(const size_t index, const size_t device, std::vector<double> &deltas) const {
+    std::fill(deltas.begin(), deltas.end(), 0.0);
+    deltas[device] += submodels_[index].compute_us / (*devices_)[device].compute_scale;
+    for (const size_t edge_index : submodels_[index].edges) {
+      const Edge &edge = edges_[edge_index];
+      const size_t peer = (edge.src == index) ? edge.dst : edge.src;
+      if (placement_[peer] != kNotPlaced) {
+        const double transfer_us = TransferUs(edge, device, placement_[peer]);
+        deltas[device] += transfer_us;
+        deltas[placement_[peer]] += transfer_us;
+      }
+    }
+  }
+
+  Status PlaceGreedy() {
+    std::vector<size_t> order(submodels_.size());
+    for (size_t i = 0U; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    // pinned first, so free submodels see their load
+    std::stable_sort(order.begin(), order.end(), [this](const size_t lhs, const size_t rhs) {
+      const bool lhs_pinned = submodels_[lhs].pinned_device >= 0;
+      const bool rhs_pinned = submodels_[rhs].pinned_device >= 0;
+      if (lhs_pinned != rhs_pinned) {
+        return lhs_pinned;
+      }
+      return submodels_[lhs].compute_us > submodels_[rhs].compute_us;
+    });
+    placement_.assign(submodels_.size(), kNotPlaced);
+    memory_.assign(devices_->size(), 0UL);
+    std::vector<double> loads(devices_->size(), 0.0);
+    std::vector<double> deltas(devices_->size(), 0.0);
+    for (const size_t index : order) {
+      const Submodel &submodel = submodels_[index];
+      size_t best_device = kNotPlaced;
+      Cost best_cost;
+      for (size_t device = 0U; device < devices_->size(); ++device) {
+        const bool allowed = (submodel.pinned_device < 0) || (static_cast<size_t>(submodel.pinned_device) == device);
+        if ((!allowed) || (!Fits(memory_, device, submodel.memory_size))) {
+          continue;
+        }
+        PlacementDeltas(index, device, deltas);
+        Cost cost{0.0, 0.0};
+        for (size_t i = 0U; i < loads.size(); ++i) {
+          const double load = loads[i] + deltas[i];
+          cost.first = std::max(cost.first, load);
+          cost.second += load * load;
+        }
+        if ((best_device == kNotPlaced) || Better(cost, best_cost)) {
+          best_device = device;
+          best_cost = cost;
+        }
+      }
+      if (best_device == kNotPlaced) {
+        GELOGE(FAILED, "[Place][Submodel] no device has %lu bytes of memory left for submodel %s",
+               submodel.memory_size, submodel.name.c_str());
+        return FAILED;
+      }
+      placement_[index] = best_device;
+      memory_[best_device] += submodel.memory_size;
+      PlacementDeltas(index, best_device, deltas);
+      for (size_t i = 0U; i < loads.size(); ++i) {
+        loads[i] += deltas[i];
+      }
+    }
+    return SUCCESS;
+  }
+
+  void Refine() {
+    std::vector<double> loads;
+    Cost current = Evaluate(placement_, loads);
+    for (uint32_t round = 0U; round < cost_model_->max_refine_rounds; ++round) {
+      const size_t bottleneck = static_cast<size_t>(std::max_element(loads.begin(), loads.end()) - loads.begin());
+      std::vector<size_t> best_placement;
+      Cost best_cost = current;
+      std::vector<size_t> candidate = placement_;
+      std::vector<double> candidate_loads;
+      for (size_t i = 0U; i < submodels_.size(); ++i) {
+        if ((placement_[i] != bottleneck) || (submodels_[i].pinned_device >= 0)) {
+          continue;
+        }
+        for (size_t device = 0U; device < devices_->size(); ++device) {
+          if ((device == bottleneck) || (!Fits(memory_, device, submodels_[i].memory_size))) {
+            continue;
+          }
+          candidate[i] = device;
+          const Cost cost = Evaluate(candidate, candidate_loads);
+          if (Better(cost, best_cost)) {
+            best_cost = cost;
+            best_placement = candidate;
+          }
+          candidate[i] = bottleneck;
+        }
+        for (size_t j = 0U; j < submodels_.size(); ++j) {
+          if ((placement_[j] == bottleneck) || (submodels_[j].pinned_device >= 0) || (!CanSwap(i, j))) {
+            continue;
+          }
+          std::swap(candidate[i], candidate[j]);
+          const Cost cost = Evaluate(candidate, candidate_loads);
+          if (Better(cost, best_cost)) {
+            best_cost = cost;
+            best_placement = candidate;
+          }
+          std::swap(candidate[i], candidate[j]);
+        }
+      }
+      if (best_placement.empty()) {
+        GELOGD("Cost model placement refined in %u rounds", round);
+        return;
+      }
+      for (size_t i = 0U; i < submodels_.size(); ++i) {
+        memory_[placement_[i]] -= submodels_[i].memory_size;
+        memory_[best_placement[i]] += submodels_[i].memory_size;
+      }
+      placement_ = std::move(best_placement);
+      current = Evaluate(placement_, loads);
+    }
+  }
+
+  bool CanSwap(const size_t lhs, const size_t rhs) const {
+    const size_t lhs_device = placement_[lhs];
+    const size_t rhs_device = placement_[rhs];
+    const uint64_t lhs_size = submodels_[lhs].memory_size;
+    const uint64_t rhs_size = submodels_[rhs].memory_size;
+    std::vector<uint64_t> memory = memory_;
+    memory[lhs_device] -= lhs_size;
+    memory[rhs_device] -= rhs_size;
+    return Fits(memory, lhs_device, rhs_size) && Fits(memory, rhs_device, lhs_size);
+  }
+
+  const PlacementCostModel *cost_model_ = nullptr;
+  const std::vector<PlacementDeviceProfile> *devices_ = nullptr;
+  std::vector<Submodel> submodels_;
+  std::vector<Edge> edges_;
+  std::vector<size_t> placement_;  // submodel index -> device index
+  std::vector<uint64_t> memory_;   // device index -> used memory
+};
+}  // namespace ge
+#endif  // BASE_EXEC_RUNTIME_DEPLOY_COST_MODEL_PLACER_H_
@@ -0,0 +1,648 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BASE_EXEC_RUNTIME_DEPLOY_LOCAL_EXCHANGE_SERVICE_H_
+#define BASE_EXEC_RUNTIME_DEPLOY_LOCAL_EXCHANGE_SERVICE_H_
+
+#include <fcntl.h>   // O_EXCL, mmpa has no flag for it
+#include <pthread.h>
+#include <signal.h>  // kill, mmpa has no wrapper of it
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "exec_runtime/deploy/exchange_service.h"
+#include "external/runtime/rt_error_codes.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "mmpa/mmpa_api.h"
+
+namespace ge {
+struct LocalQueueStatistics {
+  uint64_t enqueue_num = 0UL;
+  uint64_t dequeue_num = 0UL;
+  uint64_t full_wait_num = 0UL;   // enqueues that waited for a free slot
+  uint64_t full_wait_us = 0UL;
+  uint64_t empty_wait_num = 0UL;  // dequeues that waited for data
+  uint64_t empty_wait_us = 0UL;
+  uint64_t occupancy_sum = 0UL;   // occupancy after every enqueue, divided by enqueue_num for average
+  uint32_t max_occupancy = 0U;
+  uint32_t depth = 0U;
+  uint32_t depth_grow_num = 0U;
+  uint32_t depth_shrink_num = 0U;
+};
+
+/**
+ * ExchangeService on host shared memory, queues of the same name are one queue in all processes of the host.
+ * A queue is a ring of fixed size slots in a POSIX shared memory object, guarded by a process shared robust mutex.
+ * Writers reserve a slot and fill it outside the lock, so Enqueue with FillFunc writes straight into the ring.
+ * Depth starts at MemQueueAttr::depth and, if max_depth is larger, doubles when enqueues often fill the queue and
+ * shrinks by one when the queue stays below half of its depth, within [depth, max_depth].
+ * Timeout of ControlInfo is in ms, 0 waits forever. Device id is ignored.
+ * Every process attaching a queue must pass the same depth, max depth and message size as its creator.
+ * Slots record the pid that writes or reads them. Slots of a process that died, found when the lock comes back as
+ * EOWNERDEAD or while waiting, are discarded or freed so the ring moves on.
+ */
+class LocalExchangeService : public ExchangeService {
+ public:
+  explicit LocalExchangeService(const size_t max_msg_size = kDefaultMaxMsgSize)
+      : max_msg_size_(max_msg_size), pid_(mmGetPid()) {}
+  ~LocalExchangeService() override {
+    std::map<uint32_t, LocalQueue> queues;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      queues.swap(queues_);
+    }
+    for (auto &queue : queues) {
+      Close(queue.second);
+    }
+  }
+
+  using ExchangeService::CreateQueue;
+  Status CreateQueue(const int32_t device_id, const std::string &name, const MemQueueAttr &mem_queue_attr,
+                     uint32_t &queue_id) override {
+    (void)device_id;
+    const uint32_t min_depth = (mem_queue_attr.depth == 0U) ? 1U : mem_queue_attr.depth;
+    const uint32_t max_depth = std::max(min_depth, mem_queue_attr.max_depth);
+    LocalQueue queue;
+    queue.shm_name = ToShmName(name);
+    queue.map_size = kHeaderSize + static_cast<size_t>(max_depth) * SlotStride(max_msg_size_);
+    GE_CHK_STATUS_RET_NOLOG(Open(queue, min_depth, max_depth));
+    const std::lock_guard<std::mutex> lock(mutex_);
+    queue_id = next_queue_id_++;
+    queues_[queue_id] = queue;
+    GELOGI("Local queue %s created, id:%u, depth:[%u, %u], slot size:%zu", name.c_str(), queue_id,
+           queue.header->min_depth, queue.header->max_depth, queue.header->slot_size);
+    return SUCCESS;
+  }
+
+  /**
+   * No thread of this process may use the queue while it is destroyed, the last process removes shared memory
+   */
+  Status DestroyQueue(const int32_t device_id, const uint32_t queue_id) override {
+    (void)device_id;
+    LocalQueue queue;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      const auto it = queues_.find(queue_id);
+      if (it == queues_.end()) {
+        GELOGE(PARAM_INVALID, "[Check][Param] local queue %u does not exist", queue_id);
+        return PARAM_INVALID;
+      }
+      queue = it->second;
+      (void)queues_.erase(it);
+    }
+    Close(queue);
+    return SUCCESS;
+  }
+
+  Status Enqueue(const int32_t device_id, const uint32_t queue_id, const void *const data, const size_t size,
+                 const ControlInfo &control_info) override {
+    return Enqueue(device_id, queue_id, size, [data, size](void *const buffer, const size_t buffer_size) {
+      (void)buffer_size;
+      if (size > 0U) {
+        (void)memcpy(buffer, data, size);
+      }
+      return SUCCESS;
+    }, control_info);
+  }
+
+  Status Enqueue(const int32_t device_id, const uint32_t queue_id, const size_t size, const FillFunc &fill_func,
+                 const ControlInfo &control_info) override {
+    (void)device_id;
+    LocalQueue queue;
+    GE_CHK_STATUS_RET_NOLOG(GetQueue(queue_id, queue));
+    RingHeader *const header = queue.header;
+    if (size > header->slot_size) {
+      GELOGE(PARAM_INVALID, "[Check][Param] message size %zu exceeds slot size %zu of local queue %u", size,
+             header->slot_size, queue_id);
+      return PARAM_INVALID;
+    }
+    uint64_t sequence = 0UL;
+    {
+      RingLock lock(header);
+      GE_CHK_BOOL_RET_STATUS_NOLOG(lock.IsLocked(), FAILED);
+      const Status ret = Wait(lock, header, header->not_full, control_info.timeout, header->stats.full_wait_num,
+                              header->stats.full_wait_us, [header]() {
+                                return (header->reserved_tail - header->head) < header->depth;
+                              });
+      if (ret != SUCCESS) {
+        return (ret == kWaitTimeout) ? static_cast<Status>(ACL_ERROR_RT_QUEUE_FULL) : ret;
+      }
+      sequence = header->reserved_tail++;
+      SlotOf(header, sequence)->owner_pid = pid_;
+      SlotOf(header, sequence)->state = kSlotWriting;
+    }
+    SlotHeader *const slot = SlotOf(header, sequence);
+    Status ret = SUCCESS;
+    if (size > 0U) {
+      ret = fill_func(PayloadOf(slot), size);
+    }
+    slot->size = size;
+    slot->end_of_sequence = control_info.end_of_sequence_flag ? 1U : 0U;
+    slot->has_msg_info = (control_info.msg_info != nullptr) ? 1U : 0U;
+    if (control_info.msg_info != nullptr) {
+      slot->msg_info = *control_info.msg_info;
+    }
+    {
+      RingLock lock(header);
+      GE_CHK_BOOL_RET_STATUS_NOLOG(lock.IsLocked(), FAILED);
+      // a failed fill still ends its slot so slots behind it are not blocked, readers skip it
+      slot->state = (ret == SUCCESS) ? kSlotReady : kSlotDiscarded;
+      AdvanceTail(header);
+      const uint32_t occupancy = static_cast<uint32_t>(header->reserved_tail - header->head);
+      ++header->stats.enqueue_num;
+      header->stats.occupancy_sum += occupancy;
+      header->stats.max_occupancy = std::max(header->stats.max_occupancy, occupancy);
+      AdaptDepth(header, occupancy);
+      (void)pthread_cond_broadcast(&header->not_empty);
+    }
+    return ret;
+  }
+
+  Status Peek(const int32_t device_id, const uint32_t queue_id, size_t &size) override {
+    (void)device_id;
+    LocalQueue queue;
+    GE_CHK_STATUS_RET_NOLOG(GetQueue(queue_id, queue));
+    RingLock lock(queue.header);
+    GE_CHK_BOOL_RET_STATUS_NOLOG(lock.IsLocked(), FAILED);
+    SkipDiscarded(queue.header);
+    if (queue.header->reserved_head >= queue.header->tail) {
+      return static_cast<Status>(ACL_ERROR_RT_QUEUE_EMPTY);
+    }
+    size = SlotOf(queue.header, queue.header->reserved_head)->size;
+    return SUCCESS;
+  }
+
+  Status Dequeue(const int32_t device_id, const uint32_t queue_id, void *const data, const size_t size,
+                 ControlInfo &control_info) override {
+    return DequeueWith(device_id, queue_id, control_info, [data, size](const void *const payload,
+                                                                       const size_t payload_size) {
+      if (payload_size > size) {
+        GELOGE(PARAM_INVALID, "[Check][Param] message size %zu exceeds buffer size %zu", payload_size, size);
+        return PARAM_INVALID;
+      }
+      if (payload_size > 0U) {
+        (void)memcpy(data, payload, payload_size);
+      }
+      return SUCCESS;
+    });
+  }
+
+  Status DequeueTensor(const int32_t device_id, const uint32_t queue_id, GeTensor &tensor,
+                       ControlInfo &control_info) override {
+    return DequeueWith(device_id, queue_id, control_info, [&tensor](const void *const payload,
+                                                                    const size_t payload_size) {
+      return (tensor.SetData(static_cast<const uint8_t *>(payload), payload_size) == GRAPH_SUCCESS) ? SUCCESS
+                                                                                                     : FAILED;
+    });
+  }
+
+  Status GetStatistics(const uint32_t queue_id, LocalQueueStatistics &statistics) {
+    LocalQueue queue;
+    GE_CHK_STATUS_RET_NOLOG(GetQueue(queue_id, queue));
+    RingLock lock(queue.header);
+    GE_CHK_BOOL_RET_STATUS_NOLOG(lock.IsLocked(), FAILED);
+    statistics = queue.header->stats;
+    statistics.depth = queue.header->depth;
+    return SUCCESS;
+  }
+
+ private:
+  static constexpr size_t kDefaultMaxMsgSize = 1024U * 1024U;
+  static constexpr Status kWaitTimeout = static_cast<Status>(ACL_ERROR_RT_WAIT_TIMEOUT);
+  static constexpr uint32_t kRingMagic = 0x47454551U;  // GEEQ
+  static constexpr uint32_t kAdaptWindow = 32U;
+  static constexpr uint32_t kOpenRetryTimes = 1000U;
+  static constexpr int32_t kRecoverIntervalMs = 100;  // waiters look for slots of dead processes this often
+  static constexpr uint8_t kSlotFree = 0U;
+  static constexpr uint8_t kSlotWriting = 1U;
+  static constexpr uint8_t kSlotReady = 2U;
+  static constexpr uint8_t kSlotDiscarded = 3U;  // ready for tail, never read
+  static constexpr uint8_t kSlotReading = 4U;
+
+  struct RingHeader {
+    uint32_t magic;
+    uint32_t ref_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    size_t slot_size;
+    uint32_t min_depth;
+    uint32_t max_depth;
+    uint32_t depth;
+    uint32_t window_ops;
+    uint32_t window_full_waits;
+    uint32_t window_peak;
+    uint64_t head;           // first slot not freed by readers
+    uint64_t reserved_head;  // next slot to read
+    uint64_t tail;           // end of ready slots
+    uint64_t reserved_tail;  // next slot to write
+    LocalQueueStatistics stats;
+  };
+
+  struct SlotHeader {
+    uint64_t size;
+    int32_t owner_pid;  // process writing or reading the slot
+    uint8_t state;
+    uint8_t end_of_sequence;
+    uint8_t has_msg_info;
+    MsgInfo msg_info;
+  };
+
+  static constexpr size_t kCacheLine = 64U;
+  static constexpr size_t kHeaderSize = ((sizeof(RingHeader) + kCacheLine - 1U) / kCacheLine) * kCacheLine;
+  static constexpr size_t kSlotHeaderSize = ((sizeof(SlotHeader) + kCacheLine - 1U) / kCacheLine) * kCacheLine;
+
+  struct LocalQueue {
+    std::string shm_name;
+    size_t map_size = 0U;
+    mmFd_t map_extra = 0;
+    RingHeader *header = nullptr;
+  };
+
+  class RingLock {
+   public:
+    explicit RingLock(RingHeader *const header) : header_(header) {
+      (void)OnLocked(pthread_mutex_lock(&header_->mutex));
+    }
+    ~RingLock() {
+      if (locked_) {
+        (void)pthread_mutex_unlock(&header_->mutex);
+      }
+    }
+    RingLock(const RingLock &) = delete;
+    RingLock &operator=(const RingLock &) = delete;
+    bool IsLocked() const {
+      return locked_;
+    }
+    // result of a lock or a cond wait: a process died holding the lock, ring indices are only changed under lock
+    // so the ring is consistent, but slots it was writing or reading are given up. ENOTRECOVERABLE: the lock is
+    // not held and the queue can not be used anymore
+    bool OnLocked(const int32_t ret) {
+      locked_ = (ret == 0) || (ret == EOWNERDEAD) || (ret == ETIMEDOUT);
+      if (ret == EOWNERDEAD) {
+        (void)pthread_mutex_consistent(&header_->mutex);
+        RecoverDeadSlots(header_);
+      } else if (!locked_) {
+        GELOGE(FAILED, "[Lock][Ring] lock local queue failed, ret:%d, the queue is not recoverable", ret);
+      }
+      return locked_;
+    }
+    pthread_mutex_t *Get() {
+      return &header_->mutex;
+    }
+
+   private:
+    RingHeader *header_;
+    bool locked_ = false;
+  };
+
+  static size_t SlotStride(const size_t slot_size) {
+    return kSlotHeaderSize + (((slot_size + kCacheLine - 1U) / kCacheLine) * kCacheLine);
+  }
+
+  static bool IsEnded(const uint8_t state) {
+    return (state == kSlotReady) || (state == kSlotDiscarded);
+  }
+
+  static SlotHeader *SlotOf(RingHeader *const header, const uint64_t sequence) {
+    uint8_t *const base = reinterpret_cast<uint8_t *>(header) + kHeaderSize;
+    const size_t index = static_cast<size_t>(sequence % header->max_depth);
+    return reinterpret_cast<SlotHeader *>(base + index * SlotStride(header->slot_size));
+  }
+
+  static bool IsProcessAlive(const int32_t pid) {
+    return (kill(static_cast<pid_t>(pid), 0) == 0) || (errno == EPERM);
+  }
+
+  static void *PayloadOf(SlotHeader *const slot) {
+    return reinterpret_cast<uint8_t *>(slot) + kSlotHeaderSize;
+  }
+
+  static std::string ToShmName(const std::string &name) {
+    std::string shm_name = "/ge_exchange_";
+    for (const char c : name) {
+      shm_name.push_back((isalnum(static_cast<unsigned char>(c)) != 0) ? c : '_');
+    }
+    return shm_name;
+  }
+
+  static Status InitHeader(RingHeader *const header, const size_t slot_size, const uint32_t min_depth,
+                           const uint32_t max_depth) {
+    pthread_mutexattr_t mutex_attr;
+    (void)pthread_mutexattr_init(&mutex_attr);
+    (void)pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    (void)pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+    const int32_t mutex_ret = pthread_mutex_init(&header->mutex, &mutex_attr);
+    (void)pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_t cond_attr;
+    (void)pthread_condattr_init(&cond_attr);
+    (void)pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    (void)pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    const int32_t cond_ret = pthread_cond_init(&header->not_empty, &cond_attr) |
+                             pthread_cond_init(&header->not_full, &cond_attr);
+    (void)pthread_condattr_destroy(&cond_attr);
+    if ((mutex_ret != 0) || (cond_ret != 0)) {
+      GELOGE(FAILED, "[Init][Ring] init process shared mutex or cond failed");
+      return FAILED;
+    }
+    header->slot_size = slot_size;
+    header->min_depth = min_depth;
+    header->max_depth = max_depth;
+    header->depth = min_depth;
+    header->stats.depth = min_depth;
+    header->ref_count = 1U;
+    __atomic_store_n(&header->magic, kRingMagic, __ATOMIC_RELEASE);
+    return SUCCESS;
+  }
+
+  Status Open(LocalQueue &queue, const uint32_t min_depth, const uint32_t max_depth) const {
+    if (queue.map_size > UINT32_MAX) {
+      GELOGE(PARAM_INVALID, "[Check][Param] local queue %s of size %zu is too large", queue.shm_name.c_str(),
+             queue.map_size);
+      return PARAM_INVALID;
+    }
+    bool created = true;
+    mmFileHandle fd = mmShmOpen(queue.shm_name.c_str(), M_RDWR | M_CREAT | O_EXCL,
+                                static_cast<mmMode_t>(M_IRUSR | M_IWUSR));
+    if ((fd < 0) && (mmGetErrorCode() == EEXIST)) {
+      created = false;
+      fd = mmShmOpen(queue.shm_name.c_str(), M_RDWR, static_cast<mmMode_t>(M_IRUSR | M_IWUSR));
+    }
+    if (fd < 0) {
+      GELOGE(FAILED, "[Open][Shm] open %s failed, errno:%d", queue.shm_name.c_str(), mmGetErrorCode());
+      return FAILED;
+    }
+    if (created && (mmFtruncate(fd, static_cast<UINT32>(queue.map_size)) != EN_OK)) {
+      GELOGE(FAILED, "[Resize][Shm] resize %s to %zu failed, errno:%d", queue.shm_name.c_str(), queue.map_size,
+             mmGetErrorCode());
+      (void)mmClose(fd);
+      (void)mmShmUnlink(queue.shm_name.c_str());
+      return FAILED;
+    }
+    if (!created) {
+      // creator may not have finished resizing, wait for its size before mapping
+      mmStat_t shm_stat = {};
+      for (uint32_t i = 0U; (mmFStatGet(fd, &shm_stat) == EN_OK) &&
+                            (shm_stat.st_size < static_cast<off_t>(kHeaderSize)) && (i < kOpenRetryTimes); ++i) {
+        (void)mmSleep(1U);
+      }
+      queue.map_size = static_cast<size_t>(shm_stat.st_size);
+    }
+    void *const addr = (queue.map_size < kHeaderSize) ? nullptr
+        : mmMmap(fd, static_cast<mmSize_t>(queue.map_size), 0, &queue.map_extra, PROT_READ | PROT_WRITE, MAP_SHARED);
+    (void)mmClose(fd);
+    if ((addr == nullptr) || (addr == MAP_FAILED)) {
+      GELOGE(FAILED, "[Map][Shm] map %s of size %zu failed", queue.shm_name.c_str(), queue.map_size);
+      if (created) {
+        (void)mmShmUnlink(queue.shm_name.c_str());
+      }
+      return FAILED;
+    }
+    queue.header = static_cast<RingHeader *>(addr);
+    if (created) {
+      const Status ret = InitHeader(queue.header, max_msg_size_, min_depth, max_depth);
+      if (ret != SUCCESS) {
+        (void)mmMunMap(addr, static_cast<mmSize_t>(queue.map_size), &queue.map_extra);
+        (void)mmShmUnlink(queue.shm_name.c_str());
+      }
+      return ret;
+    }
+    for (uint32_t i = 0U; (__atomic_load_n(&queue.header->magic, __ATOMIC_ACQUIRE) != kRingMagic) &&
+                          (i < kOpenRetryTimes); ++i) {
+      (void)mmSleep(1U);
+    }
+    const RingHeader *const header = queue.header;
+    if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != kRingMagic) ||
+        (queue.map_size < (kHeaderSize + header->max_depth * SlotStride(header->slot_size)))) {
+      GELOGE(FAILED, "[Check][Shm] %s is not a valid local queue", queue.shm_name.c_str());
+      (void)mmMunMap(addr, static_cast<mmSize_t>(queue.map_size), &queue.map_extra);
+      return FAILED;
+    }
+    if ((header->min_depth != min_depth) || (header->max_depth != max_depth) ||
+        (header->slot_size != max_msg_size_)) {
+      GELOGE(PARAM_INVALID, "[Check][Param] local queue %s has depth [%u, %u] and slot size %zu, "
+             "attached with depth [%u, %u] and message size %zu", queue.shm_name.c_str(), header->min_depth,
+             header->max_depth, header->slot_size, min_depth, max_depth, max_msg_size_);
+      (void)mmMunMap(addr, static_cast<mmSize_t>(queue.map_size), &queue.map_extra);
+      return PARAM_INVALID;
+    }
+    RingLock lock(queue.header);
+    if (!lock.IsLocked()) {
+      (void)mmMunMap(addr, static_cast<mmSize_t>(queue.map_size), &queue.map_extra);
+      return FAILED;
+    }
+    ++queue.header->ref_count;
+    return SUCCESS;
+  }
+
+  static void Close(LocalQueue &queue) {
+    bool last = false;
+    {
+      RingLock lock(queue.header);
+      last = lock.IsLocked() && (--queue.header->ref_count == 0U);
+    }
+    (void)mmMunMap(queue.header, static_cast<mmSize_t>(queue.map_size), &queue.map_extra);
+    if (last) {
+      (void)mmShmUnlink(queue.shm_name.c_str());
+    }
+  }
+
+  // called with ring lock held
+  static void AdvanceHead(RingHeader *const header) {
+    while ((header->head < header->reserved_head) && (SlotOf(header, header->head)->state == kSlotFree)) {
+      ++header->head;
+    }
+  }
+
+  // called with ring lock held
+  static void AdvanceTail(RingHeader *const header) {
+    while ((header->tail < header->reserved_tail) && IsEnded(SlotOf(header, header->tail)->state)) {
+      ++header->tail;
+    }
+  }
+
+  // called with ring lock held, frees discarded slots at read position
+  static void SkipDiscarded(RingHeader *const header) {
+    bool skipped = false;
+    while ((header->reserved_head < header->tail) &&
+           (SlotOf(header, header->reserved_head)->state == kSlotDiscarded)) {
+      SlotOf(header, header->reserved_head++)->state = kSlotFree;
+      skipped = true;
+    }
+    if (skipped) {
+      AdvanceHead(header);
+      (void)pthread_cond_broadcast(&header->not_full);
+    }
+  }
+
+  // called with ring lock held: a slot a dead process was writing is discarded, one it was reading is freed
+  static void RecoverDeadSlots(RingHeader *const header) {
+    uint32_t recovered = 0U;
+    for (uint64_t sequence = header->head; sequence < header->reserved_tail; ++sequence) {
+      SlotHeader *const slot = SlotOf(header, sequence);
+      if (((slot->state == kSlotWriting) || (slot->state == kSlotReading)) && (!IsProcessAlive(slot->owner_pid))) {
+        GELOGW("Process %d died %s local queue slot %lu, give it up", slot->owner_pid,
+               (slot->state == kSlotWriting) ? "writing" : "reading", sequence);
+        slot->state = (slot->state == kSlotWriting) ? kSlotDiscarded : kSlotFree;
+        ++recovered;
+      }
+    }
+    if (recovered > 0U) {
+      AdvanceTail(header);
+      AdvanceHead(header);
+      (void)pthread_cond_broadcast(&header->not_empty);
+      (void)pthread_cond_broadcast(&header->not_full);
+    }
+  }
+
+  Status GetQueue(const uint32_t queue_id, LocalQueue &queue) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = queues_.find(queue_id);
+    if (it == queues_.end()) {
+      GELOGE(PARAM_INVALID, "[Check][Param] local queue %u does not exist", queue_id);
+      return PARAM_INVALID;
+    }
+    queue = it->second;
+    return SUCCESS;
+  }
+
+  static struct timespec DeadlineAfter(const int32_t timeout_ms) {
+    struct timespec deadline {};
+    (void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+    const int64_t nsec = deadline.tv_nsec + (static_cast<int64_t>(timeout_ms % 1000) * 1000000);
+    deadline.tv_sec += (timeout_ms / 1000) + (nsec / 1000000000);
+    deadline.tv_nsec = nsec % 1000000000;
+    return deadline;
+  }
+
+  static bool IsBefore(const struct timespec &lhs, const struct timespec &rhs) {
+    return (lhs.tv_sec != rhs.tv_sec) ? (lhs.tv_sec < rhs.tv_sec) : (lhs.tv_nsec < rhs.tv_nsec);
+  }
+
+  // waits in slices of kRecoverIntervalMs: a process that died writing or reading outside the lock never
+  // signals, so its slots are recovered between slices
+  template <typename Pred>
+  static Status Wait(RingLock &lock, RingHeader *const header, pthread_cond_t &cond, const int32_t timeout_ms,
+                     uint64_t &wait_num, uint64_t &wait_us, const Pred &ready) {
+    if (ready()) {
+      return SUCCESS;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const struct timespec deadline = DeadlineAfter((timeout_ms > 0) ? timeout_ms : 0);
+    bool timeout = false;
+    while ((!ready()) && (!timeout)) {
+      struct timespec slice_end = DeadlineAfter(kRecoverIntervalMs);
+      if ((timeout_ms > 0) && IsBefore(deadline, slice_end)) {
+        slice_end = deadline;
+      }
+      const int32_t ret = pthread_cond_timedwait(&cond, lock.Get(), &slice_end);
+      if (!lock.OnLocked(ret)) {
+        return FAILED;
+      }
+      if (ret == ETIMEDOUT) {
+        RecoverDeadSlots(header);
+        timeout = (timeout_ms > 0) && (slice_end.tv_sec == deadline.tv_sec) && (slice_end.tv_nsec == deadline.tv_nsec);
+      }
+    }
+    ++wait_num;
+    wait_us += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    return ready() ? SUCCESS : kWaitTimeout;
+  }
+
+  // called with ring lock held after an enqueue
+  static void AdaptDepth(RingHeader *const header, const uint32_t occupancy) {
+    if (header->max_depth == header->min_depth) {
+      return;
+    }
+    header->window_peak = std::max(header->window_peak, occupancy);
+    if (occupancy >= header->depth) {
+      ++header->window_full_waits;
+    }
+    if (++header->window_ops < kAdaptWindow) {
+      return;
+    }
+    // producer hit full depth in 1/8 of the window: double, queue stayed below half: shrink by one
+    if (((header->window_full_waits * 8U) >= kAdaptWindow) && (header->depth < header->max_depth)) {
+      header->depth = std::min(header->max_depth, header->depth * 2U);
+      ++header->stats.depth_grow_num;
+      (void)pthread_cond_broadcast(&header->not_full);
+    } else if (((header->window_peak * 2U) < header->depth) && (header->depth > header->min_depth)) {
+      --header->depth;
+      ++header->stats.depth_shrink_num;
+    }
+    header->stats.depth = header->depth;
+    header->window_ops = 0U;
+    header->window_full_waits = 0U;
+    header->window_peak = 0U;
+  }
+
+  template <typename ReadFunc>
+  Status DequeueWith(const int32_t device_id, const uint32_t queue_id, ControlInfo &control_info,
+                     const ReadFunc &read_func) {
+    (void)device_id;
+    LocalQueue queue;
+    GE_CHK_STATUS_RET_NOLOG(GetQueue(queue_id, queue));
+    RingHeader *const header = queue.header;
+    uint64_t sequence = 0UL;
+    {
+      RingLock lock(header);
+      GE_CHK_BOOL_RET_STATUS_NOLOG(lock.IsLocked(), FAILED);
+      const Status ret = Wait(lock, header, header->not_empty, control_info.timeout, header->stats.empty_wait_num,
+                              header->stats.empty_wait_us, [header]() {
+                                SkipDiscarded(header);
+                                return header->reserved_head < header->tail;
+                              });
+      if (ret != SUCCESS) {
+        return (ret == kWaitTimeout) ? static_cast<Status>(ACL_ERROR_RT_QUEUE_EMPTY) : ret;
+      }
+      sequence = header->reserved_head++;
+      SlotOf(header, sequence)->owner_pid = pid_;
+      SlotOf(header, sequence)->state = kSlotReading;
+    }
+    SlotHeader *const slot = SlotOf(header, sequence);
+    const Status ret = read_func(PayloadOf(slot), static_cast<size_t>(slot->size));
+    control_info.end_of_sequence_flag = (slot->end_of_sequence != 0U);
+    if ((control_info.msg_info != nullptr) && (slot->has_msg_info != 0U)) {
+      *control_info.msg_info = slot->msg_info;
+    }
+    {
+      RingLock lock(header);
+      GE_CHK_BOOL_RET_STATUS_NOLOG(lock.IsLocked(), FAILED);
+      slot->state = kSlotFree;
+      AdvanceHead(header);
+      ++header->stats.dequeue_num;
+      (void)pthread_cond_broadcast(&header->not_full);
+    }
+    return ret;
+  }
+
+  const size_t max_msg_size_;
+  const int32_t pid_;
+  std::mutex mutex_;
+  std::map<uint32_t, LocalQueue> queues_;
+  uint32_t next_queue_id_ = 0U;
+};
+}  // namespace ge
+#endif  // BASE_EXEC_RUNTIME_DEPLOY_LOCAL_EXCHANGE_SERVICE_H_
@@ -33,6 +33,7 @@
 #include "external/graph/tensor.h"
 #include "runtime/mem.h"
 #include "graph/manager/memory_manager.h"
+#include "graph/manager/var_index.h"
 #include "proto/var_manager.pb.h"
 #include "graph/ge_local_context.h"
 
@@ -92,8 +93,18 @@ class VarResource {
   explicit VarResource(const uint64_t session_id);
   ~VarResource();
 
+  // looked up by id, VarKey is only built when a variable is indexed
   ge::Status GetVarAddr(const std::string &var_name, const ge::GeTensorDesc &tensor_desc, uint8_t **const dev_ptr,
-                        rtMemType_t &memory_type) const;
+                        rtMemType_t &memory_type) const {
+    const VarId var_id = GetVarId(var_name, tensor_desc);
+    if (var_id == kInvalidVarId) {
+      GELOGE(FAILED, "[Check][Param] var %s of format %d and data type %d can't find in var_addr_mgr_map_",
+             var_name.c_str(), static_cast<int32_t>(tensor_desc.GetFormat()),
+             static_cast<int32_t>(tensor_desc.GetDataType()));
+      return FAILED;
+    }
+    return GetVarAddr(var_id, dev_ptr, memory_type);
+  }
 
   Status GetReuseAddr(const OpDescPtr &op_desc, uint8_t **const dev_ptr, rtMemType_t &memory_type) const;
 
@@ -107,6 +118,62 @@ class VarResource {
 
   ge::Status RenewCurVarDesc(const std::string &var_name, const ge::OpDescPtr &op_desc);
 
+  // id of variable saved by SaveVarAddr or SetVarAddr, kInvalidVarId if none. Variables saved since the last
+  // lookup are indexed first, so the caller holds the lock of the writers of var_addr_mgr_map_
+  VarId GetVarId(const std::string &var_name, const ge::GeTensorDesc &tensor_desc) const {
+    const VarId var_id = FindVarId(var_name, tensor_desc);
+    if (var_id != kInvalidVarId) {
+      return var_id;
+    }
+    SyncVarIndex();
+    return FindVarId(var_name, tensor_desc);
+  }
+
+  // id of indexed variable, kInvalidVarId if none. Takes the shared lock of var_index_ only and builds no VarKey
+  VarId FindVarId(const std::string &var_name, const ge::GeTensorDesc &tensor_desc) const {
+    const VarId var_id = var_index_.Find(var_name, static_cast<int32_t>(tensor_desc.GetFormat()),
+                                         static_cast<int32_t>(tensor_desc.GetDataType()));
+    return var_index_.Visit(var_id, [](const VarAddrMgr *const) {}) ? var_id : kInvalidVarId;
+  }
+
+  // calls visitor(var_id, var_name, const VarAddrMgr &) for every saved variable in id order, for serialization
+  // and data transfer walking all variables. The caller holds the lock of the writers of var_addr_mgr_map_
+  template <typename Visitor>
+  void ForEachVarAddr(Visitor &&visitor) const {
+    SyncVarIndex();
+    var_index_.ForEach([&visitor](const VarId var_id, const std::string &var_name,
+                                  const VarAddrMgr *const var_addr_mgr) {
+      visitor(var_id, var_name, *var_addr_mgr);
+    });
+  }
+
+  ge::Status GetVarAddr(const VarId var_id, uint8_t **const dev_ptr, rtMemType_t &memory_type) const {
+    if (dev_ptr == nullptr) {
+      GELOGE(FAILED, "[Check][Param] dev_ptr is null, var id:%u", var_id);
+      return FAILED;
+    }
+    const bool found = var_index_.Visit(var_id, [dev_ptr, &memory_type](const VarAddrMgr *const var_addr_mgr) {
+      *dev_ptr = const_cast<uint8_t *>(var_addr_mgr->address);
+      memory_type = var_addr_mgr->memory_type;
+    });
+    if (!found) {
+      GELOGD("var id %u has no address", var_id);
+      return FAILED;
+    }
+    return SUCCESS;
+  }
+
+  ge::Status GetVarDesc(const VarId var_id, ge::GeTensorDesc &tensor_desc) const {
+    const bool found = var_index_.Visit(var_id, [&tensor_desc](const VarAddrMgr *const var_addr_mgr) {
+      tensor_desc = var_addr_mgr->tensor_desc;
+    });
+    return found ? SUCCESS : FAILED;
+  }
+
+  void ReserveVarIndex(const size_t var_num) {
+    var_index_.Reserve(var_num);
+  }
+
   void SaveBroadCastInfo(const uint32_t graph_id, const VarBroadCastInfo &broad_cast_info);
 
   Status SetTransRoad(const std::string &var_name, const VarTransRoad &trans_road) {
@@ -135,7 +202,9 @@ class VarResource {
   Status SetAllocatedGraphId(const std::string &var_name, uint32_t graph_id);
   Status GetAllocatedGraphId(const std::string &var_name, uint32_t &graph_id) const;
 
-  bool IsVarExist(const std::string &var_name, const ge::GeTensorDesc &tensor_desc) const;
+  bool IsVarExist(const std::string &var_name, const ge::GeTensorDesc &tensor_desc) const {
+    return GetVarId(var_name, tensor_desc) != kInvalidVarId;
+  }
 
   bool IsVarExist(const std::string &var_name) const;
 
@@ -162,9 +231,34 @@ class VarResource {
   std::string GetBatchVarKeyName(const std::string &var_name) const;
   int32_t GetSizeByTensoDataType(const OpDescPtr &op_desc) const;
 
+  // indexes the records saved since the last sync. The key of a record is VarKey of its var name and tensor desc,
+  // so the var name is the key without the suffix VarKey adds for the desc
+  void SyncVarIndex() const {
+    if (indexed_var_num_ == var_addr_mgr_map_.size()) {
+      return;
+    }
+    for (const auto &it : var_addr_mgr_map_) {
+      const std::string suffix = VarKey("", it.second.tensor_desc);
+      if ((it.first.size() < suffix.size()) ||
+          (it.first.compare(it.first.size() - suffix.size(), suffix.size(), suffix) != 0)) {
+        GELOGW("Var key %s does not end with the key of its tensor desc, it is not indexed", it.first.c_str());
+        continue;
+      }
+      const VarId var_id = var_index_.Intern(it.first.substr(0U, it.first.size() - suffix.size()),
+                                             static_cast<int32_t>(it.second.tensor_desc.GetFormat()),
+                                             static_cast<int32_t>(it.second.tensor_desc.GetDataType()));
+      var_index_.Set(var_id, &it.second);
+    }
+    indexed_var_num_ = var_addr_mgr_map_.size();
+  }
+
   uint64_t session_id_;
   std::unordered_map<uint64_t, rtMemType_t> var_offset_map_;
   std::unordered_map<std::string, VarAddrMgr> var_addr_mgr_map_;
+  // records of var_addr_mgr_map_ by id, filled by SyncVarIndex. Records are never erased while the resource lives
+  // and node based map keeps the pointers valid across rehash, so writes to them are seen by lookups by id
+  mutable VarIndex<const VarAddrMgr *> var_index_;
+  mutable size_t indexed_var_num_ = 0U;
   std::unordered_map<std::string, ge::GeTensorDesc> cur_var_tensor_desc_map_;
   std::unordered_map<std::string, std::vector<TransNodeInfo>> var_to_trans_road_;
   std::map<std::string, uint32_t> var_names_to_changed_graph_id_;
@@ -241,10 +335,47 @@ class VarManager {
   Status SetVarAddr(const std::string &var_name, const GeTensorDesc &tensor_desc, const uint8_t *const dev_ptr,
                     const rtMemType_t memory_type, const OpDescPtr &op_desc);
 
+  // looked up by id, takes mutex_ only for the first lookup of a variable
   Status GetVarAddr(const std::string &var_name, const GeTensorDesc &tensor_desc, uint8_t *&dev_ptr,
-                    rtMemType_t &memory_type) const;
+                    rtMemType_t &memory_type) const {
+    if (GetVarAddr(GetVarId(var_name, tensor_desc), dev_ptr, memory_type) != SUCCESS) {
+      GELOGW("GetVarAddr fail, var_name:%s.", var_name.c_str());
+      return INTERNAL_ERROR;
+    }
+    return SUCCESS;
+  }
 
-  Status GetVarAddr(const std::string &var_name, const GeTensorDesc &tensor_desc, uint8_t *&dev_ptr) const;
+  Status GetVarAddr(const std::string &var_name, const GeTensorDesc &tensor_desc, uint8_t *&dev_ptr) const {
+    rtMemType_t memory_type = RT_MEMORY_HBM;
+    return GetVarAddr(var_name, tensor_desc, dev_ptr, memory_type);
+  }
+
+  // interned id of assigned variable, kInvalidVarId if not assigned. An indexed variable is found under the shared
+  // lock of the index only, mutex_ orders indexing of newly assigned variables with SetVarAddr and AssignVarMem
+  VarId GetVarId(const std::string &var_name, const GeTensorDesc &tensor_desc) const {
+    const std::shared_ptr<VarResource> var_resource = var_resource_;
+    if (var_resource == nullptr) {
+      GELOGW("VarManager has not been init.");
+      return kInvalidVarId;
+    }
+    const VarId var_id = var_resource->FindVarId(var_name, tensor_desc);
+    if (var_id != kInvalidVarId) {
+      return var_id;
+    }
+    const std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return var_resource->GetVarId(var_name, tensor_desc);
+  }
+
+  // takes the shared lock of the index only. var_resource_ is replaced by Init and Destory only, ids are valid
+  // between them and are not looked up across them
+  Status GetVarAddr(const VarId var_id, uint8_t *&dev_ptr, rtMemType_t &memory_type) const {
+    const std::shared_ptr<VarResource> var_resource = var_resource_;
+    if (var_resource == nullptr) {
+      GELOGW("VarManager has not been init.");
+      return INTERNAL_ERROR;
+    }
+    return var_resource->GetVarAddr(var_id, &dev_ptr, memory_type);
+  }
 
   Status SaveBroadCastInfo(const uint32_t graph_id, const VarBroadCastInfo &broad_cast_info);
 
@@ -307,7 +438,9 @@ class VarManager {
 
   int64_t GetVarMemSize(const rtMemType_t memory_type) const;
 
-  bool IsVarExist(const std::string &var_name, const ge::GeTensorDesc &tensor_desc) const;
+  bool IsVarExist(const std::string &var_name, const ge::GeTensorDesc &tensor_desc) const {
+    return GetVarId(var_name, tensor_desc) != kInvalidVarId;
+  }
 
   bool IsVarExist(const std::string &var_name) const;
 
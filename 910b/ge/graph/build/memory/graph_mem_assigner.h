@@ -20,6 +20,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 #include <vector>
@@ -93,6 +94,19 @@ class GraphMemoryAssigner {
   ///
   ge::Status AssignMemory();
 
+  ///
+  /// @ingroup ge_graph
+  /// @brief threads of memory assign, candidates of HybridMemAssigner, node sizes and the interval plan are handled
+  ///        concurrently on one pool kept for the whole build. 1 runs all of them in turn
+  ///
+  void SetAssignThreadNum(uint32_t thread_num) { assign_thread_num_ = (thread_num == 0U) ? 1U : thread_num; }
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief cache of plan kept between builds of the same graph for incremental assign, used with interval plan
+  ///
+  void SetIncrementalPlanCache(const std::shared_ptr<IncrementalMemPlanCache> &cache) { plan_cache_ = cache; }
+
   ///
   /// @ingroup ge_graph
   /// @brief assign variable attr to nodes,
@@ -233,9 +247,33 @@ class GraphMemoryAssigner {
                                          size_t matched_mem_offset,
                                          map<size_t, pair<NodePtr, vector<int64_t>>> &mem_block_visit_info);
 
+  ///
+  /// @ingroup ge_graph
+  /// @brief create the hybrid assigner of AssignMemory and run it, with the interval plan if it is selected by
+  ///        option ge.experiment.memoryPlanMode. It runs on the assign pool and with the plan cache set here
+  /// @param [out] mem_assigner assigner whose blocks and offsets are taken by AssignMemory
+  /// @return Status result of function
+  ///
+  ge::Status RunHybridMemAssigner(HybridMemAssignerPtr &mem_assigner) {
+    mem_assigner.reset(new (std::nothrow) HybridMemAssigner(compute_graph_));
+    GE_CHECK_NOTNULL(mem_assigner);
+    if ((assign_thread_num_ > 1U) && (assign_pool_ == nullptr)) {
+      // the caller thread works as well, so the pool needs one thread less
+      assign_pool_.reset(new (std::nothrow) ThreadPool(assign_thread_num_ - 1U));
+    }
+    mem_assigner->SetAssignThreadPool(assign_pool_.get(), assign_thread_num_);
+    mem_assigner->SetIncrementalPlanCache(plan_cache_);
+    GE_CHK_STATUS_RET(mem_assigner->AssignWithMemPlan(), "[Assign][Memory] failed, graph:%s",
+                      compute_graph_->GetName().c_str());
+    return SUCCESS;
+  }
+
   MemoryOffsetMap memory_offset_;
   ge::ComputeGraphPtr compute_graph_;
   HybridMemAssignerPtr mem_assigner_;
+  uint32_t assign_thread_num_ = kDefaultMemAssignThreadNum;
+  std::unique_ptr<ThreadPool> assign_pool_;
+  std::shared_ptr<IncrementalMemPlanCache> plan_cache_;
 };
 }  // namespace ge
 
@@ -18,15 +18,23 @@
 #define GE_GRAPH_BUILD_MEMORY_HYBRID_MEM_ASSIGNER_H_
 
 #include <memory>
+#include <new>
 #include "graph/build/memory/mem_assigner.h"
+#include "graph/build/memory/binary_block_mem_assigner.h"
 #include "graph/build/memory/block_mem_assigner.h"
+#include "graph/build/memory/interval_block_mem_plan.h"
+#include "graph/build/memory/incremental_mem_plan_cache.h"
+#include "graph/build/memory/max_block_mem_assigner.h"
+#include "graph/build/memory/parallel_mem_assign.h"
 #include "graph/compute_graph.h"
+#include "graph/ge_local_context.h"
 
 #include "framework/common/types.h"
 #include "framework/common/util.h"
 
 namespace ge {
 using BlockMemAssignerPtr = std::shared_ptr<BlockMemAssigner>;
+constexpr size_t kMemAssignCandidateNum = 2U;
 
 class BlockMemAssigner;
 
@@ -46,15 +54,143 @@ class HybridMemAssigner : public MemAssigner {
 
   BlockMemAssignerPtr GetPriorityAssinger() const { return priority_assigner_; }
 
+  ///
+  /// @ingroup GE
+  /// @brief Assign, then if option kOptionMemoryPlanMode is "interval" pack blocks of the priority assigner by life
+  ///        time and offset, other values keep the greedy plan. Entry of GraphMemoryAssigner::AssignMemory
+  /// @return Status result
+  ///
+  Status AssignWithMemPlan() {
+    GE_CHK_STATUS_RET_NOLOG((assign_pool_ != nullptr) ? AssignByCandidates() : Assign());
+    std::string mode;
+    if ((GetThreadLocalContext().GetOption(kOptionMemoryPlanMode, mode) != GRAPH_SUCCESS) ||
+        (mode != kMemoryPlanModeInterval)) {
+      return SUCCESS;
+    }
+    size_t mem_size = 0U;
+    for (const auto &it : mem_offsets_) {
+      mem_size += it.second;
+    }
+    return AssignMemoryByIntervalPlan(priority_assigner_, mem_size);
+  }
+
+  const MemPlanResult &GetIntervalPlanResult() const { return interval_plan_result_; }
+
+  ///
+  /// @ingroup GE
+  /// @brief run binary and max block assigners concurrently by RunMemAssignCandidates, and the steps of both and
+  ///        of the interval plan on pool as well. The plan does not depend on the thread num
+  /// @param [in] pool owned by the caller, nullptr runs Assign with the assigners in turn
+  ///
+  void SetAssignThreadPool(ThreadPool *const pool, const uint32_t thread_num) {
+    assign_pool_ = pool;
+    assign_thread_num_ = (thread_num == 0U) ? 1U : thread_num;
+  }
+
+  ///
+  /// @ingroup GE
+  /// @brief reuse offsets of unchanged blocks from the last build of the same graph, used with interval plan
+  ///
+  void SetIncrementalPlanCache(const std::shared_ptr<IncrementalMemPlanCache> &cache) { plan_cache_ = cache; }
+
  private:
   Status AssignMemory(std::unique_ptr<BlockMemAssigner> &block_assigner, size_t &mem_size);
 
+  // Assign with the binary and max assigners run as concurrent candidates, the binary one wins on equal size
+  Status AssignByCandidates() {
+    if (GraphUtils::GetRefMapping(compute_graph_, symbol_to_anchors_, anchor_to_symbol_) != GRAPH_SUCCESS) {
+      REPORT_CALL_ERROR("E19999", "Get ref-mapping for graph %s failed", compute_graph_->GetName().c_str());
+      GELOGE(FAILED, "[Get][RefMapping] for graph %s failed.", compute_graph_->GetName().c_str());
+      return FAILED;
+    }
+    std::vector<std::unique_ptr<BlockMemAssigner>> assigners(kMemAssignCandidateNum);
+    assigners[0U].reset(new (std::nothrow) BinaryBlockMemAssigner(compute_graph_, anchor_to_symbol_,
+                                                                  symbol_to_anchors_));
+    assigners[1U].reset(new (std::nothrow) MaxBlockMemAssigner(compute_graph_, anchor_to_symbol_,
+                                                               symbol_to_anchors_));
+    const char *const names[kMemAssignCandidateNum] = {"binary-block", "max-block"};
+    std::vector<MemAssignCandidate> candidates;
+    for (size_t i = 0U; i < kMemAssignCandidateNum; ++i) {
+      GE_CHECK_NOTNULL(assigners[i]);
+      assigners[i]->SetAssignThreadPool(assign_pool_, assign_thread_num_);
+      std::unique_ptr<BlockMemAssigner> &assigner = assigners[i];
+      candidates.emplace_back(MemAssignCandidate{names[i], [this, &assigner](size_t &mem_size) {
+        return AssignMemory(assigner, mem_size);
+      }});
+    }
+    size_t best_index = 0U;
+    std::vector<size_t> mem_sizes;
+    GE_CHK_STATUS_RET(RunMemAssignCandidates(candidates, assign_pool_, assign_thread_num_, best_index, mem_sizes),
+                      "[Assign][Memory] failed, graph:%s", compute_graph_->GetName().c_str());
+    GELOGD("Binary-block memory size:%zu, max-block memory size:%zu", mem_sizes[0U], mem_sizes[1U]);
+    priority_assigner_ = BlockMemAssignerPtr(assigners[best_index].release());
+    priority_assigner_->SetOpMemOffset(false);
+    mem_offsets_ = priority_assigner_->GetMemOffsets();
+    return SUCCESS;
+  }
+
+  // place blocks of priority assigner by IntervalMemPlanner, the plan is kept only if its peak is lower
+  Status AssignMemoryByIntervalPlan(const BlockMemAssignerPtr &block_assigner, size_t &mem_size) {
+    GE_CHECK_NOTNULL(block_assigner);
+    const std::vector<MemoryBlock *> blocks = block_assigner->GetMemoryBlocks();
+    std::vector<MemPlanInterval> intervals;
+    const Status ret = CollectBlockIntervals(blocks, block_assigner->GetAtomicAddrCleanId(), intervals);
+    if (ret == NOT_CHANGED) {
+      if (plan_cache_ != nullptr) {
+        plan_cache_->Clear();
+      }
+      return SUCCESS;
+    }
+    GE_CHK_STATUS_RET(ret, "[Collect][Intervals] failed, graph:%s", compute_graph_->GetName().c_str());
+    std::vector<std::string> keys;
+    if (plan_cache_ != nullptr) {
+      CollectBlockIntervalKeys(blocks, intervals, keys);
+      (void)plan_cache_->Prepare(intervals, keys);
+    }
+    MemPlanOptions options;
+    options.thread_num = assign_thread_num_;
+    options.pool = assign_pool_;
+    MemPlanResult result;
+    GE_CHK_STATUS_RET(IntervalMemPlanner::Plan(intervals, options, result),
+                      "[Plan][Memory] by interval failed, graph:%s", compute_graph_->GetName().c_str());
+    std::map<uint64_t, size_t> plan_offsets = mem_offsets_;
+    for (const auto &it : result.peak_sizes) {
+      plan_offsets[static_cast<uint64_t>(it.first)] = it.second;
+    }
+    size_t plan_size = 0U;
+    for (const auto &it : plan_offsets) {
+      plan_size += it.second;
+    }
+    GELOGI("Interval memory plan of graph %s, size:%zu, greedy size:%zu, cost:%lu us",
+           compute_graph_->GetName().c_str(), plan_size, mem_size, result.plan_time_us);
+    if (plan_size >= mem_size) {
+      // offsets of the greedy plan are not kept, the next build plans in full
+      if (plan_cache_ != nullptr) {
+        plan_cache_->Clear();
+      }
+      return SUCCESS;
+    }
+    if (plan_cache_ != nullptr) {
+      plan_cache_->Record(intervals, keys, result);
+    }
+    ApplyBlockIntervalPlan(blocks, result, mem_offsets_);
+    block_assigner->SetOpMemOffset(false);
+    interval_plan_result_ = std::move(result);
+    mem_size = plan_size;
+    return SUCCESS;
+  }
+
   std::map<uint64_t, size_t> mem_offsets_;
 
   ge::ComputeGraphPtr compute_graph_;
 
   BlockMemAssignerPtr priority_assigner_;
 
+  MemPlanResult interval_plan_result_;
+  std::shared_ptr<IncrementalMemPlanCache> plan_cache_;
+  ThreadPool *assign_pool_ = nullptr;
+  uint32_t assign_thread_num_ = 1U;
+
   std::map<std::string, std::string> anchor_to_symbol_;
   std::map<std::string, std::list<NodeIndexIO>> symbol_to_anchors_;
 };
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_BUILD_MEMORY_INTERVAL_BLOCK_MEM_PLAN_H_
+#define GE_GRAPH_BUILD_MEMORY_INTERVAL_BLOCK_MEM_PLAN_H_
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "graph/build/memory/block_mem_assigner.h"
+#include "graph/build/memory/interval_mem_planner.h"
+#include "graph/debug/ge_attr_define.h"
+#include "graph/utils/attr_utils.h"
+
+namespace ge {
+///
+/// @ingroup GE
+/// @brief Whether an output or workspace of a block is cleaned by the atomic clean node before its node runs
+///
+inline bool IsAtomicNodeTypeIndex(const NodeTypeIndex &node_type_index) {
+  if ((node_type_index.node == nullptr) || (node_type_index.node->GetOpDesc() == nullptr)) {
+    return false;
+  }
+  const OpDescPtr op_desc = node_type_index.node->GetOpDesc();
+  const int64_t index = static_cast<int64_t>(node_type_index.index);
+  if (node_type_index.mem_type == kOutput) {
+    std::vector<int64_t> atomic_output_indexes;
+    (void)AttrUtils::GetListInt(op_desc, ATOMIC_ATTR_OUTPUT_INDEX, atomic_output_indexes);
+    return std::find(atomic_output_indexes.begin(), atomic_output_indexes.end(), index) !=
+           atomic_output_indexes.end();
+  }
+  std::map<std::string, std::map<int64_t, int64_t>> atomic_workspace_info;
+  atomic_workspace_info = op_desc->TryGetExtAttr(EXT_ATTR_ATOMIC_WORKSPACE_INFO, atomic_workspace_info);
+  const auto it = atomic_workspace_info.find(op_desc->GetName());
+  return (it != atomic_workspace_info.end()) && (it->second.count(index) > 0U);
+}
+
+///
+/// @ingroup GE
+/// @brief Convert memory blocks of a block assigner to intervals, id of interval is index of block.
+///        Blocks from first to last continuous block form one group, a block used by several streams gets a stream
+///        of its own so that it is never shared across streams. Zero copy blocks are placed by SetOpMemOffset and
+///        are not collected. A block holding an atomic output or workspace is alive from the atomic clean node on.
+/// @param [in] atomic_addr_clean_id topo id of the atomic clean node, GetAtomicAddrCleanId of the block assigner
+/// @return SUCCESS, NOT_CHANGED if blocks have child blocks, which are placed by ReuseBlocksByLifeTime only
+///
+inline Status CollectBlockIntervals(const std::vector<MemoryBlock *> &blocks, const int64_t atomic_addr_clean_id,
+                                    std::vector<MemPlanInterval> &intervals) {
+  int64_t group = kNoMemPlanGroup;
+  int32_t group_index = 0;
+  for (size_t i = 0U; i < blocks.size(); ++i) {
+    MemoryBlock *const block = blocks[i];
+    if ((block == nullptr) || block->deleted_block_ || block->is_zero_copy_) {
+      continue;
+    }
+    if (!block->ChildBlockList().empty()) {
+      GELOGI("Block %zu has child blocks, interval memory plan is not applied", i);
+      return NOT_CHANGED;
+    }
+    if (block->first_continuous_block_) {
+      group = static_cast<int64_t>(i);
+      group_index = 0;
+    }
+    MemPlanInterval interval;
+    interval.id = static_cast<int64_t>(i);
+    interval.size = block->Size();
+    interval.life_begin = block->GetLifeBegin();
+    interval.life_end = std::max(interval.life_begin, block->GetLifeEnd());
+    interval.memory_type = block->memory_type_;
+    interval.stream_id = block->same_stream_ ? block->stream_id_ : (-1 - static_cast<int64_t>(i));
+    interval.group = group;
+    interval.group_index = group_index++;
+    interval.reuse = block->reuse_mem_ && (interval.life_end != kMaxLifeTime);
+    const std::vector<NodeTypeIndex> &node_type_indexes = block->NodeTypeIndexList();
+    if ((atomic_addr_clean_id >= 0) &&
+        std::any_of(node_type_indexes.begin(), node_type_indexes.end(), IsAtomicNodeTypeIndex)) {
+      interval.atomic_clean_time = static_cast<size_t>(atomic_addr_clean_id);
+    }
+    intervals.emplace_back(interval);
+    if (block->last_continuous_block_ || (!block->continuous_block_)) {
+      group = kNoMemPlanGroup;
+    }
+  }
+  return SUCCESS;
+}
+
+///
+/// @ingroup GE
+/// @brief Name of each interval for IncrementalMemPlanCache, from the first node output or workspace of its block,
+///        empty if the block has no node
+///
+inline void CollectBlockIntervalKeys(const std::vector<MemoryBlock *> &blocks,
+                                     const std::vector<MemPlanInterval> &intervals, std::vector<std::string> &keys) {
+  keys.clear();
+  keys.reserve(intervals.size());
+  for (const auto &interval : intervals) {
+    const std::vector<NodeTypeIndex> &node_type_indexes = blocks[static_cast<size_t>(interval.id)]->NodeTypeIndexList();
+    if (node_type_indexes.empty() || (node_type_indexes[0U].node == nullptr)) {
+      keys.emplace_back();  // block index is no identity across builds, the block is always placed again
+      continue;
+    }
+    const NodeTypeIndex &node_type_index = node_type_indexes[0U];
+    keys.emplace_back(node_type_index.node->GetName() + "_" + node_type_index.GetMemType() + "_" +
+                      std::to_string(node_type_index.index));
+  }
+}
+
+///
+/// @ingroup GE
+/// @brief Set head and tail offset of blocks by interval plan
+/// @param [in] blocks memory blocks the intervals are collected from
+/// @param [in] result plan of the intervals
+/// @param [out] mem_offsets memory type -> size, as GetMemOffsets of block assigner
+///
+inline void ApplyBlockIntervalPlan(const std::vector<MemoryBlock *> &blocks, const MemPlanResult &result,
+                                   std::map<uint64_t, size_t> &mem_offsets) {
+  for (const auto &it : result.offsets) {
+    MemoryBlock *const block = blocks[static_cast<size_t>(it.first)];
+    block->SetHeadOffset(it.second);
+    block->SetTailOffset(it.second + block->Size() - 1U);
+  }
+  for (const auto &it : result.peak_sizes) {
+    mem_offsets[static_cast<uint64_t>(it.first)] = it.second;
+  }
+}
+}  // namespace ge
+#endif  // GE_GRAPH_BUILD_MEMORY_INTERVAL_BLOCK_MEM_PLAN_H_
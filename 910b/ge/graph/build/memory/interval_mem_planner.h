@@ -0,0 +1,654 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_BUILD_MEMORY_INTERVAL_MEM_PLANNER_H_
+#define GE_GRAPH_BUILD_MEMORY_INTERVAL_MEM_PLANNER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <ostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/build/memory/parallel_mem_assign.h"
+
+namespace ge {
+const char *const kOptionMemoryPlanMode = "ge.experiment.memoryPlanMode";
+const char *const kMemoryPlanModeInterval = "interval";
+constexpr int64_t kNoMemPlanGroup = -1;
+constexpr size_t kNoMemPlanFixedOffset = SIZE_MAX;
+constexpr size_t kNoMemPlanCleanTime = SIZE_MAX;
+
+/**
+ * @ingroup GE
+ * @brief one buffer to be placed. Life time is closed [life_begin, life_end] in topo order of graph
+ */
+struct MemPlanInterval {
+  int64_t id = 0;
+  size_t size = 0U;
+  size_t life_begin = 0U;
+  size_t life_end = 0U;
+  int64_t memory_type = 0;
+  int64_t stream_id = 0;
+  // intervals of one group are placed back to back in group_index order, e.g. continuous inputs or atomic outputs
+  int64_t group = kNoMemPlanGroup;
+  int32_t group_index = 0;
+  bool reuse = true;  // false: live during the whole graph
+  size_t fixed_offset = kNoMemPlanFixedOffset;  // kept from a previous plan, other buffers are placed around it
+  // atomic buffer: cleared by the memset of the atomic clean node at this time, so it is alive from then on
+  size_t atomic_clean_time = kNoMemPlanCleanTime;
+};
+
+enum class MemPlanFit {
+  kBestFit,   // smallest gap that holds the buffer
+  kFirstFit   // lowest offset that holds the buffer
+};
+
+struct MemPlanOptions {
+  size_t align = 512U;
+  MemPlanFit fit = MemPlanFit::kBestFit;
+  // buffers of different streams never share memory unless their life times are ordered by the graph,
+  // set true only if life times are already widened across stream dependencies
+  bool cross_stream_reuse = false;
+  uint64_t improve_budget_ms = 0UL;  // time of randomized improvement per memory type, 0 for no time limit
+  uint64_t improve_rounds = 0UL;     // rounds of randomized improvement per memory type, 0 for no round limit
+  uint32_t seed = 0U;
+  // candidate orders and memory types are planned concurrently on pool. The result is the same as with 1 unless
+  // improve_budget_ms is set, rounds done within a time budget depend on the load of the host
+  uint32_t thread_num = 1U;
+  ThreadPool *pool = nullptr;  // nullptr plans in turn
+};
+
+struct MemPlanResult {
+  std::map<int64_t, size_t> offsets;      // id -> offset in its memory type
+  std::map<int64_t, size_t> peak_sizes;   // memory type -> size
+  std::map<int64_t, size_t> lower_bounds; // memory type -> max of live bytes at one time
+  uint64_t plan_time_us = 0UL;
+};
+
+/**
+ * @ingroup GE
+ * @brief place buffers with known life time into as little memory as possible, i.e. two dimension packing of
+ *        life time and offset. Buffers are placed greedily by size with best fit into gaps left by placed buffers
+ *        that are alive at the same time, then the order is perturbed within a round or time budget to lower the
+ *        peak. Improvement runs only if one of the budgets is set.
+ */
+class IntervalMemPlanner {
+ public:
+  static Status Plan(const std::vector<MemPlanInterval> &intervals, const MemPlanOptions &options,
+                     MemPlanResult &result) {
+    const auto start = std::chrono::steady_clock::now();
+    result = MemPlanResult();
+    if (options.align == 0U) {
+      GELOGE(PARAM_INVALID, "[Check][Param] align of memory plan is 0");
+      return PARAM_INVALID;
+    }
+    std::map<int64_t, std::vector<Item>> type_items;
+    GE_CHK_STATUS_RET_NOLOG(BuildItems(intervals, options, type_items));
+    std::vector<TypePlan> plans;
+    plans.reserve(type_items.size());
+    for (auto &it : type_items) {
+      TypePlan plan;
+      plan.memory_type = it.first;
+      plan.items = &it.second;
+      plan.fixed_num = ReleaseConflictingFixedItems(it.second, options);
+      plans.emplace_back(std::move(plan));
+    }
+    // with kept offsets only the changed items are placed, the first order is enough for them
+    std::vector<Candidate> candidates;
+    for (size_t i = 0U; i < plans.size(); ++i) {
+      const size_t order_num = (plans[i].fixed_num > 0U) ? 1U : kOrderNum;
+      for (size_t order = 0U; order < order_num; ++order) {
+        candidates.emplace_back(Candidate{i, order, SIZE_MAX, {}});
+      }
+    }
+    const auto place = [&candidates, &plans, &options](const size_t index) {
+      Candidate &candidate = candidates[index];
+      candidate.peak = PlaceInOrder(*plans[candidate.plan].items, candidate.order, options, candidate.offsets);
+      return SUCCESS;
+    };
+    (void)ParallelForEach(candidates.size(), options.pool, options.thread_num, place);
+    // merged in candidate order, an earlier order wins on equal peak whatever the thread num
+    for (auto &candidate : candidates) {
+      TypePlan &plan = plans[candidate.plan];
+      if (candidate.peak < plan.peak) {
+        plan.peak = candidate.peak;
+        plan.offsets.swap(candidate.offsets);
+      }
+    }
+    (void)ParallelForEach(plans.size(), options.pool, options.thread_num, [&plans, &options](const size_t index) {
+      TypePlan &plan = plans[index];
+      if (((options.improve_budget_ms > 0UL) || (options.improve_rounds > 0UL)) && (plan.fixed_num == 0U)) {
+        plan.peak = Improve(*plan.items, options, plan.peak, plan.offsets);
+      }
+      return SUCCESS;
+    });
+    for (const auto &plan : plans) {
+      const std::vector<Item> &items = *plan.items;
+      result.lower_bounds[plan.memory_type] = ComputeLowerBound(items);
+      result.peak_sizes[plan.memory_type] = items.empty() ? 0U : plan.peak;
+      for (size_t i = 0U; i < items.size(); ++i) {
+        size_t offset = plan.offsets[i];
+        for (const auto &member : items[i].members) {
+          result.offsets[member.first] = offset;
+          offset += member.second;
+        }
+      }
+      GELOGI("Interval memory plan of memory type %ld, item num:%zu, kept:%zu, peak:%zu, lower bound:%zu",
+             plan.memory_type, items.size(), plan.fixed_num, result.peak_sizes[plan.memory_type],
+             result.lower_bounds[plan.memory_type]);
+    }
+    result.plan_time_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    return SUCCESS;
+  }
+
+  /**
+   * @ingroup GE
+   * @brief check that no two buffers alive at the same time share memory, used to verify plans of any assigner.
+   *        Every interval must have an offset. Buffers are swept by offset, those covering one offset have to be
+   *        free of conflict with each other, so they are kept ordered by life begin and a new one is only checked
+   *        against its neighbour in life time
+   */
+  static bool Verify(const std::vector<MemPlanInterval> &intervals, const MemPlanOptions &options,
+                     const std::map<int64_t, size_t> &offsets) {
+    std::map<int64_t, std::vector<std::pair<size_t, size_t>>> type_spans;  // memory type -> offset, interval index
+    for (size_t i = 0U; i < intervals.size(); ++i) {
+      const auto offset = offsets.find(intervals[i].id);
+      if (offset == offsets.end()) {
+        GELOGW("Buffer %ld has no offset in memory plan", intervals[i].id);
+        return false;
+      }
+      if (intervals[i].size > 0U) {
+        type_spans[intervals[i].memory_type].emplace_back(offset->second, i);
+      }
+    }
+    using End = std::pair<size_t, size_t>;  // end of memory, life begin
+    for (auto &it : type_spans) {
+      std::vector<std::pair<size_t, size_t>> &spans = it.second;
+      std::sort(spans.begin(), spans.end());
+      std::map<size_t, size_t> active;  // life begin -> interval index, of buffers covering the current offset
+      std::priority_queue<End, std::vector<End>, std::greater<End>> ends;
+      for (const auto &span : spans) {
+        while ((!ends.empty()) && (ends.top().first <= span.first)) {
+          (void)active.erase(ends.top().second);
+          ends.pop();
+        }
+        const MemPlanInterval &interval = intervals[span.second];
+        const Item item = ToItem(interval, options);
+        if (!active.empty()) {
+          // any active one has the stream of all, the last one beginning before item ends has the latest end
+          const auto next = active.upper_bound(item.life_end);
+          size_t other = (next == active.begin()) ? active.begin()->second : std::prev(next)->second;
+          if (!Conflict(item, ToItem(intervals[other], options), options)) {
+            other = active.begin()->second;
+          }
+          if (Conflict(item, ToItem(intervals[other], options), options)) {
+            GELOGW("Buffer %ld and %ld overlap in memory plan", interval.id, intervals[other].id);
+            return false;
+          }
+        }
+        active[item.life_begin] = span.second;
+        ends.emplace(span.first + interval.size, item.life_begin);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @ingroup GE
+   * @brief life time table as text, one interval per line:
+   *        id size life_begin life_end memory_type stream_id group group_index reuse atomic_clean_time,
+   *        the last column is -1 for a buffer that is not atomic and may be left out
+   */
+  static void ExportTable(const std::vector<MemPlanInterval> &intervals, std::ostream &os) {
+    for (const auto &interval : intervals) {
+      os << interval.id << ' ' << interval.size << ' ' << interval.life_begin << ' ' << interval.life_end << ' '
+         << interval.memory_type << ' ' << interval.stream_id << ' ' << interval.group << ' ' << interval.group_index
+         << ' ' << (interval.reuse ? 1 : 0) << ' '
+         << ((interval.atomic_clean_time == kNoMemPlanCleanTime) ? -1 :
+             static_cast<int64_t>(interval.atomic_clean_time)) << '\n';
+    }
+  }
+
+  static Status ImportTable(std::istream &is, std::vector<MemPlanInterval> &intervals) {
+    std::string line;
+    size_t line_no = 0U;
+    while (std::getline(is, line)) {
+      ++line_no;
+      if (line.empty() || (line[0] == '#')) {
+        continue;
+      }
+      std::istringstream iss(line);
+      MemPlanInterval interval;
+      int32_t reuse = 1;
+      if (!(iss >> interval.id >> interval.size >> interval.life_begin >> interval.life_end >> interval.memory_type >>
+            interval.stream_id >> interval.group >> interval.group_index >> reuse)) {
+        GELOGE(PARAM_INVALID, "[Parse][Table] line %zu of life time table is invalid: %s", line_no, line.c_str());
+        return PARAM_INVALID;
+      }
+      interval.reuse = (reuse != 0);
+      int64_t atomic_clean_time = -1;
+      if ((iss >> atomic_clean_time) && (atomic_clean_time >= 0)) {
+        interval.atomic_clean_time = static_cast<size_t>(atomic_clean_time);
+      }
+      intervals.emplace_back(interval);
+    }
+    return SUCCESS;
+  }
+
+ private:
+  // a single buffer or a whole group of continuous buffers
+  struct Item {
+    size_t size;
+    size_t life_begin;
+    size_t life_end;
+    int64_t stream_id;
+    bool multi_stream;
+    std::vector<std::pair<int64_t, size_t>> members;  // id, aligned size
+    size_t fixed_offset;
+  };
+
+  struct TypePlan {
+    int64_t memory_type = 0;
+    std::vector<Item> *items = nullptr;
+    size_t fixed_num = 0U;
+    size_t peak = SIZE_MAX;
+    std::vector<size_t> offsets;
+  };
+
+  // one placement order of the items of one memory type
+  struct Candidate {
+    size_t plan;
+    size_t order;
+    size_t peak;
+    std::vector<size_t> offsets;
+  };
+
+  static constexpr size_t kOrderNum = 3U;
+
+  static size_t AlignUp(const size_t size, const size_t align) {
+    return ((size + align - 1U) / align) * align;
+  }
+
+  static Item ToItem(const MemPlanInterval &interval, const MemPlanOptions &options) {
+    const size_t aligned = AlignUp(interval.size, options.align);
+    return Item{aligned, interval.reuse ? std::min(interval.life_begin, interval.atomic_clean_time) : 0U,
+                interval.reuse ? interval.life_end : SIZE_MAX, interval.stream_id, false,
+                {std::make_pair(interval.id, aligned)}, interval.fixed_offset};
+  }
+
+  static Status BuildItems(const std::vector<MemPlanInterval> &intervals, const MemPlanOptions &options,
+                           std::map<int64_t, std::vector<Item>> &type_items) {
+    std::map<std::pair<int64_t, int64_t>, std::vector<const MemPlanInterval *>> groups;
+    for (const auto &interval : intervals) {
+      if (interval.life_begin > interval.life_end) {
+        GELOGE(PARAM_INVALID, "[Check][Param] buffer %ld life begin %zu is after life end %zu", interval.id,
+               interval.life_begin, interval.life_end);
+        return PARAM_INVALID;
+      }
+      if (interval.group == kNoMemPlanGroup) {
+        type_items[interval.memory_type].emplace_back(ToItem(interval, options));
+      } else {
+        groups[std::make_pair(interval.memory_type, interval.group)].emplace_back(&interval);
+      }
+    }
+    for (auto &group : groups) {
+      std::vector<const MemPlanInterval *> &members = group.second;
+      std::stable_sort(members.begin(), members.end(), [](const MemPlanInterval *lhs, const MemPlanInterval *rhs) {
+        return lhs->group_index < rhs->group_index;
+      });
+      Item item = ToItem(*members[0U], options);
+      item.members.clear();
+      item.size = 0U;
+      for (const auto member : members) {
+        const Item member_item = ToItem(*member, options);
+        item.size += member_item.size;
+        item.life_begin = std::min(item.life_begin, member_item.life_begin);
+        item.life_end = std::max(item.life_end, member_item.life_end);
+        item.multi_stream = item.multi_stream || (member->stream_id != item.stream_id);
+        // a group keeps its offset only if all members are kept back to back
+        if ((item.fixed_offset != kNoMemPlanFixedOffset) &&
+            (member->fixed_offset != (item.fixed_offset + item.size - member_item.size))) {
+          item.fixed_offset = kNoMemPlanFixedOffset;
+        }
+        item.members.emplace_back(member_item.members[0U]);
+      }
+      type_items[group.first.first].emplace_back(std::move(item));
+    }
+    return SUCCESS;
+  }
+
+  static bool Conflict(const Item &lhs, const Item &rhs, const MemPlanOptions &options) {
+    if ((!options.cross_stream_reuse) && (lhs.multi_stream || rhs.multi_stream || (lhs.stream_id != rhs.stream_id))) {
+      return true;
+    }
+    return (lhs.life_begin <= rhs.life_end) && (rhs.life_begin <= lhs.life_end);
+  }
+
+  static size_t ComputeLowerBound(const std::vector<Item> &items) {
+    std::vector<std::pair<size_t, int64_t>> events;  // time, +size at begin / -size after end
+    events.reserve(items.size() * 2U);
+    for (const auto &item : items) {
+      events.emplace_back(item.life_begin, static_cast<int64_t>(item.size));
+      if (item.life_end != SIZE_MAX) {
+        events.emplace_back(item.life_end + 1U, -static_cast<int64_t>(item.size));
+      }
+    }
+    std::sort(events.begin(), events.end());
+    int64_t live = 0;
+    int64_t max_live = 0;
+    for (const auto &event : events) {
+      live += event.second;
+      max_live = std::max(max_live, live);
+    }
+    return static_cast<size_t>(max_live);
+  }
+
+  // placed items that conflict with the one being placed. Items of one stream are found by life time in
+  // O((k + 1) log n), items of other streams conflict whatever their life time and are only kept as merged offset
+  // ranges. Items that share a stream with no other item conflict with all, they go to ranges seen by every item
+  class ConflictIndex {
+   public:
+    ConflictIndex(const std::vector<Item> &items, const MemPlanOptions &options)
+        : items_(items), cross_stream_reuse_(options.cross_stream_reuse),
+          bucket_of_(items.size(), static_cast<size_t>(kExclusive)), position_(items.size(), 0U) {
+      std::map<int64_t, std::vector<size_t>> streams;
+      for (size_t i = 0U; i < items.size(); ++i) {
+        if (cross_stream_reuse_) {
+          streams[0].emplace_back(i);
+        } else if (!items[i].multi_stream) {
+          streams[items[i].stream_id].emplace_back(i);
+        }
+      }
+      for (auto &stream : streams) {
+        std::vector<size_t> &indexes = stream.second;
+        if (indexes.size() < 2U) {
+          continue;
+        }
+        std::stable_sort(indexes.begin(), indexes.end(), [&items](const size_t lhs, const size_t rhs) {
+          return items[lhs].life_begin < items[rhs].life_begin;
+        });
+        Bucket bucket;
+        bucket.begins.reserve(indexes.size());
+        for (size_t pos = 0U; pos < indexes.size(); ++pos) {
+          bucket_of_[indexes[pos]] = buckets_.size();
+          position_[indexes[pos]] = pos;
+          bucket.begins.emplace_back(items[indexes[pos]].life_begin);
+        }
+        bucket.leaf_num = 1U;
+        while (bucket.leaf_num < indexes.size()) {
+          bucket.leaf_num <<= 1U;
+        }
+        bucket.max_ends.assign(bucket.leaf_num * 2U, 0U);
+        bucket.indexes.swap(indexes);
+        buckets_.emplace_back(std::move(bucket));
+      }
+    }
+
+    void Add(const size_t index, const size_t offset) {
+      const Item &item = items_[index];
+      if (bucket_of_[index] == kExclusive) {
+        AddRange(exclusive_ranges_, offset, offset + item.size);
+        return;
+      }
+      Bucket &bucket = buckets_[bucket_of_[index]];
+      // life end + 1 so that 0 marks a leaf not placed yet
+      size_t node = bucket.leaf_num + position_[index];
+      bucket.max_ends[node] = (item.life_end == SIZE_MAX) ? SIZE_MAX : (item.life_end + 1U);
+      for (node >>= 1U; node > 0U; node >>= 1U) {
+        bucket.max_ends[node] = std::max(bucket.max_ends[node * 2U], bucket.max_ends[(node * 2U) + 1U]);
+      }
+      if (!cross_stream_reuse_) {
+        AddRange(bucket.ranges, offset, offset + item.size);
+      }
+    }
+
+    void Collect(const size_t index, const std::vector<size_t> &offsets,
+                 std::vector<std::pair<size_t, size_t>> &busy) const {
+      busy.assign(exclusive_ranges_.begin(), exclusive_ranges_.end());
+      const size_t own = bucket_of_[index];
+      for (size_t i = 0U; (!cross_stream_reuse_) && (i < buckets_.size()); ++i) {
+        if (i != own) {
+          busy.insert(busy.end(), buckets_[i].ranges.begin(), buckets_[i].ranges.end());
+        }
+      }
+      if (own != kExclusive) {
+        const Bucket &bucket = buckets_[own];
+        const Item &item = items_[index];
+        const size_t begin_num = static_cast<size_t>(
+            std::upper_bound(bucket.begins.begin(), bucket.begins.end(), item.life_end) - bucket.begins.begin());
+        CollectAlive(bucket, 1U, 0U, bucket.leaf_num, begin_num, item.life_begin, offsets, busy);
+      }
+      std::sort(busy.begin(), busy.end());
+    }
+
+   private:
+    struct Bucket {
+      std::vector<size_t> indexes;   // items of the stream in order of life begin
+      std::vector<size_t> begins;
+      size_t leaf_num = 0U;
+      std::vector<size_t> max_ends;  // max of life end + 1 over placed items, 1 is the root
+      std::map<size_t, size_t> ranges;
+    };
+
+    static constexpr size_t kExclusive = SIZE_MAX;
+
+    // offset -> end, ranges touching each other are merged
+    static void AddRange(std::map<size_t, size_t> &ranges, size_t begin, size_t end) {
+      if (begin == end) {
+        return;
+      }
+      auto it = ranges.upper_bound(begin);
+      if ((it != ranges.begin()) && (std::prev(it)->second >= begin)) {
+        --it;
+        begin = it->first;
+        end = std::max(end, it->second);
+        it = ranges.erase(it);
+      }
+      while ((it != ranges.end()) && (it->first <= end)) {
+        end = std::max(end, it->second);
+        it = ranges.erase(it);
+      }
+      ranges[begin] = end;
+    }
+
+    // placed items among the first begin_num by life begin whose life ends at or after life_begin
+    void CollectAlive(const Bucket &bucket, const size_t node, const size_t lo, const size_t hi,
+                      const size_t begin_num, const size_t life_begin, const std::vector<size_t> &offsets,
+                      std::vector<std::pair<size_t, size_t>> &busy) const {
+      if ((lo >= begin_num) || (bucket.max_ends[node] <= life_begin)) {
+        return;
+      }
+      if ((hi - lo) == 1U) {
+        const size_t other = bucket.indexes[lo];
+        busy.emplace_back(offsets[other], offsets[other] + items_[other].size);
+        return;
+      }
+      const size_t mid = lo + ((hi - lo) / 2U);
+      CollectAlive(bucket, node * 2U, lo, mid, begin_num, life_begin, offsets, busy);
+      CollectAlive(bucket, (node * 2U) + 1U, mid, hi, begin_num, life_begin, offsets, busy);
+    }
+
+    const std::vector<Item> &items_;
+    bool cross_stream_reuse_;
+    std::vector<size_t> bucket_of_;
+    std::vector<size_t> position_;
+    std::vector<Bucket> buckets_;
+    std::map<size_t, size_t> exclusive_ranges_;
+  };
+
+  static size_t Place(const std::vector<Item> &items, const std::vector<size_t> &order, const MemPlanOptions &options,
+                      std::vector<size_t> &offsets) {
+    offsets.assign(items.size(), 0U);
+    ConflictIndex placed(items, options);
+    std::vector<std::pair<size_t, size_t>> busy;  // offset, end of conflicting placed items
+    size_t peak = 0U;
+    for (const size_t index : order) {
+      if (items[index].fixed_offset != kNoMemPlanFixedOffset) {
+        offsets[index] = items[index].fixed_offset;
+        peak = std::max(peak, offsets[index] + items[index].size);
+        placed.Add(index, offsets[index]);
+      }
+    }
+    for (const size_t index : order) {
+      const Item &item = items[index];
+      if (item.fixed_offset != kNoMemPlanFixedOffset) {
+        continue;
+      }
+      placed.Collect(index, offsets, busy);
+      size_t best_offset = SIZE_MAX;
+      size_t best_gap = SIZE_MAX;
+      size_t cursor = 0U;
+      for (const auto &range : busy) {
+        if ((range.first > cursor) && ((range.first - cursor) >= item.size)) {
+          const size_t gap = range.first - cursor;
+          if (options.fit == MemPlanFit::kFirstFit) {
+            best_offset = cursor;
+            break;
+          }
+          if (gap < best_gap) {
+            best_gap = gap;
+            best_offset = cursor;
+          }
+        }
+        cursor = std::max(cursor, range.second);
+      }
+      offsets[index] = (best_offset == SIZE_MAX) ? cursor : best_offset;
+      peak = std::max(peak, offsets[index] + item.size);
+      placed.Add(index, offsets[index]);
+    }
+    return peak;
+  }
+
+  static size_t PlaceInOrder(const std::vector<Item> &items, const size_t order_index, const MemPlanOptions &options,
+                             std::vector<size_t> &offsets) {
+    using Less = bool (*)(const Item &, const Item &);
+    const Less kOrders[kOrderNum] = {
+        [](const Item &lhs, const Item &rhs) {
+          return (lhs.size != rhs.size) ? (lhs.size > rhs.size) : (lhs.life_begin < rhs.life_begin);
+        },
+        [](const Item &lhs, const Item &rhs) {
+          const size_t lhs_life = (lhs.life_end == SIZE_MAX) ? SIZE_MAX : (lhs.life_end - lhs.life_begin + 1U);
+          const size_t rhs_life = (rhs.life_end == SIZE_MAX) ? SIZE_MAX : (rhs.life_end - rhs.life_begin + 1U);
+          return (lhs_life != rhs_life) ? (lhs_life > rhs_life) : (lhs.size > rhs.size);
+        },
+        [](const Item &lhs, const Item &rhs) {
+          return (lhs.life_begin != rhs.life_begin) ? (lhs.life_begin < rhs.life_begin) : (lhs.size > rhs.size);
+        },
+    };
+    const Less less = kOrders[order_index % kOrderNum];
+    std::vector<size_t> order(items.size());
+    for (size_t i = 0U; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&items, less](const size_t lhs, const size_t rhs) {
+      return less(items[lhs], items[rhs]);
+    });
+    return Place(items, order, options, offsets);
+  }
+
+  // kept offsets come from an older plan, whose life times may differ. Walk them by offset and release the ones
+  // that overlap a kept item they now conflict with, those are placed again like changed items
+  static size_t ReleaseConflictingFixedItems(std::vector<Item> &items, const MemPlanOptions &options) {
+    std::vector<size_t> fixed;
+    for (size_t i = 0U; i < items.size(); ++i) {
+      if (items[i].fixed_offset != kNoMemPlanFixedOffset) {
+        fixed.emplace_back(i);
+      }
+    }
+    std::sort(fixed.begin(), fixed.end(), [&items](const size_t lhs, const size_t rhs) {
+      return (items[lhs].fixed_offset != items[rhs].fixed_offset) ?
+             (items[lhs].fixed_offset < items[rhs].fixed_offset) : (lhs < rhs);
+    });
+    std::vector<size_t> active;  // kept items that cover the offset of the current one
+    size_t kept = 0U;
+    for (const size_t index : fixed) {
+      Item &item = items[index];
+      (void)active.erase(std::remove_if(active.begin(), active.end(), [&items, &item](const size_t other) {
+        return (items[other].fixed_offset + items[other].size) <= item.fixed_offset;
+      }), active.end());
+      const bool conflict = std::any_of(active.begin(), active.end(), [&items, &item, &options](const size_t other) {
+        return Conflict(item, items[other], options);
+      });
+      if (conflict) {
+        item.fixed_offset = kNoMemPlanFixedOffset;
+        continue;
+      }
+      active.emplace_back(index);
+      ++kept;
+    }
+    if (kept < fixed.size()) {
+      GELOGI("Interval memory plan releases %zu of %zu kept offsets whose life time changed", fixed.size() - kept,
+             fixed.size());
+    }
+    return kept;
+  }
+
+  // hill climbing on placement order: move one item forward in order of its offset in the best plan.
+  // Each memory type gets the whole budget, so an early type never starves the later ones. With only a round budget
+  // the result depends on the seed alone
+  static size_t Improve(const std::vector<Item> &items, const MemPlanOptions &options, size_t best_peak,
+                        std::vector<size_t> &best_offsets) {
+    if (items.size() < 2U) {
+      return best_peak;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.improve_budget_ms);
+    const bool timed = (options.improve_budget_ms > 0UL);
+    std::vector<size_t> order(items.size());
+    for (size_t i = 0U; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&best_offsets](const size_t lhs, const size_t rhs) {
+      return best_offsets[lhs] < best_offsets[rhs];
+    });
+    std::mt19937 rng(options.seed);
+    std::vector<size_t> offsets;
+    uint64_t round = 0UL;
+    while (((options.improve_rounds == 0UL) || (round < options.improve_rounds)) &&
+           ((!timed) || (std::chrono::steady_clock::now() < deadline))) {
+      std::vector<size_t> candidate = order;
+      const size_t from = rng() % candidate.size();
+      const size_t to = rng() % candidate.size();
+      const size_t moved = candidate[from];
+      (void)candidate.erase(candidate.begin() + static_cast<std::ptrdiff_t>(from));
+      (void)candidate.insert(candidate.begin() + static_cast<std::ptrdiff_t>(to), moved);
+      const size_t peak = Place(items, candidate, options, offsets);
+      if (peak <= best_peak) {
+        best_peak = peak;
+        best_offsets = offsets;
+        order.swap(candidate);
+      }
+      ++round;
+    }
+    GELOGD("Interval memory plan improved in %lu rounds, peak:%zu", round, best_peak);
+    return best_peak;
+  }
+};
+}  // namespace ge
+#endif  // GE_GRAPH_BUILD_MEMORY_INTERVAL_MEM_PLANNER_H_
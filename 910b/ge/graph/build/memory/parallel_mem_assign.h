@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_BUILD_MEMORY_PARALLEL_MEM_ASSIGN_H_
+#define GE_GRAPH_BUILD_MEMORY_PARALLEL_MEM_ASSIGN_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/ge/ge_util.h"
+#include "common/thread_pool.h"
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace ge {
+constexpr uint32_t kDefaultMemAssignThreadNum = 4U;
+
+///
+/// @ingroup GE
+/// @brief call func(0) ... func(num - 1) on pool and the caller thread, results are written by index so merge
+///        order is fixed. The caller takes indexes as well and only waits for indexes taken by running workers,
+///        so func may call it again with the same pool without waiting for a worker that never gets free
+/// @param [in] pool shared by the memory assign steps of one build, nullptr runs func in turn
+/// @param [in] thread_num threads used at most, caller included, 1 runs func in turn
+/// @return first failed status in index order
+///
+inline Status ParallelForEach(const size_t num, ThreadPool *const pool, const uint32_t thread_num,
+                              const std::function<Status(size_t)> &func) {
+  if ((pool == nullptr) || (num <= 1U) || (thread_num <= 1U)) {
+    for (size_t i = 0U; i < num; ++i) {
+      GE_CHK_STATUS_RET_NOLOG(func(i));
+    }
+    return SUCCESS;
+  }
+  struct Shared {
+    const std::function<Status(size_t)> *func;
+    size_t num;
+    std::atomic<size_t> next;
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t done;
+    std::vector<Status> rets;
+  };
+  const std::shared_ptr<Shared> shared = MakeShared<Shared>();
+  GE_CHECK_NOTNULL(shared);
+  shared->func = &func;
+  shared->num = num;
+  shared->next = 0U;
+  shared->done = 0U;
+  shared->rets.assign(num, SUCCESS);
+  // a worker starting after all indexes are taken leaves without touching func, which may be gone by then
+  const auto run = [](const std::shared_ptr<Shared> &state) {
+    for (size_t index = state->next.fetch_add(1U); index < state->num; index = state->next.fetch_add(1U)) {
+      const Status ret = (*state->func)(index);
+      const std::lock_guard<std::mutex> lock(state->mutex);
+      state->rets[index] = ret;
+      if (++state->done == state->num) {
+        state->finished.notify_all();
+      }
+    }
+  };
+  const size_t helper_num = std::min(static_cast<size_t>(thread_num), num) - 1U;
+  for (size_t i = 0U; i < helper_num; ++i) {
+    (void)pool->commit(run, shared);
+  }
+  run(shared);
+  std::unique_lock<std::mutex> lock(shared->mutex);
+  shared->finished.wait(lock, [&shared]() { return shared->done == shared->num; });
+  for (const Status ret : shared->rets) {
+    GE_CHK_STATUS_RET_NOLOG(ret);
+  }
+  return SUCCESS;
+}
+
+struct MemAssignCandidate {
+  std::string name;
+  std::function<Status(size_t &mem_size)> assign;
+};
+
+///
+/// @ingroup GE
+/// @brief run candidate assigners concurrently, each one must own its state
+/// @param [out] best_index candidate with least memory, earlier one wins on equal size
+/// @param [out] mem_sizes memory size of each candidate, SIZE_MAX if it failed
+/// @return SUCCESS if any candidate succeeded
+///
+inline Status RunMemAssignCandidates(const std::vector<MemAssignCandidate> &candidates, ThreadPool *const pool,
+                                     const uint32_t thread_num, size_t &best_index, std::vector<size_t> &mem_sizes) {
+  mem_sizes.assign(candidates.size(), SIZE_MAX);
+  (void)ParallelForEach(candidates.size(), pool, thread_num, [&candidates, &mem_sizes](const size_t index) {
+    size_t mem_size = 0U;
+    const Status ret = candidates[index].assign(mem_size);
+    if (ret != SUCCESS) {
+      GELOGW("Memory assign candidate %s failed, ret:%u", candidates[index].name.c_str(), ret);
+      return ret;
+    }
+    mem_sizes[index] = mem_size;
+    GELOGI("Memory assign candidate %s needs %zu bytes", candidates[index].name.c_str(), mem_size);
+    return SUCCESS;
+  });
+  best_index = candidates.size();
+  for (size_t i = 0U; i < candidates.size(); ++i) {
+    if ((mem_sizes[i] != SIZE_MAX) && ((best_index == candidates.size()) || (mem_sizes[i] < mem_sizes[best_index]))) {
+      best_index = i;
+    }
+  }
+  if (best_index == candidates.size()) {
+    GELOGE(FAILED, "[Check][Param] all %zu memory assign candidates failed", candidates.size());
+    return FAILED;
+  }
+  return SUCCESS;
+}
+}  // namespace ge
+#endif  // GE_GRAPH_BUILD_MEMORY_PARALLEL_MEM_ASSIGN_H_
@@ -23,19 +23,25 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "framework/common/debug/log.h"
 #include "framework/common/op/ge_op_utils.h"
 #include "common/tbe_kernel_store.h"
 #include "common/cust_aicpu_kernel_store.h"
 #include "framework/common/types.h"
 #include "framework/common/util.h"
+#include "graph/build/weight_dedup.h"
 #include "graph/compute_graph.h"
 #include "graph/manager/graph_manager_utils.h"
 #include "graph/model.h"
 #include "graph/node.h"
+#include "graph/utils/op_desc_utils.h"
+#include "graph/utils/tensor_utils.h"
 #include "common/model/ge_model.h"
 #include "framework/omg/omg_inner_types.h"
 
 namespace ge {
+constexpr size_t kWeightDedupAlign = 512U;
+
 class ModelBuilder {
  public:
   ModelBuilder(uint64_t session_id, ge::ComputeGraphPtr whole_graph, const Graph2SubGraphInfoList &subgraphs,
@@ -57,6 +63,13 @@ class ModelBuilder {
 
   Status MergeWeights();
 
+  ///
+  /// @ingroup ge_graph
+  /// @brief store const weights with the same bytes once, defaults to option kOptionShareConstWeight
+  ///
+  void SetShareWeights(bool share_weights) { share_weights_ = share_weights; }
+  const WeightDedupStatistics &GetWeightDedupStatistics() const { return weight_dedup_.GetStatistics(); }
+
  protected:
   void AddNodeInputProperty();
 
@@ -73,6 +86,69 @@ class ModelBuilder {
 
   Status AdjustConstWeightSize(const ge::NodePtr &node, size_t &mem_offset);
 
+  // weight offset of const node, shared by equal weights if share_weights_ is set. mem_offset is the end of
+  // the weight buffer either way, so the buffer size and the offsets merged into it stay consistent.
+  // SetInputOutputDesc calls it for every node in place of AdjustConstWeightSize
+  Status AdjustConstWeight(const ge::NodePtr &node, size_t &mem_offset) {
+    if (!share_weights_) {
+      return AdjustConstWeightSize(node, mem_offset);
+    }
+    return AdjustSharedConstWeight(node, mem_offset);
+  }
+
+  // offset of const weight from weight_dedup_, equal weights share one offset
+  Status AdjustSharedConstWeight(const ge::NodePtr &node, size_t &mem_offset) {
+    GE_CHECK_NOTNULL(node);
+    if (node->GetType() != CONSTANT) {
+      return SUCCESS;
+    }
+    const std::vector<GeTensorPtr> weights = OpDescUtils::MutableWeights(node);
+    if (weights.empty()) {
+      REPORT_INNER_ERROR("E19999", "Check weights size of node %s(%s) is empty", node->GetName().c_str(),
+                         node->GetType().c_str());
+      GELOGE(FAILED, "[Check][Param] weights size of node %s is empty", node->GetName().c_str());
+      return FAILED;
+    }
+    const GeTensorPtr &weight = weights[0U];
+    GE_CHECK_NOTNULL(weight);
+    if (weight_dedup_.GetStatistics().weight_num == 0U) {
+      shared_weight_base_ = mem_offset;
+    }
+    size_t offset = 0U;
+    bool reused = false;
+    GE_CHK_STATUS_RET(weight_dedup_.Add(weight->GetData().data(), weight->GetData().size(), offset, reused),
+                      "[Add][Weight] of node %s failed", node->GetName().c_str());
+    TensorUtils::SetDataOffset(weight->MutableTensorDesc(), static_cast<int64_t>(shared_weight_base_ + offset));
+    mem_offset = shared_weight_base_ + weight_dedup_.GetStatistics().unique_size;
+    GELOGD("Const node %s weight size:%zu, offset:%zu, reused:%d", node->GetName().c_str(),
+           weight->GetData().size(), shared_weight_base_ + offset, static_cast<int32_t>(reused));
+    return SUCCESS;
+  }
+
+  // copy each weight laid out by AdjustSharedConstWeight once into weight_buffer_, MergeWeights calls it in place
+  // of the copy per const node when share_weights_ is set
+  Status MergeSharedWeights() {
+    const WeightDedupStatistics &statistics = weight_dedup_.GetStatistics();
+    const size_t weight_end = shared_weight_base_ + statistics.unique_size;
+    if (statistics.weight_num == 0U) {
+      return SUCCESS;
+    }
+    if (weight_buffer_.GetSize() < weight_end) {
+      REPORT_INNER_ERROR("E19999", "weight buffer size %zu is less than shared weight end %zu",
+                         weight_buffer_.GetSize(), weight_end);
+      GELOGE(INTERNAL_ERROR, "[Check][Param] weight buffer size %zu is less than shared weight end %zu",
+             weight_buffer_.GetSize(), weight_end);
+      return INTERNAL_ERROR;
+    }
+    GE_CHK_STATUS_RET(weight_dedup_.Merge(weight_buffer_.GetData() + shared_weight_base_,
+                                          weight_buffer_.GetSize() - shared_weight_base_),
+                      "[Merge][Weights] of graph %s failed", compute_graph_->GetName().c_str());
+    GELOGI("Graph %s shares const weights, weight num:%zu, reused:%zu, size before:%zu, after:%zu",
+           compute_graph_->GetName().c_str(), statistics.weight_num, statistics.reused_num, statistics.total_size,
+           statistics.unique_size);
+    return SUCCESS;
+  }
+
   Status SetInputOutputDesc();
 
   Status AdjustInputTensorFlag();
@@ -123,6 +199,10 @@ class ModelBuilder {
   uint8_t platform_type_;
   bool is_loop_graph_;
   bool is_l1_fusion_enable_;
+
+  bool share_weights_ = IsShareConstWeightEnabled();
+  WeightDeduplicator weight_dedup_{kWeightDedupAlign};
+  size_t shared_weight_base_ = 0U;  // weight offset of the first shared weight
 };
 }  // namespace ge
 #endif  // GE_GRAPH_BUILD_MODEL_BUILDER_H_
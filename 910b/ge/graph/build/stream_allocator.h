@@ -23,7 +23,9 @@
 #include <utility>
 #include <vector>
 #include "engine_manager/dnnengine_manager.h"
+#include "framework/common/debug/log.h"
 #include "framework/common/ge_inner_error_codes.h"
+#include "graph/build/stream_event_optimizer.h"
 #include "graph/compute_graph.h"
 #include "graph/manager/graph_manager_utils.h"
 
@@ -38,6 +40,20 @@ class StreamAllocator {
   Status AssignLogicalStreams(const std::map<std::string, int> &max_parallel_num, bool hcom_parallel);
   Status RefreshRealStream(int64_t &stream_num, int64_t &event_num);
   const vector<int64_t> &GetHugeStreams() const { return huge_streams_; }
+  const SyncEventReport &GetSyncEventReport() const { return sync_event_report_; }
+
+  ///
+  /// @ingroup GE
+  /// @brief Event step of RefreshRealStream in place of RefreshEventsWithReuse: remove events implied by other paths,
+  ///        then give event ids with reuse. Fills the report of GetSyncEventReport
+  /// @param [in] max_event_num event budget of device, 0 for no limit
+  /// @return FAILED if the events still exceed max_event_num
+  ///
+  Status RefreshEventsByReachability(uint32_t max_event_num) {
+    GE_CHK_STATUS_RET(OptimizeSyncEventsByReachability(), "[Optimize][SyncEvents] by reachability failed, graph:%s",
+                      whole_graph_->GetName().c_str());
+    return AllocateEventsWithBudget(max_event_num);
+  }
 
  private:
   Status AssignSingleStream();
@@ -56,6 +72,133 @@ class StreamAllocator {
   // Determine if the successor node of RecvNode is directly or indirectly activated by the SendNode precursor node
   bool IsRecvNodeActivatedBySendNode(const NodePtr &send_node_ptr, const NodePtr &recv_node_ptr) const;
   bool IsActiveAfterNextIteration(const NodePtr &active_node_ptr) const;
+  // Remove events implied by other paths with StreamEventOptimizer, edges across stream activation are kept
+  Status OptimizeSyncEventsByReachability() {
+    std::vector<NodePtr> nodes;
+    std::vector<EventNodes> events;
+    StreamEventOptimizer optimizer;
+    std::vector<SyncEdge> edges;
+    GE_CHK_STATUS_RET_NOLOG(BuildSyncEdges(nodes, events, optimizer, edges));
+    std::vector<SyncEdge> kept;
+    GE_CHK_STATUS_RET(optimizer.Optimize(edges, kept), "[Optimize][SyncEvents] failed, graph:%s",
+                      whole_graph_->GetName().c_str());
+    std::multiset<std::pair<uint32_t, uint32_t>> kept_edges;
+    for (const auto &edge : kept) {
+      (void)kept_edges.emplace(edge.src, edge.dst);
+    }
+    for (const auto &event : events) {
+      if (event.src >= event.dst) {
+        continue;
+      }
+      // one event is kept for each kept edge, the others between the same two nodes are duplicates
+      const auto it = kept_edges.find(std::make_pair(event.src, event.dst));
+      if (it != kept_edges.end()) {
+        (void)kept_edges.erase(it);
+        continue;
+      }
+      GELOGD("Remove event %u from %s to %s, implied by other paths", event.event_id,
+             event.send_node->GetName().c_str(), event.recv_node->GetName().c_str());
+      RmvSendEventId(event.send_node, event.event_id);
+      RmvRecvEventId(event.recv_node, event.event_id);
+    }
+    sync_event_report_ = optimizer.GetReport();
+    return SUCCESS;
+  }
+
+  // Reuse event ids across disjoint lifetimes, not within loops, FAILED if the events still exceed max_event_num
+  Status AllocateEventsWithBudget(uint32_t max_event_num) {
+    std::vector<NodePtr> nodes;
+    std::vector<EventNodes> events;
+    StreamEventOptimizer optimizer;
+    std::vector<SyncEdge> edges;
+    GE_CHK_STATUS_RET_NOLOG(BuildSyncEdges(nodes, events, optimizer, edges));
+    std::vector<SyncEdge> back_edges;
+    for (const auto &event : events) {
+      if (event.src >= event.dst) {
+        back_edges.emplace_back(SyncEdge{event.src, event.dst, false});
+      }
+    }
+    GE_CHK_STATUS_RET_NOLOG(optimizer.SetBackEdges(back_edges));
+    std::vector<SyncEvent> sync_events;
+    GE_CHK_STATUS_RET_NOLOG(optimizer.AssignEvents(edges, 0U, sync_events));
+    // events across iterations are not forward in topo order, each keeps an id of its own
+    const uint32_t backward_num = static_cast<uint32_t>(events.size() - edges.size());
+    const SyncEventReport &report = optimizer.GetReport();
+    sync_event_report_.reused_events = report.reused_events;
+    sync_event_report_.event_num = report.event_num + backward_num;
+    sync_event_report_.cost_us += report.cost_us;
+    if ((max_event_num != 0U) && (sync_event_report_.event_num > max_event_num)) {
+      GELOGW("Graph %s needs %u events, budget is %u, streams need to be split", whole_graph_->GetName().c_str(),
+             sync_event_report_.event_num, max_event_num);
+      return FAILED;
+    }
+    node_to_send_events_.clear();
+    node_to_recv_events_.clear();
+    for (const auto &sync_event : sync_events) {
+      AddSendEventId(nodes[sync_event.send_node], sync_event.event_id);
+      AddRecvEventId(nodes[sync_event.recv_node], sync_event.event_id);
+    }
+    uint32_t event_id = report.event_num;
+    for (const auto &event : events) {
+      if (event.src >= event.dst) {
+        AddSendEventId(event.send_node, event_id);
+        AddRecvEventId(event.recv_node, event_id);
+        ++event_id;
+      }
+    }
+    event_num_ = event_id;
+    return SUCCESS;
+  }
+
+  struct EventNodes {
+    uint32_t event_id;
+    NodePtr send_node;
+    NodePtr recv_node;
+    uint32_t src;  // index of send node in topo order
+    uint32_t dst;  // index of recv node in topo order
+  };
+
+  // nodes in topo order, current events, and an edge for each event whose send node is before its recv node
+  Status BuildSyncEdges(std::vector<NodePtr> &nodes, std::vector<EventNodes> &events, StreamEventOptimizer &optimizer,
+                        std::vector<SyncEdge> &edges) const {
+    std::map<NodePtr, uint32_t> node_indices;
+    std::vector<int64_t> node_streams;
+    for (const auto &node : whole_graph_->GetNodes(whole_graph_->GetGraphUnknownFlag())) {
+      GE_CHECK_NOTNULL(node->GetOpDesc());
+      node_indices[node] = static_cast<uint32_t>(nodes.size());
+      nodes.emplace_back(node);
+      node_streams.emplace_back(node->GetOpDesc()->GetStreamId());
+    }
+    std::map<uint32_t, std::pair<NodePtr, NodePtr>> event_nodes;
+    for (const auto &it : node_to_send_events_) {
+      for (const uint32_t event_id : it.second) {
+        event_nodes[event_id].first = it.first;
+      }
+    }
+    for (const auto &it : node_to_recv_events_) {
+      for (const uint32_t event_id : it.second) {
+        event_nodes[event_id].second = it.first;
+      }
+    }
+    for (const auto &it : event_nodes) {
+      const auto send = node_indices.find(it.second.first);
+      const auto recv = node_indices.find(it.second.second);
+      if ((send == node_indices.end()) || (recv == node_indices.end())) {
+        GELOGE(INTERNAL_ERROR, "[Check][Param] event %u of graph %s has no send or recv node", it.first,
+               whole_graph_->GetName().c_str());
+        return INTERNAL_ERROR;
+      }
+      events.emplace_back(EventNodes{it.first, it.second.first, it.second.second, send->second, recv->second});
+    }
+    GE_CHK_STATUS_RET_NOLOG(optimizer.Init(node_streams));
+    for (const auto &event : events) {
+      if (event.src < event.dst) {
+        edges.emplace_back(
+            SyncEdge{event.src, event.dst, !IsRecvNodeActivatedBySendNode(event.send_node, event.recv_node)});
+      }
+    }
+    return SUCCESS;
+  }
 
   Status SplitStreams(std::vector<std::set<int64_t>> &split_streams);
   bool NeedSpiltNewStream(int64_t stream_node_num, int64_t max_node_num_one_stream, const OpDescPtr &op_desc,
@@ -122,6 +265,8 @@ class StreamAllocator {
 
   // recv events corresponding to the node
   std::map<NodePtr, std::vector<uint32_t>> node_to_recv_events_;
+
+  SyncEventReport sync_event_report_;
 };
 }  // namespace ge
 #endif  // GE_GRAPH_BUILD_STREAM_ALLOCATOR_H_
@@ -0,0 +1,309 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_BUILD_STREAM_EVENT_OPTIMIZER_H_
+#define GE_GRAPH_BUILD_STREAM_EVENT_OPTIMIZER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/ge_inner_error_codes.h"
+
+namespace ge {
+///
+/// @ingroup GE
+/// @brief dependency between two nodes given by index in topo order, an event is needed if streams differ
+///
+struct SyncEdge {
+  uint32_t src = 0U;
+  uint32_t dst = 0U;
+  bool removable = true;  // false for edges that must stay, e.g. across stream activation or iterations
+};
+
+struct SyncEvent {
+  uint32_t send_node = 0U;
+  uint32_t recv_node = 0U;
+  uint32_t event_id = 0U;
+};
+
+struct SyncEventReport {
+  size_t cross_stream_edges = 0U;  // events before optimization
+  size_t removed_events = 0U;
+  size_t kept_events = 0U;
+  size_t reused_events = 0U;       // kept events that share an event id with an earlier one
+  uint32_t event_num = 0U;         // event ids after reuse
+  uint64_t cost_us = 0UL;
+};
+
+///
+/// @ingroup GE
+/// @brief Sync event optimizer of a multi-stream graph. Nodes of one stream run in topo order, so the nodes that
+///        reach a node are kept as a vector clock: for every stream, the last position on that stream that reaches
+///        the node. This is a reachability bitset compressed per stream, O(node num * stream num) to build.
+///        An event from u to v is removed if another predecessor of v is already reached by u, i.e. transitive
+///        reduction limited to cross stream edges. Removed edges never change reachability, so the clocks stay valid
+///        for event reuse: an event id is reused once its last wait happens before the next record. Clocks cover one
+///        iteration only, so events with a node inside the topo range of a loop back edge never share an id.
+///
+class StreamEventOptimizer {
+ public:
+  ///
+  /// @ingroup GE
+  /// @param [in] node_streams: stream id of every node in topo order
+  ///
+  Status Init(const std::vector<int64_t> &node_streams) {
+    report_ = SyncEventReport();
+    stream_indices_.clear();
+    node_stream_index_.assign(node_streams.size(), 0U);
+    node_positions_.assign(node_streams.size(), 0);
+    stream_preds_.assign(node_streams.size(), static_cast<uint32_t>(kNoNode));
+    in_loop_.assign(node_streams.size(), false);
+    std::vector<uint32_t> stream_last;
+    std::vector<int32_t> stream_count;
+    for (size_t i = 0U; i < node_streams.size(); ++i) {
+      const auto ret = stream_indices_.emplace(node_streams[i], static_cast<uint32_t>(stream_indices_.size()));
+      const uint32_t stream_index = ret.first->second;
+      if (ret.second) {
+        stream_last.emplace_back(static_cast<uint32_t>(kNoNode));
+        stream_count.emplace_back(0);
+      }
+      node_stream_index_[i] = stream_index;
+      node_positions_[i] = stream_count[stream_index]++;
+      stream_preds_[i] = stream_last[stream_index];
+      stream_last[stream_index] = static_cast<uint32_t>(i);
+    }
+    clocks_.clear();
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup GE
+  /// @brief build vector clocks of all edges and keep cross stream edges that are not implied by other paths
+  /// @param [in] edges: data and control dependencies, src must be before dst in topo order
+  /// @param [out] kept: cross stream edges that need an event, deduplicated
+  ///
+  Status Optimize(const std::vector<SyncEdge> &edges, std::vector<SyncEdge> &kept) {
+    const auto start = std::chrono::steady_clock::now();
+    kept.clear();
+    const size_t node_num = node_stream_index_.size();
+    std::vector<std::vector<SyncEdge>> in_edges(node_num);
+    for (const auto &edge : edges) {
+      if ((edge.src >= edge.dst) || (edge.dst >= node_num)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] sync edge %u -> %u is not forward in topo order, node num:%zu",
+               edge.src, edge.dst, node_num);
+        return PARAM_INVALID;
+      }
+      if (node_stream_index_[edge.src] != node_stream_index_[edge.dst]) {
+        in_edges[edge.dst].emplace_back(edge);
+      }
+    }
+    BuildClocks(in_edges);
+
+    for (uint32_t dst = 0U; dst < node_num; ++dst) {
+      std::vector<SyncEdge> &preds = in_edges[dst];
+      // latest position first, so duplicated edges from one stream keep only the latest one
+      std::sort(preds.begin(), preds.end(), [](const SyncEdge &lhs, const SyncEdge &rhs) {
+        return (lhs.src != rhs.src) ? (lhs.src > rhs.src) : (lhs.removable < rhs.removable);
+      });
+      for (size_t i = 0U; i < preds.size(); ++i) {
+        const SyncEdge &edge = preds[i];
+        ++report_.cross_stream_edges;
+        if ((i > 0U) && (preds[i - 1U].src == edge.src)) {
+          ++report_.removed_events;
+          continue;
+        }
+        if (edge.removable && Implied(edge, preds)) {
+          ++report_.removed_events;
+          continue;
+        }
+        kept.emplace_back(edge);
+      }
+    }
+    report_.kept_events = kept.size();
+    report_.cost_us += ElapsedUs(start);
+    GELOGI("Stream event optimizer: node num:%zu, stream num:%zu, cross stream edges:%zu, removed:%zu, kept:%zu",
+           node_num, stream_indices_.size(), report_.cross_stream_edges, report_.removed_events, report_.kept_events);
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup GE
+  /// @brief mark nodes between the recv and the send node of each loop back edge, events touching them are not
+  ///        reused by AssignEvents. The next iteration may record before the last one waited
+  /// @param [in] back_edges: dependencies across iterations, src is at or after dst in topo order
+  ///
+  Status SetBackEdges(const std::vector<SyncEdge> &back_edges) {
+    const size_t node_num = node_stream_index_.size();
+    std::vector<int32_t> depth(node_num + 1U, 0);
+    for (const auto &edge : back_edges) {
+      if ((edge.src < edge.dst) || (edge.src >= node_num)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] back edge %u -> %u is not backward in topo order, node num:%zu",
+               edge.src, edge.dst, node_num);
+        return PARAM_INVALID;
+      }
+      ++depth[edge.dst];
+      --depth[edge.src + 1U];
+    }
+    int32_t open = 0;
+    for (size_t i = 0U; i < node_num; ++i) {
+      open += depth[i];
+      in_loop_[i] = (open > 0);
+    }
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup GE
+  /// @brief give event ids to kept edges, reusing ids whose last wait happens before the next record
+  /// @param [in] max_event_num: event budget of device, 0 for no limit
+  /// @return SUCCESS, or FAILED if the budget is exceeded, then event_num of report tells how many are needed
+  ///
+  Status AssignEvents(const std::vector<SyncEdge> &kept, const uint32_t max_event_num,
+                      std::vector<SyncEvent> &events) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t node_num = node_stream_index_.size();
+    // kept edges have the same reachability as all edges, so the clocks are valid without Optimize
+    std::vector<std::vector<SyncEdge>> in_edges(node_num);
+    for (const auto &edge : kept) {
+      if ((edge.src >= edge.dst) || (edge.dst >= node_num)) {
+        GELOGE(PARAM_INVALID, "[Check][Param] sync edge %u -> %u is not forward in topo order, node num:%zu",
+               edge.src, edge.dst, node_num);
+        return PARAM_INVALID;
+      }
+      in_edges[edge.dst].emplace_back(edge);
+    }
+    BuildClocks(in_edges);
+    events.clear();
+    events.reserve(kept.size());
+    for (const auto &edge : kept) {
+      events.emplace_back(SyncEvent{edge.src, edge.dst, 0U});
+    }
+    std::sort(events.begin(), events.end(), [](const SyncEvent &lhs, const SyncEvent &rhs) {
+      return (lhs.send_node != rhs.send_node) ? (lhs.send_node < rhs.send_node) : (lhs.recv_node < rhs.recv_node);
+    });
+    std::vector<uint32_t> last_recv;  // event id -> recv node of its last use, kNoNode if it is used in a loop
+    report_.reused_events = 0U;
+    for (auto &event : events) {
+      uint32_t event_id = static_cast<uint32_t>(last_recv.size());
+      const bool in_loop = in_loop_[event.send_node] || in_loop_[event.recv_node];
+      for (uint32_t id = 0U; (!in_loop) && (id < last_recv.size()); ++id) {
+        if ((last_recv[id] != kNoNode) && HappensBefore(last_recv[id], event.send_node)) {
+          event_id = id;
+          break;
+        }
+      }
+      if (event_id == last_recv.size()) {
+        last_recv.emplace_back(in_loop ? static_cast<uint32_t>(kNoNode) : event.recv_node);
+      } else {
+        last_recv[event_id] = event.recv_node;
+        ++report_.reused_events;
+      }
+      event.event_id = event_id;
+    }
+    report_.event_num = static_cast<uint32_t>(last_recv.size());
+    report_.cost_us += ElapsedUs(start);
+    GELOGI("Stream event optimizer: event num:%u, reused:%zu, budget:%u", report_.event_num, report_.reused_events,
+           max_event_num);
+    if ((max_event_num != 0U) && (report_.event_num > max_event_num)) {
+      GELOGW("Event num %u exceeds budget %u, streams need to be split", report_.event_num, max_event_num);
+      return FAILED;
+    }
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup GE
+  /// @brief whether node a finishes before node b starts on every execution, a node happens before itself
+  ///
+  bool HappensBefore(const uint32_t a, const uint32_t b) const {
+    if ((a >= node_stream_index_.size()) || (b >= node_stream_index_.size())) {
+      return false;
+    }
+    if (a == b) {
+      return true;
+    }
+    return Clock(b)[node_stream_index_[a]] >= node_positions_[a];
+  }
+
+  const SyncEventReport &GetReport() const {
+    return report_;
+  }
+
+ private:
+  static constexpr uint32_t kNoNode = UINT32_MAX;
+
+  static uint64_t ElapsedUs(const std::chrono::steady_clock::time_point &start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  const int32_t *Clock(const uint32_t node) const {
+    return &clocks_[static_cast<size_t>(node) * stream_indices_.size()];
+  }
+
+  void MergeClock(const uint32_t from, const uint32_t to) {
+    const size_t stream_num = stream_indices_.size();
+    const int32_t *const src = &clocks_[static_cast<size_t>(from) * stream_num];
+    int32_t *const dst = &clocks_[static_cast<size_t>(to) * stream_num];
+    for (size_t i = 0U; i < stream_num; ++i) {
+      dst[i] = std::max(dst[i], src[i]);
+    }
+  }
+
+  void BuildClocks(const std::vector<std::vector<SyncEdge>> &in_edges) {
+    const size_t stream_num = stream_indices_.size();
+    clocks_.assign(node_stream_index_.size() * stream_num, -1);
+    for (uint32_t node = 0U; node < node_stream_index_.size(); ++node) {
+      if (stream_preds_[node] != kNoNode) {
+        MergeClock(stream_preds_[node], node);
+      }
+      for (const auto &edge : in_edges[node]) {
+        MergeClock(edge.src, node);
+      }
+      clocks_[static_cast<size_t>(node) * stream_num + node_stream_index_[node]] = node_positions_[node];
+    }
+  }
+
+  // edge.src reaches another predecessor of edge.dst
+  bool Implied(const SyncEdge &edge, const std::vector<SyncEdge> &preds) const {
+    const uint32_t src_stream = node_stream_index_[edge.src];
+    const int32_t src_position = node_positions_[edge.src];
+    const uint32_t stream_pred = stream_preds_[edge.dst];
+    if ((stream_pred != kNoNode) && (Clock(stream_pred)[src_stream] >= src_position)) {
+      return true;
+    }
+    for (const auto &other : preds) {
+      if ((other.src != edge.src) && (Clock(other.src)[src_stream] >= src_position)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::map<int64_t, uint32_t> stream_indices_;  // stream id -> dense index
+  std::vector<uint32_t> node_stream_index_;
+  std::vector<int32_t> node_positions_;        // position of node on its stream
+  std::vector<uint32_t> stream_preds_;         // previous node on the same stream
+  std::vector<int32_t> clocks_;                // node num * stream num
+  std::vector<bool> in_loop_;                  // node is between the ends of a loop back edge
+  SyncEventReport report_;
+};
+}  // namespace ge
+#endif  // GE_GRAPH_BUILD_STREAM_EVENT_OPTIMIZER_H_
@@ -18,10 +18,12 @@
 #define GE_GRAPH_LOAD_NEW_MODEL_MANAGER_DATA_INPUTER_H_
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "common/blocking_queue.h"
+#include "graph/load/model_manager/batch_coalescer.h"
 #include "framework/common/ge_types.h"
 #include "framework/common/types.h"
 
@@ -130,18 +132,49 @@ class DataInputer {
 
   ///
   /// @ingroup domi_ome
-  /// @brief stop receiving data, invoke thread at Pop
-  ///
-  void Stop() { queue_.Stop(); }
+  /// @brief stop receiving data, invoke thread at Pop, requests left in the coalescer are called back with FAILED
+  ///
+  void Stop() {
+    queue_.Stop();
+    const std::shared_ptr<BatchCoalescer> coalescer = GetBatchCoalescer();
+    if (coalescer != nullptr) {
+      coalescer->Stop();
+    }
+  }
 
   uint32_t Size() { return queue_.Size(); }
 
+  ///
+  /// @ingroup domi_ome
+  /// @brief serve requests through a started coalescer beside the queue, see ModelManager::EnableBatchCoalesce
+  /// @param [in] coalescer started coalescer, nullptr to go back to one request per run
+  ///
+  void SetBatchCoalescer(const std::shared_ptr<BatchCoalescer> &coalescer) {
+    std::shared_ptr<BatchCoalescer> old_coalescer;
+    {
+      const std::lock_guard<std::mutex> lock(coalescer_mutex_);
+      old_coalescer = coalescer_;
+      coalescer_ = coalescer;
+    }
+    if ((old_coalescer != nullptr) && (old_coalescer != coalescer)) {
+      old_coalescer->Stop();
+    }
+  }
+
+  std::shared_ptr<BatchCoalescer> GetBatchCoalescer() const {
+    const std::lock_guard<std::mutex> lock(coalescer_mutex_);
+    return coalescer_;
+  }
+
  private:
   ///
   /// @ingroup domi_ome
   /// @brief save input data queue
   ///
   BlockingQueue<std::shared_ptr<InputDataWrapper>> queue_;
+
+  mutable std::mutex coalescer_mutex_;
+  std::shared_ptr<BatchCoalescer> coalescer_;
 };
 }  // namespace ge
 
@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 #include "cce/aicpu_engine_struct.h"
+#include "common/ge/ge_util.h"
 #include "framework/common/ge_inner_error_codes.h"
 #include "framework/common/ge_types.h"
 #include "framework/common/helper/model_helper.h"
@@ -34,6 +35,8 @@
 #include "framework/common/types.h"
 #include "external/ge/ge_api_types.h"
 #include "graph/ge_context.h"
+#include "graph/load/model_manager/batch_coalescer.h"
+#include "graph/load/model_manager/davinci_model.h"
 #include "graph/model.h"
 #include "hybrid/hybrid_davinci_model.h"
 #include "runtime/base.h"
@@ -124,6 +127,62 @@ class FMK_FUNC_HOST_VISIBILITY FMK_FUNC_DEV_VISIBILITY ModelManager {
 
   ge::Status DataInputTensor(uint32_t model_id, const std::vector<ge::Tensor> &inputs);
 
+  ///
+  /// @ingroup domi_ome
+  /// @brief serve a dynamic batch model with request coalescing, the coalescer is kept by the DataInputer of model
+  ///        and stopped with it
+  /// @param [in] model_id   model id
+  /// @param [in] options    gears, max batch, max wait and queue capacity, gears default to batch gears of model
+  /// @param [in] execute    runs the gathered batch, e.g. ExecuteModel with output buffers of the gear
+  /// @return SUCCESS        success
+  /// @return PARAM_INVALID  model is not found or has no batch gears
+  ///
+  ge::Status EnableBatchCoalesce(uint32_t model_id, const BatchCoalesceOptions &options,
+                                 const BatchExecuteFunc &execute) {
+    const std::shared_ptr<DavinciModel> model = GetModel(model_id);
+    if ((model == nullptr) || (model->GetDataInputer() == nullptr)) {
+      REPORT_INNER_ERROR("E19999", "model id %u does not exist or has no data inputer, check invalid", model_id);
+      GELOGE(PARAM_INVALID, "[Check][Param] model id %u does not exist or has no data inputer", model_id);
+      return PARAM_INVALID;
+    }
+    BatchCoalesceOptions coalesce_options = options;
+    if (coalesce_options.batch_gears.empty()) {
+      std::vector<std::vector<int64_t>> batch_info;
+      int32_t dynamic_type = static_cast<int32_t>(FIXED);
+      GE_CHK_STATUS_RET(GetDynamicBatchInfo(model_id, batch_info, dynamic_type),
+                        "[Get][DynamicBatchInfo] failed, model id:%u", model_id);
+      for (const auto &gear : batch_info) {
+        if ((dynamic_type == static_cast<int32_t>(DYNAMIC_BATCH)) && (!gear.empty()) && (gear[0U] > 0)) {
+          coalesce_options.batch_gears.emplace_back(static_cast<uint32_t>(gear[0U]));
+        }
+      }
+    }
+    const auto coalescer = MakeShared<BatchCoalescer>();
+    GE_CHECK_NOTNULL(coalescer);
+    GE_CHK_STATUS_RET(coalescer->Init(coalesce_options, execute), "[Init][BatchCoalescer] failed, model id:%u",
+                      model_id);
+    GE_CHK_STATUS_RET(coalescer->Start(), "[Start][BatchCoalescer] failed, model id:%u", model_id);
+    model->GetDataInputer()->SetBatchCoalescer(coalescer);
+    GELOGI("Model %u serves requests with coalescing, gear num:%zu", model_id, coalesce_options.batch_gears.size());
+    return SUCCESS;
+  }
+
+  ///
+  /// @ingroup domi_ome
+  /// @brief push one request of model served by EnableBatchCoalesce, callback is called with its rows of outputs
+  ///
+  ge::Status DataInputCoalesced(uint32_t model_id, const std::shared_ptr<BatchRequest> &request) {
+    const std::shared_ptr<DavinciModel> model = GetModel(model_id);
+    const std::shared_ptr<BatchCoalescer> coalescer =
+        ((model == nullptr) || (model->GetDataInputer() == nullptr)) ? nullptr
+                                                                     : model->GetDataInputer()->GetBatchCoalescer();
+    if (coalescer == nullptr) {
+      GELOGE(PARAM_INVALID, "[Check][Param] model id %u is not served by a batch coalescer", model_id);
+      return PARAM_INVALID;
+    }
+    return coalescer->Push(request);
+  }
+
   ///
   /// @ingroup domi_ome
   /// @brief Get cur_dynamic_dims for all input.
@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_LOAD_NEW_MODEL_MANAGER_ZERO_COPY_PATCH_PLAN_H_
+#define GE_GRAPH_LOAD_NEW_MODEL_MANAGER_ZERO_COPY_PATCH_PLAN_H_
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_types.h"
+#include "graph/load/model_manager/zero_copy_offset.h"
+#include "graph/load/model_manager/zero_copy_task.h"
+#include "runtime/mem.h"
+
+namespace ge {
+/**
+ * @ingroup ge
+ * @brief Patch points of all model inputs and outputs compiled from the offsets recorded by SetZeroCopyAddr, so a
+ *        request writes user addresses into the orignal args of the tasks with flat loops instead of looking up the
+ *        offset map of every task, and uploads only the patched range of each task args.
+ *        Patch points refer to tasks by index, the plan is built once the task list is complete.
+ */
+class ZeroCopyPatchPlan {
+ public:
+  /**
+   * @ingroup ge
+   * @brief compile patch points from tasks and offsets recorded by SetZeroCopyAddr
+   * @param [in] tasks: zero copy tasks of model
+   * @param [in] input_info: input data info { data_index, ZeroCopyOffset }
+   * @param [in] output_info: output data info { data_index, ZeroCopyOffset }
+   * @return SUCCESS / others FAILED
+   */
+  Status Build(const vector<ZeroCopyTask> &tasks, const map<uint32_t, ZeroCopyOffset> &input_info,
+               const map<uint32_t, ZeroCopyOffset> &output_info) {
+    Clear();
+    patched_ranges_.assign(tasks.size(), PatchedRange{0U, 0U});
+    GE_CHK_STATUS_RET_NOLOG(BuildIoPatches(tasks, input_info, input_patches_));
+    GE_CHK_STATUS_RET_NOLOG(BuildIoPatches(tasks, output_info, output_patches_));
+    // one upload gathers at most the whole host args of every patched task, sized here so that the buffer is never
+    // reallocated while a copy issued from it is queued
+    vector<bool> is_patched(tasks.size(), false);
+    for (const IoPatches *const io_patches : {&input_patches_, &output_patches_}) {
+      for (const PatchPoint &patch : io_patches->patches) {
+        is_patched[patch.task] = true;
+      }
+    }
+    size_t staging_size = 0U;
+    for (size_t i = 0U; i < tasks.size(); ++i) {
+      staging_size += is_patched[i] ? HostArgsSize(tasks[i]) : 0U;
+    }
+    staging_.assign(staging_size, 0U);
+    built_ = true;
+    GELOGI("Zero copy patch plan built, task num:%zu, input patch num:%zu, output patch num:%zu, staging size:%zu",
+           tasks.size(), input_patches_.patches.size(), output_patches_.patches.size(), staging_size);
+    return SUCCESS;
+  }
+
+  void Clear() {
+    input_patches_ = IoPatches();
+    output_patches_ = IoPatches();
+    patched_ranges_.clear();
+    patched_tasks_.clear();
+    staging_.clear();
+    built_ = false;
+  }
+
+  bool IsBuilt() const {
+    return built_;
+  }
+
+  /**
+   * @ingroup ge
+   * @brief write user address of one input or output into orignal args of its tasks
+   * @param [in] tasks: zero copy tasks the plan is built from
+   * @param [in] is_input: input data or output data
+   * @param [in] data_index: index of input or output
+   * @param [in] buffer_addr: data buffer addr from user
+   * @param [in] batch_label: batch label for multi-batch scenes, tasks of other batch are not patched
+   * @return SUCCESS / others FAILED
+   */
+  Status Patch(vector<ZeroCopyTask> &tasks, const bool is_input, const uint32_t data_index, const void *buffer_addr,
+               const string &batch_label) {
+    const IoPatches &io_patches = is_input ? input_patches_ : output_patches_;
+    if (tasks.size() != patched_ranges_.size()) {
+      GELOGE(INTERNAL_ERROR, "[Check][Param] task num changed from %zu to %zu after plan built",
+             patched_ranges_.size(), tasks.size());
+      return INTERNAL_ERROR;
+    }
+    if ((data_index >= io_patches.slots.size()) || (io_patches.slots[data_index] < 0)) {
+      return SUCCESS;  // no task uses the addr of this data
+    }
+    const size_t slot = static_cast<size_t>(io_patches.slots[data_index]);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(buffer_addr);
+    for (size_t i = io_patches.offsets[slot]; i < io_patches.offsets[slot + 1U]; ++i) {
+      const PatchPoint &patch = io_patches.patches[i];
+      ZeroCopyTask &task = tasks[patch.task];
+      if ((!batch_label.empty()) && (!task.GetBatchLabel().empty()) && (task.GetBatchLabel() != batch_label)) {
+        continue;
+      }
+      const uint64_t value = static_cast<uint64_t>(base + static_cast<uintptr_t>(patch.relative_offset));
+      if (!task.PatchArgs(patch.offset, value)) {
+        GELOGE(INTERNAL_ERROR, "[Check][Param] offset %zu of task %s exceeds args size %zu", patch.offset,
+               task.GetName().c_str(), task.GetOriginalArgs().size());
+        return INTERNAL_ERROR;
+      }
+      PatchedRange &range = patched_ranges_[patch.task];
+      if (range.end == 0U) {
+        range.begin = patch.offset;
+        patched_tasks_.emplace_back(patch.task);
+      }
+      range.begin = std::min(range.begin, patch.offset);
+      range.end = std::max(range.end, patch.offset + sizeof(uint64_t));
+    }
+    return SUCCESS;
+  }
+
+  /**
+   * @ingroup ge
+   * @brief copy the patched ranges of orignal args to device. Tasks whose args follow each other in device memory
+   *        are gathered into one staging buffer and copied by one call, the unpatched bytes between two ranges are
+   *        taken from orignal args as long as the gap is small
+   * @param [in] tasks: zero copy tasks the plan is built from
+   * @param [in] async_mode: true for asychronous mode.
+   * @param [in] stream: Stream for asychronous update.
+   * @return SUCCESS / others FAILED
+   */
+  Status Upload(const vector<ZeroCopyTask> &tasks, const bool async_mode, rtStream_t const stream) {
+    upload_ranges_.clear();
+    for (const size_t task_idx : patched_tasks_) {
+      const PatchedRange &range = patched_ranges_[task_idx];
+      const ZeroCopyTask &task = tasks[task_idx];
+      upload_ranges_.emplace_back(UploadRange{task.GetArgsAddr(), task.GetOriginalArgs().data(), range.begin,
+                                              range.end, task.GetArgsSize(), HostArgsSize(task), task_idx});
+    }
+    ClearPatchedRanges();
+    std::sort(upload_ranges_.begin(), upload_ranges_.end(),
+              [](const UploadRange &lhs, const UploadRange &rhs) { return lhs.dst_args < rhs.dst_args; });
+    size_t staging_offset = 0U;
+    for (size_t begin = 0U; begin < upload_ranges_.size();) {
+      size_t end = begin + 1U;
+      while ((end < upload_ranges_.size()) && CanMerge(upload_ranges_[end - 1U], upload_ranges_[end])) {
+        ++end;
+      }
+      const UploadRange &first = upload_ranges_[begin];
+      const UploadRange &last = upload_ranges_[end - 1U];
+      uint8_t *const dst = first.dst_args + first.begin;
+      const size_t size = static_cast<size_t>((last.dst_args + last.end) - dst);
+      const size_t dst_max = static_cast<size_t>((last.dst_args + last.args_size) - dst);
+      const uint8_t *src = first.src_args + first.begin;
+      if ((end - begin) > 1U) {
+        if ((staging_offset + size) > staging_.size()) {
+          GELOGE(INTERNAL_ERROR, "[Check][Param] staging size %zu exceeded, offset:%zu, size:%zu", staging_.size(),
+                 staging_offset, size);
+          return INTERNAL_ERROR;
+        }
+        src = staging_.data() + staging_offset;
+        for (size_t i = begin; i < end; ++i) {
+          const UploadRange &range = upload_ranges_[i];
+          const size_t copy_begin = (i == begin) ? range.begin : 0U;
+          const size_t copy_end = (i == (end - 1U)) ? range.end : range.host_size;
+          (void)memcpy(staging_.data() + staging_offset, range.src_args + copy_begin, copy_end - copy_begin);
+          staging_offset += copy_end - copy_begin;
+        }
+      }
+      rtError_t rt_ret;
+      if (async_mode) {
+        rt_ret = rtMemcpyAsync(dst, dst_max, src, size, RT_MEMCPY_HOST_TO_DEVICE_EX, stream);
+      } else {
+        rt_ret = rtMemcpy(dst, dst_max, src, size, RT_MEMCPY_HOST_TO_DEVICE);
+      }
+      if (rt_ret != RT_ERROR_NONE) {
+        REPORT_CALL_ERROR("E19999", "Call rtMemcpy failed, size:%zu, ret:0x%X", size, rt_ret);
+        GELOGE(RT_FAILED, "[Call][RtMemcpy] upload args of %zu tasks from task %s failed, size:%zu, ret:0x%X",
+               end - begin, tasks[first.task].GetName().c_str(), size, rt_ret);
+        return RT_ERROR_TO_GE_STATUS(rt_ret);
+      }
+      begin = end;
+    }
+    GELOGD("Zero copy args of %zu tasks uploaded", upload_ranges_.size());
+    return SUCCESS;
+  }
+
+ private:
+  struct PatchPoint {
+    size_t task;              // index in tasks
+    size_t offset;            // in args of task
+    int64_t relative_offset;  // added to user address
+  };
+
+  // patches of data index i are patches[offsets[slots[i]], offsets[slots[i] + 1]), slots[i] is -1 if none
+  struct IoPatches {
+    vector<int32_t> slots;
+    vector<size_t> offsets{0U};
+    vector<PatchPoint> patches;
+  };
+
+  // [begin, end) in args of task patched since last upload, empty if end is 0
+  struct PatchedRange {
+    size_t begin;
+    size_t end;
+  };
+
+  struct UploadRange {
+    uint8_t *dst_args;        // device args of task
+    const uint8_t *src_args;  // orignal args of task
+    size_t begin;             // patched range in args
+    size_t end;
+    size_t args_size;         // size of device args
+    size_t host_size;         // bytes of orignal args that mirror device args
+    size_t task;
+  };
+
+  // unpatched bytes uploaded in between rather than issuing one more copy
+  static constexpr size_t kMaxUploadGap = 1024U;
+
+  static size_t HostArgsSize(const ZeroCopyTask &task) {
+    return std::min(task.GetOriginalArgs().size(), task.GetArgsSize());
+  }
+
+  // args of next follow args of prev in device memory and the bytes between both ranges are known on host
+  static bool CanMerge(const UploadRange &prev, const UploadRange &next) {
+    return (next.dst_args == (prev.dst_args + prev.args_size)) && (prev.host_size == prev.args_size) &&
+           (((prev.args_size - prev.end) + next.begin) <= kMaxUploadGap);
+  }
+
+  void ClearPatchedRanges() {
+    for (const size_t task_idx : patched_tasks_) {
+      patched_ranges_[task_idx] = PatchedRange{0U, 0U};
+    }
+    patched_tasks_.clear();
+  }
+
+  static Status BuildIoPatches(const vector<ZeroCopyTask> &tasks, const map<uint32_t, ZeroCopyOffset> &data_info,
+                               IoPatches &io_patches) {
+    if (!data_info.empty()) {
+      io_patches.slots.assign(static_cast<size_t>(data_info.rbegin()->first) + 1U, -1);
+    }
+    for (const auto &data : data_info) {
+      const ZeroCopyOffset &zero_copy_offset = data.second;
+      const auto &data_addrs = zero_copy_offset.GetDataInfo();
+      const auto &relative_offsets = zero_copy_offset.GetRelativeOffset();
+      for (size_t count = 0U; count < zero_copy_offset.GetDataCount(); ++count) {
+        if ((count >= data_addrs.size()) || (count >= relative_offsets.size())) {
+          GELOGE(INTERNAL_ERROR, "[Check][Param] data count %u of %s exceeds data info size %zu or offset size %zu",
+                 zero_copy_offset.GetDataCount(), zero_copy_offset.GetOpName().c_str(), data_addrs.size(),
+                 relative_offsets.size());
+          return INTERNAL_ERROR;
+        }
+        const uintptr_t virtual_addr = reinterpret_cast<uintptr_t>(data_addrs[count].second);
+        for (size_t task_idx = 0U; task_idx < tasks.size(); ++task_idx) {
+          const auto &task_offsets = tasks[task_idx].GetTaskAddrOffset();
+          const auto it = task_offsets.find(virtual_addr);
+          if (it == task_offsets.end()) {
+            continue;
+          }
+          for (const size_t offset : it->second) {
+            if ((offset + sizeof(uint64_t)) > tasks[task_idx].GetOriginalArgs().size()) {
+              GELOGE(INTERNAL_ERROR, "[Check][Param] offset %zu of task %s exceeds args size %zu", offset,
+                     tasks[task_idx].GetName().c_str(), tasks[task_idx].GetOriginalArgs().size());
+              return INTERNAL_ERROR;
+            }
+            io_patches.patches.emplace_back(PatchPoint{task_idx, offset, relative_offsets[count]});
+          }
+        }
+      }
+      io_patches.slots[data.first] = static_cast<int32_t>(io_patches.offsets.size() - 1U);
+      io_patches.offsets.emplace_back(io_patches.patches.size());
+    }
+    return SUCCESS;
+  }
+
+  IoPatches input_patches_;
+  IoPatches output_patches_;
+  vector<PatchedRange> patched_ranges_;  // indexed by task
+  vector<size_t> patched_tasks_;
+  vector<UploadRange> upload_ranges_;
+  vector<uint8_t> staging_;  // merged ranges, sized by Build and never reallocated by Upload
+  bool built_ = false;
+};
+}  // namespace ge
+#endif  // GE_GRAPH_LOAD_NEW_MODEL_MANAGER_ZERO_COPY_PATCH_PLAN_H_
@@ -20,6 +20,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <new>
 #include <set>
 #include <string>
 #include <thread>
@@ -30,6 +31,7 @@
 #include "external/graph/types.h"
 #include "external/ge/ge_api_types.h"
 #include "graph/build/graph_builder.h"
+#include "graph/manager/graph_compile_scheduler.h"
 #include "graph/ge_local_context.h"
 #include "graph/manager/graph_manager_utils.h"
 #include "graph/manager/util/variable_accelerate_ctrl.h"
@@ -37,10 +39,13 @@
 #include "graph/partition/graph_partition.h"
 #include "graph/preprocess/graph_preprocess.h"
 #include "graph/tuning_utils.h"
+#include "graph/utils/tensor_adapter.h"
 #include "common/model/ge_model.h"
 #include "common/executor.h"
 
 namespace ge {
+constexpr const char *kOptionCompileThreadNum = "ge.compileThreadNum";
+
 class GraphManager {
  public:
   GraphManager() = default;
@@ -208,6 +213,16 @@ class GraphManager {
 
   void RemoveAddGraphCondition(GraphId graph_id);
 
+  ///
+  /// @ingroup ge_graph
+  /// @brief cost of every stage of graphs compiled by async PreRun
+  /// @return statistics of compile stages, empty if compile scheduler is not used
+  ///
+  std::array<CompileStageStatistics, kCompileStageNum> GetCompileStatistics() const {
+    return (compile_scheduler_ == nullptr) ? std::array<CompileStageStatistics, kCompileStageNum>{}
+                                           : compile_scheduler_->GetStatistics();
+  }
+
  private:
   struct CompilerStages {
     GraphPrepare preparer;
@@ -342,6 +357,100 @@ class GraphManager {
   void PushGraph(const RunArgs &args);
 
   void PreRunThread();
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief start compile scheduler if ge.compileThreadNum is larger than 1, called by Initialize after ParseOptions.
+  ///        PreRunThread then hands every PreRunArgs to SubmitPreRunJob instead of running PreRun itself
+  ///
+  Status StartCompileScheduler(const std::map<std::string, std::string> &options) {
+    GE_CHK_STATUS_RET(ParseOption(options, kOptionCompileThreadNum, options_.compile_thread_num),
+                      "[Parse][Option] %s failed", kOptionCompileThreadNum);
+    if (options_.compile_thread_num <= 1) {
+      return SUCCESS;
+    }
+    compile_scheduler_.reset(
+        new (std::nothrow) GraphCompileScheduler(static_cast<uint32_t>(options_.compile_thread_num)));
+    GE_CHECK_NOTNULL(compile_scheduler_);
+    // models share the device, load them one by one
+    compile_scheduler_->SetStageLimit(CompileStage::kLoad, 1U);
+    return compile_scheduler_->Start();
+  }
+
+  // called by Finalize before the graphs are removed, jobs not started yet are finished with FAILED
+  void StopCompileScheduler() {
+    if (compile_scheduler_ != nullptr) {
+      compile_scheduler_->Stop();
+      compile_scheduler_.reset();
+    }
+  }
+
+  ///
+  /// @ingroup ge_graph
+  /// @brief split PreRun of args into stages of compile_scheduler_, the callback pushes the built graph to the
+  ///        executor as PreRunThread does, or returns the error to the caller of RunGraphAsync
+  /// @param [in] args: PreRun arguments popped by PreRunThread, its contexts are already set on this thread
+  /// @param [in] priority: larger is compiled first
+  /// @return SUCCESS if submitted
+  ///
+  Status SubmitPreRunJob(const PreRunArgs &args, const int32_t priority) {
+    GE_CHECK_NOTNULL(compile_scheduler_);
+    GraphNodePtr graph_node = nullptr;
+    if ((GetGraphNode(args.graph_id, graph_node) != SUCCESS) || (graph_node == nullptr)) {
+      ReturnError(args.callback, GE_GRAPH_GRAPH_NODE_NULL,
+                  "[Get][GraphNode] failed, graph id:" + std::to_string(args.graph_id));
+      return GE_GRAPH_GRAPH_NODE_NULL;
+    }
+    struct PreRunState {
+      std::vector<GeTensor> inputs;
+      ComputeGraphPtr compute_graph;
+      GeRootModelPtr ge_root_model;
+    };
+    const auto state = MakeShared<PreRunState>();
+    GE_CHECK_NOTNULL(state);
+    GraphCompileJob job;
+    job.graph_id = args.graph_id;
+    job.priority = priority;
+    graph_node->Lock();
+    if (IsGraphNeedBuild(graph_node)) {
+      for (const auto &tensor : args.input_tensor) {
+        state->inputs.emplace_back(TensorAdapter::AsGeTensor(tensor));
+      }
+      const uint64_t session_id = args.session_id;
+      // partition is done with the optimize of subgraphs, its stage is left empty
+      job.stages[static_cast<size_t>(CompileStage::kPrepare)] = [this, graph_node, state, session_id]() {
+        return PreRunOptimizeOriginalGraph(graph_node, state->inputs, state->compute_graph, session_id);
+      };
+      job.stages[static_cast<size_t>(CompileStage::kOptimize)] = [this, graph_node, state, session_id]() {
+        return PreRunOptimizeSubGraph(graph_node, state->compute_graph, session_id);
+      };
+      job.stages[static_cast<size_t>(CompileStage::kBuild)] = [this, graph_node, state, session_id]() {
+        GE_CHK_STATUS_RET_NOLOG(PreRunAfterOptimizeSubGraph(graph_node, state->compute_graph, state->ge_root_model,
+                                                            session_id));
+        graph_node->SetGeRootModel(state->ge_root_model);
+        graph_node->SetBuildFlag(true);
+        var_acc_ctrl_.SetGraphBuildEnd(graph_node->GetGraphId());
+        return SUCCESS;
+      };
+      job.stages[static_cast<size_t>(CompileStage::kLoad)] = [this, graph_node, state]() {
+        return LoadGraph(state->ge_root_model, graph_node);
+      };
+    } else {
+      state->ge_root_model = graph_node->GetGeRootModel();
+    }
+    job.callback = [this, args, graph_node, state](const Status ret, const CompileJobTiming &timing) {
+      GELOGI("PreRun of graph %u finished, ret:%u, cost:%lu us", args.graph_id, ret, timing.total_us);
+      if (ret != SUCCESS) {
+        graph_node->Unlock();
+        ReturnError(args.callback, ret, "PreRun failed, graph id:" + std::to_string(args.graph_id));
+        return;
+      }
+      PushGraph(RunArgs({graph_node, args.graph_id, args.session_id, args.error_context, args.input_tensor,
+                         state->ge_root_model, GetThreadLocalContext(), args.callback}));
+    };
+    (void)compile_scheduler_->Submit(std::move(job));
+    return SUCCESS;
+  }
   void StopQueue();
   void ReturnError(RunAsyncCallback callback, Status ret, const string &log);
 
@@ -400,6 +509,7 @@ class GraphManager {
   std::atomic_bool thread_run_flag_{false};
   BlockingQueue<PreRunArgs> prerun_args_q_{};
   std::thread prerun_thread_;
+  std::unique_ptr<GraphCompileScheduler> compile_scheduler_;
   ComputeGraphPtr compute_graph_;
   std::map<GraphId, GraphNodePtr> graph_map_;
 
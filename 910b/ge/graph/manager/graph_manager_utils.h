@@ -276,6 +276,7 @@ struct GraphManagerOptions {
   std::string input_shape;
   std::string dynamic_dims;
   int32_t dynamic_node_type = -1;
+  int32_t compile_thread_num = 1;  // graphs compiled concurrently by async PreRun
   GraphManagerOptions()
       : stream_num(1),
         perf_level(domi::GEN_TASK_WITHOUT_FUSION),
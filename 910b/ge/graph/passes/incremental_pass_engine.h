@@ -0,0 +1,338 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_GRAPH_PASSES_INCREMENTAL_PASS_ENGINE_H_
+#define GE_GRAPH_PASSES_INCREMENTAL_PASS_ENGINE_H_
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "graph/compute_graph.h"
+#include "graph/passes/base_pass.h"
+
+namespace ge {
+constexpr int32_t kMaxIncrementalPassDepth = 10;
+
+///
+/// Dirty worklist driver of node passes. Every node has a version that is increased when a pass reports it changed,
+/// and every pass remembers the version it last visited, so a node popped from the worklist only runs the passes
+/// that have not seen its current state. All passes run on one node before the next node is popped.
+/// Nodes get dense ids on first sight and are held until the end of Run, so addresses of deleted nodes are never
+/// reused for new nodes while their ids are alive.
+///
+class IncrementalPassEngine {
+ public:
+  // run passes on sub graphs of node, has_sub_graph tells whether node is passed again with kOptimizeAfterSubGraph
+  using SubGraphFunc = std::function<Status(const NodePtr &node, bool &has_sub_graph)>;
+  explicit IncrementalPassEngine(const NamesToPass &names_to_passes) : names_to_passes_(names_to_passes) {
+    statistics_.resize(names_to_passes.size());
+    for (size_t i = 0U; i < names_to_passes.size(); ++i) {
+      statistics_[i].name = names_to_passes[i].first;
+    }
+  }
+
+  Status Run(const ComputeGraphPtr &graph, const SubGraphFunc &run_sub_graph) {
+    for (const auto &node : graph->GetDirectNode()) {
+      Enqueue(node, false);
+    }
+    while (true) {
+      while (!worklist_.empty()) {
+        const uint32_t id = worklist_.front();
+        worklist_.pop_front();
+        states_[id].queued = false;
+        GE_CHK_STATUS_RET_NOLOG(RunPassesOnNode(id, graph, run_sub_graph));
+      }
+      // fixed point: stop once leaked suspend handling queues no node, e.g. all resumed nodes hit kMaxNodeVersion
+      GE_CHK_STATUS_RET_NOLOG(HandleLeakedSuspendNodes());
+      if (worklist_.empty()) {
+        break;
+      }
+    }
+    uint64_t visits = 0UL;
+    uint64_t skips = 0UL;
+    for (const auto &statistics : statistics_) {
+      visits += statistics.visit_count;
+      skips += statistics.skip_count;
+      GELOGD("Pass %s: time %lu us, visit %lu, change %lu, skip %lu", statistics.name.c_str(), statistics.time_us,
+             statistics.visit_count, statistics.change_count, statistics.skip_count);
+    }
+    GELOGI("Incremental passes on graph %s done, node num:%zu, pass visits:%lu, skipped:%lu",
+           graph->GetName().c_str(), nodes_.size(), visits, skips);
+    return SUCCESS;
+  }
+
+  const std::vector<PassStatistics> &GetStatistics() const {
+    return statistics_;
+  }
+
+ private:
+  static constexpr uint32_t kNotVisited = UINT32_MAX;
+  static constexpr uint32_t kMaxNodeVersion = 1000U;
+
+  struct NodeState {
+    uint32_t version = 0U;
+    bool queued = false;
+    bool deleted = false;
+    bool suspended = false;
+    bool sub_graph_passed = false;
+  };
+
+  uint32_t GetId(const NodePtr &node) {
+    const auto ret = ids_.emplace(node.get(), static_cast<uint32_t>(nodes_.size()));
+    if (ret.second) {
+      nodes_.emplace_back(node);
+      states_.emplace_back();
+      last_visits_.resize(last_visits_.size() + names_to_passes_.size(), kNotVisited);
+    }
+    return ret.first->second;
+  }
+
+  void Enqueue(const NodePtr &node, const bool front) {
+    if (node == nullptr) {
+      return;
+    }
+    const uint32_t id = GetId(node);
+    NodeState &state = states_[id];
+    if (state.queued || state.deleted || state.suspended) {
+      return;
+    }
+    state.queued = true;
+    if (front) {
+      worklist_.emplace_front(id);
+    } else {
+      worklist_.emplace_back(id);
+    }
+  }
+
+  void MarkChanged(const NodePtr &node, const bool front) {
+    if (node == nullptr) {
+      return;
+    }
+    NodeState &state = states_[GetId(node)];
+    if (state.version >= kMaxNodeVersion) {
+      GELOGW("Node %s is changed more than %u times by passes, stop passing it again", node->GetName().c_str(),
+             kMaxNodeVersion);
+      return;
+    }
+    ++state.version;
+    Enqueue(node, front);
+  }
+
+  // returns true if the pass reported any change
+  bool CollectChanges(BaseNodePass &pass) {
+    bool changed = false;
+    for (const auto &deleted : pass.GetNodesDeleted()) {
+      states_[GetId(deleted)].deleted = true;
+      changed = true;
+    }
+    for (const auto &suspend : pass.GetNodesSuspend()) {
+      states_[GetId(suspend)].suspended = true;
+      changed = true;
+    }
+    for (const auto &resume : pass.GetNodesResume()) {
+      states_[GetId(resume)].suspended = false;
+      MarkChanged(resume, false);
+      changed = true;
+    }
+    for (const auto &re_pass : pass.GetNodesNeedRePass()) {
+      MarkChanged(re_pass, false);
+      changed = true;
+    }
+    for (const auto &re_pass : pass.GetNodesNeedRePassImmediately()) {
+      MarkChanged(re_pass, true);
+      changed = true;
+    }
+    return changed;
+  }
+
+  Status RunOnePass(const size_t pass_index, const uint32_t id, const bool force) {
+    BaseNodePass *const pass = names_to_passes_[pass_index].second;
+    PassStatistics &statistics = statistics_[pass_index];
+    const size_t visit_index = static_cast<size_t>(id) * names_to_passes_.size() + pass_index;
+    const uint32_t version = states_[id].version;
+    if ((!force) && (last_visits_[visit_index] == version)) {
+      ++statistics.skip_count;
+      return SUCCESS;
+    }
+    NodePtr node = nodes_[id];
+    pass->init();
+    const auto start = std::chrono::steady_clock::now();
+    const Status ret = pass->Run(node);
+    statistics.time_us += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    ++statistics.visit_count;
+    if (ret != SUCCESS) {
+      REPORT_CALL_ERROR("E19999", "process pass %s on node:%s failed, ret:%u", statistics.name.c_str(),
+                        nodes_[id]->GetName().c_str(), ret);
+      GELOGE(ret, "[Process][Pass] %s on node %s failed, result %u", statistics.name.c_str(),
+             nodes_[id]->GetName().c_str(), ret);
+      return ret;
+    }
+    // the version before Run, so a node changed by this pass is visited by it again
+    last_visits_[visit_index] = version;
+    if (CollectChanges(*pass)) {
+      ++statistics.change_count;
+    }
+    return SUCCESS;
+  }
+
+  Status RunPasses(const uint32_t id, const bool force) {
+    for (size_t i = 0U; i < names_to_passes_.size(); ++i) {
+      if (states_[id].deleted || states_[id].suspended) {
+        break;
+      }
+      GE_CHK_STATUS_RET_NOLOG(RunOnePass(i, id, force));
+    }
+    return SUCCESS;
+  }
+
+  Status RunPassesOnNode(const uint32_t id, const ComputeGraphPtr &graph, const SubGraphFunc &run_sub_graph) {
+    const NodePtr node = nodes_[id];
+    if (states_[id].deleted || states_[id].suspended || (node->GetOwnerComputeGraph() != graph)) {
+      return SUCCESS;
+    }
+    GE_CHK_STATUS_RET_NOLOG(RunPasses(id, false));
+    // nodes added by passes without asking for re-pass are found through edges, as the full mode does
+    for (const auto &out_node : node->GetOutAllNodes()) {
+      if (ids_.count(out_node.get()) == 0U) {
+        Enqueue(out_node, false);
+      }
+    }
+    if (states_[id].deleted || states_[id].suspended || states_[id].sub_graph_passed || (!run_sub_graph)) {
+      return SUCCESS;
+    }
+    const auto op_desc = node->GetOpDesc();
+    if ((op_desc == nullptr) || op_desc->GetSubgraphInstanceNames().empty()) {
+      return SUCCESS;
+    }
+    states_[id].sub_graph_passed = true;
+    bool has_sub_graph = false;
+    GE_CHK_STATUS_RET_NOLOG(run_sub_graph(node, has_sub_graph));
+    if (has_sub_graph) {
+      for (const auto &name_to_pass : names_to_passes_) {
+        name_to_pass.second->SetOption(kOptimizeAfterSubGraph, "");
+      }
+      const Status ret = RunPasses(id, true);
+      for (const auto &name_to_pass : names_to_passes_) {
+        name_to_pass.second->ClearOptions();
+      }
+      GE_CHK_STATUS_RET_NOLOG(ret);
+    }
+    return SUCCESS;
+  }
+
+  Status HandleLeakedSuspendNodes() {
+    bool has_suspend = false;
+    for (const auto &state : states_) {
+      has_suspend = has_suspend || (state.suspended && (!state.deleted));
+    }
+    if (!has_suspend) {
+      return SUCCESS;
+    }
+    for (size_t i = 0U; i < names_to_passes_.size(); ++i) {
+      BaseNodePass *const pass = names_to_passes_[i].second;
+      pass->init();
+      const Status ret = pass->OnSuspendNodesLeaked();
+      if (ret != SUCCESS) {
+        GELOGE(ret, "[Process][Pass] %s on suspend nodes leaked failed, result %u", statistics_[i].name.c_str(), ret);
+        return ret;
+      }
+      (void)CollectChanges(*pass);
+    }
+    return SUCCESS;
+  }
+
+  const NamesToPass &names_to_passes_;
+  std::vector<PassStatistics> statistics_;
+  std::unordered_map<Node *, uint32_t> ids_;
+  std::vector<NodePtr> nodes_;
+  std::vector<NodeState> states_;
+  std::vector<uint32_t> last_visits_;  // node id * pass num + pass index -> version of node at last visit
+  std::deque<uint32_t> worklist_;
+};
+
+inline Status RunPassesIncremental(const ComputeGraphPtr &graph, const ComputeGraphPtr &root_graph,
+                                   const NamesToPass &names_to_passes, std::vector<PassStatistics> &statistics,
+                                   const int32_t depth) {
+  if (depth > kMaxIncrementalPassDepth) {
+    REPORT_INNER_ERROR("E19999", "param depth:%d > %d(allow max subgraphs), check invalid", depth,
+                       kMaxIncrementalPassDepth);
+    GELOGE(PARAM_INVALID, "[Check][Param] The pass for root graph %s will be terminated because too many nesting"
+           " levels(%d) of subgraphs, last subgraph is %s", root_graph->GetName().c_str(), depth,
+           graph->GetName().c_str());
+    return PARAM_INVALID;
+  }
+  for (const auto &name_to_pass : names_to_passes) {
+    name_to_pass.second->OnStartPassGraph(graph);
+  }
+  const auto run_sub_graph = [&graph, &root_graph, &names_to_passes, &statistics, depth](
+      const NodePtr &node, bool &has_sub_graph) -> Status {
+    has_sub_graph = false;
+    for (const auto &name : node->GetOpDesc()->GetSubgraphInstanceNames()) {
+      const auto sub_graph = root_graph->GetSubgraph(name);
+      if (sub_graph == nullptr) {
+        GELOGW("Can not find the sub graph %s from node %s, the pass-process will skip it", name.c_str(),
+               node->GetName().c_str());
+        continue;
+      }
+      has_sub_graph = true;
+      GE_CHK_STATUS_RET_NOLOG(RunPassesIncremental(sub_graph, root_graph, names_to_passes, statistics, depth + 1));
+    }
+    for (const auto &name_to_pass : names_to_passes) {
+      name_to_pass.second->OnStartPassGraph(graph);
+    }
+    return SUCCESS;
+  };
+  IncrementalPassEngine engine(names_to_passes);
+  const Status ret = engine.Run(graph, run_sub_graph);
+  statistics.resize(names_to_passes.size());
+  for (size_t i = 0U; i < names_to_passes.size(); ++i) {
+    const PassStatistics &graph_statistics = engine.GetStatistics()[i];
+    statistics[i].name = graph_statistics.name;
+    statistics[i].time_us += graph_statistics.time_us;
+    statistics[i].visit_count += graph_statistics.visit_count;
+    statistics[i].change_count += graph_statistics.change_count;
+    statistics[i].skip_count += graph_statistics.skip_count;
+  }
+  return ret;
+}
+
+///
+/// Incremental counterpart of GEPass::Run: run passes on graph and its sub graphs with IncrementalPassEngine.
+/// statistics are summed over all graphs, one per pass in order of names_to_passes.
+///
+inline Status RunPassesIncremental(const ComputeGraphPtr &graph, const NamesToPass &names_to_passes,
+                                   std::vector<PassStatistics> &statistics) {
+  GE_CHECK_NOTNULL(graph);
+  statistics.clear();
+  return RunPassesIncremental(graph, graph, names_to_passes, statistics, 1);
+}
+
+inline Status GEPass::RunIncremental(const NamesToPass &names_to_passes) {
+  GE_CHECK_NOTNULL(graph_);
+  pass_statistics_.clear();
+  return RunPassesIncremental(graph_, root_graph_, names_to_passes, pass_statistics_, depth_);
+}
+}  // namespace ge
+
+#endif  // GE_GRAPH_PASSES_INCREMENTAL_PASS_ENGINE_H_
@@ -22,7 +22,12 @@
 
 #include "external/ge/ge_api_error_codes.h"
 
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/types.h"
+#include "graph/build/weight_dedup.h"
 #include "graph/compute_graph.h"
+#include "graph/utils/graph_utils.h"
 
 namespace ge {
 namespace multibatch {
@@ -60,6 +65,10 @@ class MultiBatchGraphCopyer {
   void SetDynamicType(const DynamicType dynamic_type) {
     dynamic_type_ = dynamic_type;
   }
+  // defaults to option kOptionShareConstWeight
+  void SetShareWeights(const bool share_weights) {
+    share_weights_ = share_weights;
+  }
   Status CopyGraph();
 
  private:
@@ -116,6 +125,43 @@ class MultiBatchGraphCopyer {
   NodePtr InsertMergeNode(const NodePtr &node, int index);
   Status CopyNodeInBatchBranch(const NodePtr &node);
 
+  /// Const nodes in batch branch, i.e. consts with control input from a node in branch, do not depend on shape.
+  /// With share_weights_ they are labeled out of batch branch, so every gear links to the origin const instead of
+  /// a copy. Their control inputs move to the nodes reading them, which are copied per gear.
+  /// CopyGraph calls it between LabelStatus and CreateNewNodes.
+  Status LabelSharedConstNodes() {
+    if (!share_weights_) {
+      return SUCCESS;
+    }
+    size_t shared_num = 0U;
+    for (const auto &node : origin_all_nodes_) {
+      if ((GetNodeStatus(node) != kNodeInBatchBranch) ||
+          ((node->GetType() != CONSTANT) && (node->GetType() != CONSTANTOP))) {
+        continue;
+      }
+      const InControlAnchorPtr in_ctrl_anchor = node->GetInControlAnchor();
+      GE_CHECK_NOTNULL(in_ctrl_anchor);
+      for (const auto &src_anchor : in_ctrl_anchor->GetPeerOutControlAnchors()) {
+        for (const auto &out_node : node->GetOutDataNodes()) {
+          const InControlAnchorPtr dst_anchor = out_node->GetInControlAnchor();
+          if (!src_anchor->IsLinkedWith(dst_anchor)) {
+            GE_CHK_GRAPH_STATUS_RET(GraphUtils::AddEdge(src_anchor, dst_anchor),
+                                    "[Add][ControlEdge] from %s to %s failed",
+                                    src_anchor->GetOwnerNode()->GetName().c_str(), out_node->GetName().c_str());
+          }
+        }
+        GE_CHK_GRAPH_STATUS_RET(GraphUtils::RemoveEdge(src_anchor, in_ctrl_anchor),
+                                "[Remove][ControlEdge] from %s to %s failed",
+                                src_anchor->GetOwnerNode()->GetName().c_str(), node->GetName().c_str());
+      }
+      origin_nodes_status_[node.get()] = kNodeOutBatchBranch;
+      ++shared_num;
+    }
+    GELOGI("Graph %s shares %zu const nodes across %zu gears", graph_->GetName().c_str(), shared_num,
+           shapes_.size());
+    return SUCCESS;
+  }
+
   // link edges functions
   Status LinkEdges();
   Status AddAttrForGetDynamicDims(const NodePtr &node);
@@ -177,6 +223,7 @@ class MultiBatchGraphCopyer {
 
   std::vector<std::pair<size_t, size_t>> getnext_sink_dynamic_out_mapping_;
   bool getnext_sink_dynamic_dims_ = false;
+  bool share_weights_ = IsShareConstWeightEnabled();
 };
 }  // namespace multibatch
 }  // namespace ge
@@ -51,6 +51,9 @@ class HybridModelExecutor {
   Status ExecuteGraphInternal(ExecuteArgs &args);
   Status Cleanup();
   Status InitExecutionContext();
+  Status InitExecutionArena() {
+    return context_.EnableExecutionArena();
+  }
   static Status ResetExecutionContext(GraphExecutionContext &context);
   static Status CheckInputShapeByShapeRange(const GraphItem *graph_item, HybridModelExecutor::ExecuteArgs &args);
 
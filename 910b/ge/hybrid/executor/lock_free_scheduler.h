@@ -0,0 +1,378 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_HYBRID_EXECUTOR_LOCK_FREE_SCHEDULER_H_
+#define GE_HYBRID_EXECUTOR_LOCK_FREE_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "framework/common/debug/ge_log.h"
+#include "framework/common/debug/log.h"
+#include "framework/common/ge_inner_error_codes.h"
+#include "hybrid/model/schedule_graph.h"
+
+namespace ge {
+namespace hybrid {
+/**
+ * Bounded multi-producer multi-consumer queue, each cell carries a sequence number so that
+ * producers and consumers only contend on one atomic index each.
+ */
+template <typename T>
+class MpmcQueue {
+ public:
+  explicit MpmcQueue(const size_t capacity) : mask_(RoundUpPowerOfTwo(capacity) - 1U), cells_(mask_ + 1U) {
+    for (size_t i = 0U; i < cells_.size(); ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  MpmcQueue(const MpmcQueue &) = delete;
+  MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+  bool TryPush(const T &value) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell &cell = cells_[pos & mask_];
+      const size_t seq = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed)) {
+          cell.value = value;
+          cell.sequence.store(pos + 1U, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // full
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool TryPop(T &value) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell &cell = cells_[pos & mask_];
+      const size_t seq = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1U);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed)) {
+          value = cell.value;
+          cell.sequence.store(pos + mask_ + 1U, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // empty
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  size_t Capacity() const {
+    return mask_ + 1U;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence{0U};
+    T value{};
+  };
+
+  static size_t RoundUpPowerOfTwo(const size_t value) {
+    size_t result = 2U;
+    while (result < value) {
+      result <<= 1U;
+    }
+    return result;
+  }
+
+  const size_t mask_;
+  std::vector<Cell> cells_;
+  alignas(64) std::atomic<size_t> enqueue_pos_{0U};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0U};
+};
+
+/**
+ * Ready queue of schedule mode kLockFree. Push and Pop do not take a lock while the queue is not empty,
+ * a consumer only sleeps after spinning on an empty queue.
+ */
+template <typename T>
+class LockFreeReadyQueue {
+ public:
+  explicit LockFreeReadyQueue(const size_t capacity) : queue_(capacity) {}
+
+  bool Push(const T &value) {
+    if (!queue_.TryPush(value)) {
+      GELOGE(INTERNAL_ERROR, "[Push][ReadyQueue] queue is full, capacity:%zu", queue_.Capacity());
+      return false;
+    }
+    (void)size_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+      {
+        const std::lock_guard<std::mutex> lock(mutex_);
+      }
+      cv_.notify_one();
+    }
+    return true;
+  }
+
+  /**
+   * @return false if queue is stopped and empty
+   */
+  bool Pop(T &value) {
+    uint32_t spin = 0U;
+    while (true) {
+      if (queue_.TryPop(value)) {
+        (void)size_.fetch_sub(1);
+        return true;
+      }
+      if (stopped_.load()) {
+        return false;
+      }
+      if (++spin < kSpinCount) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      (void)sleepers_.fetch_add(1);
+      cv_.wait(lock, [this]() { return (size_.load() > 0) || stopped_.load(); });
+      (void)sleepers_.fetch_sub(1);
+      spin = 0U;
+    }
+  }
+
+  void Stop() {
+    stopped_.store(true);
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_all();
+  }
+
+  void Restart() {
+    stopped_.store(false);
+  }
+
+ private:
+  static constexpr uint32_t kSpinCount = 64U;
+  MpmcQueue<T> queue_;
+  std::atomic<int64_t> size_{0};
+  std::atomic<int32_t> sleepers_{0};
+  std::atomic<bool> stopped_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+/**
+ * Run the nodes of a DAG on worker threads. A node becomes ready when the atomic counter of its pending inputs
+ * drops to zero, the only blocking wait is the caller waiting for the whole graph in Run.
+ */
+class LockFreeDagScheduler {
+ public:
+  using ExecuteFunc = std::function<Status(int32_t)>;
+
+  explicit LockFreeDagScheduler(const uint32_t thread_num) : thread_num_((thread_num == 0U) ? 1U : thread_num) {}
+  ~LockFreeDagScheduler() {
+    Finalize();
+  }
+  LockFreeDagScheduler(const LockFreeDagScheduler &) = delete;
+  LockFreeDagScheduler &operator=(const LockFreeDagScheduler &) = delete;
+
+  Status Init(const ScheduleGraph &graph) {
+    Finalize();
+    GE_CHK_STATUS_RET_NOLOG(CheckGraph(graph));
+    pending_.reset(new (std::nothrow) std::atomic<int32_t>[graph.NodeNum() + 1U]);
+    ready_queue_.reset(new (std::nothrow) LockFreeReadyQueue<int32_t>(graph.NodeNum() + 1U));
+    if ((pending_ == nullptr) || (ready_queue_ == nullptr)) {
+      GELOGE(MEMALLOC_FAILED, "[New][ScheduleState] failed, node num:%zu", graph.NodeNum());
+      pending_.reset();
+      ready_queue_.reset();
+      return MEMALLOC_FAILED;
+    }
+    // Run refuses to start until every allocation of Init succeeded, the graph is copied so that the caller
+    // can not change the checked degrees afterwards
+    graph_ = graph;
+    initialized_ = true;
+    for (uint32_t i = 0U; i < thread_num_; ++i) {
+      workers_.emplace_back(&LockFreeDagScheduler::WorkerFunc, this);
+    }
+    return SUCCESS;
+  }
+
+  /**
+   * Execute every node once in dependency order
+   * @param execute  called on worker threads with node index
+   * @return first error returned by execute, successors of a failed node are not executed
+   */
+  Status Run(const ExecuteFunc &execute) {
+    if (!initialized_) {
+      GELOGE(INTERNAL_ERROR, "[Check][Param] scheduler is not initialized");
+      return INTERNAL_ERROR;
+    }
+    const size_t node_num = graph_.NodeNum();
+    if (node_num == 0U) {
+      return SUCCESS;
+    }
+    execute_ = &execute;
+    status_.store(SUCCESS);
+    remaining_.store(static_cast<int64_t>(node_num));
+    {
+      const std::lock_guard<std::mutex> lock(done_mutex_);
+      done_ = false;
+    }
+    for (size_t i = 0U; i < node_num; ++i) {
+      pending_[i].store(graph_.in_degrees[i], std::memory_order_relaxed);
+    }
+    for (size_t i = 0U; i < node_num; ++i) {
+      if (graph_.in_degrees[i] == 0) {
+        (void)ready_queue_->Push(static_cast<int32_t>(i));
+      }
+    }
+    std::unique_lock<std::mutex> lock(done_mutex_);
+    done_cv_.wait(lock, [this]() { return done_; });
+    execute_ = nullptr;
+    return status_.load();
+  }
+
+  void Finalize() {
+    if (ready_queue_ != nullptr) {
+      ready_queue_->Stop();
+    }
+    for (auto &worker : workers_) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+    workers_.clear();
+    initialized_ = false;
+    graph_ = ScheduleGraph();
+  }
+
+ private:
+  /**
+   * Run counts every node down exactly once, so the degrees have to match the edges and every node has to be
+   * reachable from the nodes without inputs, otherwise Run would wait forever
+   */
+  static Status CheckGraph(const ScheduleGraph &graph) {
+    const size_t node_num = graph.NodeNum();
+    if ((graph.succ_offsets.size() != (node_num + 1U)) || (graph.succ_offsets[0U] != 0) ||
+        (static_cast<size_t>(graph.succ_offsets[node_num]) != graph.succs.size())) {
+      GELOGE(PARAM_INVALID, "[Check][Param] succ offsets size %zu, node num %zu, succ num %zu",
+             graph.succ_offsets.size(), node_num, graph.succs.size());
+      return PARAM_INVALID;
+    }
+    std::vector<int32_t> in_degrees(node_num, 0);
+    for (size_t i = 0U; i < node_num; ++i) {
+      if (graph.succ_offsets[i] > graph.succ_offsets[i + 1U]) {
+        GELOGE(PARAM_INVALID, "[Check][Param] succ offsets of node %zu are not ascending", i);
+        return PARAM_INVALID;
+      }
+      for (int32_t j = graph.succ_offsets[i]; j < graph.succ_offsets[i + 1U]; ++j) {
+        const int32_t succ = graph.succs[static_cast<size_t>(j)];
+        if ((succ < 0) || (static_cast<size_t>(succ) >= node_num)) {
+          GELOGE(PARAM_INVALID, "[Check][Param] successor %d of node %zu out of range, node num %zu", succ, i,
+                 node_num);
+          return PARAM_INVALID;
+        }
+        ++in_degrees[static_cast<size_t>(succ)];
+      }
+    }
+    std::vector<int32_t> ready;
+    for (size_t i = 0U; i < node_num; ++i) {
+      if (in_degrees[i] != graph.in_degrees[i]) {
+        GELOGE(PARAM_INVALID, "[Check][Param] in degree of node %zu is %d, but %d edges point to it", i,
+               graph.in_degrees[i], in_degrees[i]);
+        return PARAM_INVALID;
+      }
+      if (in_degrees[i] == 0) {
+        ready.emplace_back(static_cast<int32_t>(i));
+      }
+    }
+    size_t reached = 0U;
+    while (!ready.empty()) {
+      const size_t node = static_cast<size_t>(ready.back());
+      ready.pop_back();
+      ++reached;
+      for (int32_t j = graph.succ_offsets[node]; j < graph.succ_offsets[node + 1U]; ++j) {
+        const size_t succ = static_cast<size_t>(graph.succs[static_cast<size_t>(j)]);
+        if (--in_degrees[succ] == 0) {
+          ready.emplace_back(static_cast<int32_t>(succ));
+        }
+      }
+    }
+    if (reached != node_num) {
+      GELOGE(PARAM_INVALID, "[Check][Param] %zu of %zu nodes are not reachable, graph has cycle", node_num - reached,
+             node_num);
+      return PARAM_INVALID;
+    }
+    return SUCCESS;
+  }
+
+  void OnNodeDone(const int32_t node) {
+    for (int32_t i = graph_.succ_offsets[static_cast<size_t>(node)];
+         i < graph_.succ_offsets[static_cast<size_t>(node) + 1U]; ++i) {
+      const int32_t succ = graph_.succs[static_cast<size_t>(i)];
+      if (pending_[succ].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        (void)ready_queue_->Push(succ);
+      }
+    }
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      const std::lock_guard<std::mutex> lock(done_mutex_);
+      done_ = true;
+      done_cv_.notify_all();
+    }
+  }
+
+  static void WorkerFunc(LockFreeDagScheduler *const scheduler) {
+    int32_t node = -1;
+    while (scheduler->ready_queue_->Pop(node)) {
+      if (scheduler->status_.load(std::memory_order_relaxed) == SUCCESS) {
+        const Status ret = (*scheduler->execute_)(node);
+        if (ret != SUCCESS) {
+          Status expected = SUCCESS;
+          (void)scheduler->status_.compare_exchange_strong(expected, ret);
+          GELOGE(ret, "[Execute][Node] index %d failed, skip the rest of graph", node);
+        }
+      }
+      // successors of failed node are still counted down, so that Run returns once every node is passed
+      scheduler->OnNodeDone(node);
+    }
+  }
+
+  const uint32_t thread_num_;
+  ScheduleGraph graph_;
+  bool initialized_ = false;
+  const ExecuteFunc *execute_ = nullptr;
+  std::unique_ptr<std::atomic<int32_t>[]> pending_;
+  std::unique_ptr<LockFreeReadyQueue<int32_t>> ready_queue_;
+  std::vector<std::thread> workers_;
+  std::atomic<Status> status_{SUCCESS};
+  std::atomic<int64_t> remaining_{0};
+  std::mutex done_mutex_;
+  std::condition_variable done_cv_;
+  bool done_ = false;
+};
+}  // namespace hybrid
+}  // namespace ge
+#endif  // GE_HYBRID_EXECUTOR_LOCK_FREE_SCHEDULER_H_
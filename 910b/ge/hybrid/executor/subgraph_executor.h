@@ -17,11 +17,16 @@
 #ifndef GE_HYBRID_EXECUTOR_EXECUTOR_SUBGRAPH_EXECUTOR_H_
 #define GE_HYBRID_EXECUTOR_EXECUTOR_SUBGRAPH_EXECUTOR_H_
 
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
 #include <vector>
 
 #include "common/blocking_queue.h"
 #include "common/thread_pool.h"
 #include "hybrid/executor/subgraph_context.h"
+#include "hybrid/executor/lock_free_scheduler.h"
 #include "hybrid/executor/node_state.h"
 #include "hybrid/executor/hybrid_execution_context.h"
 #include "hybrid/executor/worker/shape_inference_engine.h"
@@ -52,7 +57,9 @@ class SubgraphExecutor {
    * @return SUCCESS on success, error code otherwise
    */
   Status ExecuteAsync(const std::vector<TensorValue> &inputs,
-                      const std::vector<ConstGeTensorDescPtr> &input_desc);
+                      const std::vector<ConstGeTensorDescPtr> &input_desc) {
+    return ExecuteAsync(inputs, input_desc, {});
+  }
 
   /**
    * Execute subgraph async, output tensor address(not data) and output tensor descriptions are
@@ -63,7 +70,35 @@ class SubgraphExecutor {
    */
   Status ExecuteAsync(const std::vector<TensorValue> &inputs,
                       const std::vector<ConstGeTensorDescPtr> &input_desc,
-                      const std::vector<TensorValue> &outputs);
+                      const std::vector<TensorValue> &outputs) {
+    GELOGD("[%s] is dynamic = %s", graph_item_->GetName().c_str(), graph_item_->IsDynamic() ? "true" : "false");
+    if ((context_->model != nullptr) && (graph_item_ == context_->model->GetRootGraphItem())) {
+      context_->ResetExecutionArena();
+    }
+    GE_CHK_STATUS_RET(Init(inputs, input_desc), "[Invoke][Init]failed for [%s].", graph_item_->GetName().c_str());
+    if (!outputs.empty()) {
+      GE_CHK_STATUS_RET(EnableOutputZeroCopy(outputs),
+                        "[Invoke][EnableOutputZeroCopy] Failed by user provided outputs.");
+    }
+    if (!graph_item_->IsDynamic()) {
+      return ExecuteAsyncForKnownShape(inputs);
+    }
+    if (!shape_memo_inited_) {
+      EnableShapeMemo(kShapeMemoDefaultMaxRecords);
+    }
+    if (shape_inference_engine_ != nullptr) {
+      shape_inference_engine_->SetShapeMemo(shape_memo_.get());
+      GE_CHK_STATUS_RET(shape_inference_engine_->ReplayShapes(input_desc), "[Replay][Shapes] failed for [%s].",
+                        graph_item_->GetName().c_str());
+    }
+    const Status ret = ScheduleTasks();
+    if (shape_inference_engine_ != nullptr) {
+      shape_inference_engine_->CommitShapes(ret);
+    }
+    HYBRID_CHK_STATUS_RET(ret, "[%s] Failed to execute tasks.", graph_item_->GetName().c_str());
+    GELOGD("[%s] Done executing subgraph successfully.", graph_item_->GetName().c_str());
+    return SUCCESS;
+  }
 
   /**
    * Execute subgraph async, output tensor address(not data) and output tensor descriptions are
@@ -94,6 +129,71 @@ class SubgraphExecutor {
    */
   Status GetOutputs(std::vector<TensorValue> &outputs, std::vector<ConstGeTensorDescPtr> &output_desc);
 
+  /**
+   * Memoize shapes of the whole subgraph by input shapes, on repeated input shapes the recorded output shapes of all
+   * nodes are replayed in one pass instead of inferring them. Subgraphs with value dependent shapes keep inferring.
+   * Enabled with kShapeMemoDefaultMaxRecords on first ExecuteAsync unless set before
+   * @param max_records     max number of input shape signatures recorded, 0 to disable
+   */
+  void EnableShapeMemo(const size_t max_records) {
+    shape_memo_inited_ = true;
+    shape_memo_.reset();
+    if ((max_records == 0U) || (graph_item_ == nullptr)) {
+      return;
+    }
+    std::string reason;
+    if (!SubgraphShapeMemo::IsMemoizable(*graph_item_, reason)) {
+      GELOGI("[%s] shape memo disabled, %s", graph_item_->GetName().c_str(), reason.c_str());
+      return;
+    }
+    shape_memo_.reset(new (std::nothrow) SubgraphShapeMemo(max_records));
+    if (shape_memo_ != nullptr) {
+      shape_memo_->Init(*graph_item_);
+    }
+  }
+
+  const SubgraphShapeMemo *GetShapeMemo() const {
+    return shape_memo_.get();
+  }
+
+  /**
+   * Schedule nodes by atomic count of pending inputs on a lock free ready queue instead of the blocking queues.
+   * Subgraphs with control flow keep the default schedule, Merge and Switch are not ready by a count of inputs
+   * @param thread_num      number of scheduler threads, 0 to disable, must be set before execution
+   * @return SUCCESS on success, error code otherwise
+   */
+  Status EnableLockFreeSchedule(const uint32_t thread_num) {
+    lock_free_scheduler_.reset();
+    if ((thread_num == 0U) || (graph_item_ == nullptr)) {
+      return SUCCESS;
+    }
+    if (graph_item_->HasCtrlFlowOp()) {
+      GELOGI("[%s] lock free schedule disabled, subgraph has control flow op", graph_item_->GetName().c_str());
+      return SUCCESS;
+    }
+    const FlatGraphLayout &layout = graph_item_->GetFlatLayout();
+    if (layout.NodeNum() != graph_item_->GetAllNodes().size()) {
+      GELOGE(INTERNAL_ERROR, "[Check][FlatLayout] graph:%s, layout node num %zu, node num %zu, layout not built",
+             graph_item_->GetName().c_str(), layout.NodeNum(), graph_item_->GetAllNodes().size());
+      return INTERNAL_ERROR;
+    }
+    lock_free_scheduler_.reset(new (std::nothrow) LockFreeDagScheduler(thread_num));
+    GE_CHECK_NOTNULL(lock_free_scheduler_);
+    const Status ret = lock_free_scheduler_->Init(layout.GetScheduleGraph());
+    if (ret != SUCCESS) {
+      GELOGE(ret, "[Init][LockFreeScheduler] failed, graph:%s", graph_item_->GetName().c_str());
+      lock_free_scheduler_.reset();
+      return ret;
+    }
+    GELOGI("[%s] lock free schedule enabled, node num:%zu, thread num:%u", graph_item_->GetName().c_str(),
+           layout.NodeNum(), thread_num);
+    return SUCCESS;
+  }
+
+  bool IsLockFreeSchedule() const {
+    return lock_free_scheduler_ != nullptr;
+  }
+
  private:
   Status PrepareForExecution(GraphExecutionContext *ctx, NodeState &node_state);
   Status EnableOutputZeroCopy(const std::vector<TensorValue> &outputs);
@@ -105,6 +205,20 @@ class SubgraphExecutor {
   Status InitInputsForKnownShape(const std::vector<TensorValue> &inputs);
   Status ExecuteAsyncForKnownShape(const std::vector<TensorValue> &inputs);
   Status ScheduleTasks(int group = -1);
+
+  /**
+   * Execute every node of the subgraph once on the lock free scheduler, taken by ScheduleTasks when enabled
+   * @param execute         prepares and launches one node, called on scheduler threads
+   * @return first error returned by execute
+   */
+  Status ScheduleTasksLockFree(const std::function<Status(const NodeItem &)> &execute) {
+    GE_CHECK_NOTNULL(lock_free_scheduler_);
+    const FlatGraphLayout &layout = graph_item_->GetFlatLayout();
+    return lock_free_scheduler_->Run([&layout, &execute](const int32_t index) -> Status {
+      return execute(*layout.GetNodeItem(index));
+    });
+  }
+
   Status PrepareNodes(int group = -1);
   Status LaunchTasks();
   Status SetOutputsToParentNode(TaskContext &task_context);
@@ -129,10 +243,14 @@ class SubgraphExecutor {
   bool own_thread_pool_;
   BlockingQueue<NodeState *> ready_queue_;
   std::unique_ptr<ShapeInferenceEngine> shape_inference_engine_;
+  std::unique_ptr<SubgraphShapeMemo> shape_memo_;  // outlives shape_inference_engine_ of each execution
+  bool shape_memo_inited_ = false;
 
   std::mutex mu_; // Guard for prepare_queues_.
   std::map<int, BlockingQueue<const NodeItem *>> prepare_queues_;
   BlockingQueue<NodeState *> schedule_queue_;
+
+  std::unique_ptr<LockFreeDagScheduler> lock_free_scheduler_;
 };
 }  // namespace hybrid
 }  // namespace ge
@@ -17,9 +17,14 @@
 #ifndef GE_HYBRID_EXECUTOR_INFERSHAPE_SHAPE_INFERENCE_ENGINE_H_
 #define GE_HYBRID_EXECUTOR_INFERSHAPE_SHAPE_INFERENCE_ENGINE_H_
 
+#include "framework/common/debug/log.h"
+#include "graph/shape_refiner.h"
 #include "hybrid/executor/hybrid_execution_context.h"
 #include "hybrid/executor/subgraph_context.h"
+#include "hybrid/executor/worker/subgraph_shape_memo.h"
+#include <chrono>
 #include <mutex>
+#include <vector>
 
 namespace ge {
 namespace hybrid {
@@ -28,7 +33,71 @@ class ShapeInferenceEngine {
   ShapeInferenceEngine(GraphExecutionContext *execution_context, SubgraphContext *subgraph_context);
   ~ShapeInferenceEngine() = default;
 
-  Status InferShape(NodeState &node_state);
+  Status InferShape(NodeState &node_state) {
+    // Wait for all input shape become valid
+    GE_CHK_STATUS_RET_NOLOG(node_state.GetShapeInferenceState().AwaitShapesReady(*execution_context_));
+
+    auto &node_item = *node_state.GetNodeItem();
+
+    // Wait for "const input nodes" if node's shape inference function requires any.
+    // Even if output shape is static, there are cases that the const-input will be used in OpTiling and Execution
+    GE_CHK_STATUS_RET_NOLOG(AwaitDependentNodes(node_state));
+    if (node_item.is_output_shape_static) {
+      return SUCCESS;
+    }
+
+    // every dynamic node of a replayed record took its output descs in ReplayShapes
+    if (shapes_replayed_) {
+      GELOGD("[%s] Skipping node with replayed shapes", node_item.NodeName().c_str());
+      return SUCCESS;
+    }
+
+    const auto infer_begin = std::chrono::steady_clock::now();
+    if (node_item.fused_subgraph != nullptr) {
+      GE_CHK_STATUS_RET_NOLOG(InferShapeForSubgraph(node_item, *node_item.fused_subgraph));
+      GE_CHK_STATUS_RET_NOLOG(CalcOutputTensorSizes(node_item));
+      RecordNodeShapes(node_item, ElapsedUs(infer_begin));
+      return SUCCESS;
+    }
+
+    // Skip shape inference for node of type DEPEND_COMPUTE
+    if (node_item.shape_inference_type == DEPEND_COMPUTE) {
+      GELOGD("[%s] Skipping node with unknown shape type DEPEND_COMPUTE", node_item.NodeName().c_str());
+      return SUCCESS;
+    }
+
+    // Clear shape range in case shape inference func forgot to do it
+    if (node_item.shape_inference_type == DEPEND_SHAPE_RANGE) {
+      // in case InferShape does not set shape range
+      for (auto &tensor_desc : node_item.op_desc->GetAllOutputsDescPtr()) {
+        tensor_desc->SetShapeRange({});
+      }
+    }
+
+    // Do shape inference
+    GELOGD("[%s] Start to invoke InferShapeAndType", node_item.NodeName().c_str());
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      RECORD_SHAPE_INFERENCE_EVENT(execution_context_, node_item.NodeName().c_str(), "[InferShapeAndType] Start");
+      GE_CHK_STATUS_RET(ShapeRefiner::InferShapeAndTypeForRunning(node_item.node, true),
+                        "[Invoke][InferShapeAndType] for %s failed.", node_item.NodeName().c_str());
+      RECORD_SHAPE_INFERENCE_EVENT(execution_context_, node_item.NodeName().c_str(), "[InferShapeAndType] End");
+    }
+
+    // update output tensor sizes after shape inference
+    // error if shape is still unknown and not of type DEPEND_SHAPE_RANGE
+    RECORD_COMPILE_EVENT(execution_context_, node_item.NodeName().c_str(), "[CalcOpRunningParam] Start");
+    GE_CHK_STATUS_RET_NOLOG(CalcOutputTensorSizes(node_item, node_item.shape_inference_type == DEPEND_SHAPE_RANGE));
+    RECORD_COMPILE_EVENT(execution_context_, node_item.NodeName().c_str(), "[CalcOpRunningParam] End");
+    RecordNodeShapes(node_item, ElapsedUs(infer_begin));
+
+    GELOGD("[%s] [HybridTrace] After shape inference. Node = %s",
+           node_item.NodeName().c_str(),
+           node_item.DebugString().c_str());
+
+    GELOGD("[%s] InferShapeAndType finished successfully.", node_item.NodeName().c_str());
+    return SUCCESS;
+  }
 
   Status InferShapeForSubgraph(const NodeItem &node_item, const FusedSubgraph &fused_subgraph);
 
@@ -36,15 +105,87 @@ class ShapeInferenceEngine {
 
   static Status CalcOutputTensorSizes(const NodeItem &node_item, bool fallback_with_range = false);
 
+  /**
+   * Memoize shapes of the whole subgraph, shape_memo is owned by the subgraph executor and outlives iterations
+   * @param shape_memo      memo of the subgraph, nullptr to infer every node
+   */
+  void SetShapeMemo(SubgraphShapeMemo *shape_memo) {
+    shape_memo_ = shape_memo;
+  }
+
+  /**
+   * Look up memoized shapes of the subgraph before any node is scheduled. On a hit the recorded output descs of
+   * all nodes are written in one pass and taken into their ShapeInferenceState, InferShape then skips inference and
+   * PropagateOutputShapes still runs so that consumers get their input shapes and pending shape counts.
+   * On a miss inferred nodes are recorded
+   * @param input_desc      input tensor descriptions of the subgraph
+   * @return SUCCESS on success, error code otherwise
+   */
+  Status ReplayShapes(const std::vector<ConstGeTensorDescPtr> &input_desc) {
+    shapes_replayed_ = false;
+    if (shape_memo_ == nullptr) {
+      return SUCCESS;
+    }
+    shapes_replayed_ = shape_memo_->Replay(input_desc);
+    if (shapes_replayed_) {
+      const std::lock_guard<std::mutex> lk(mu_);
+      const Status ret = shape_memo_->ReplayRecord([this](const NodeItem &node_item) -> Status {
+        const NodeStatePtr node_state = subgraph_context_->GetOrCreateNodeState(&node_item);
+        GE_CHECK_NOTNULL(node_state);
+        return node_state->GetShapeInferenceState().UpdateOutputDesc();
+      });
+      if (ret != SUCCESS) {
+        GELOGE(ret, "[Replay][Shapes] failed, partially replayed shapes can not fall back to inference");
+        shapes_replayed_ = false;
+        return ret;
+      }
+    }
+    const SubgraphShapeMemoStatistics statistics = shape_memo_->GetStatistics();
+    RECORD_SHAPE_INFERENCE_EVENT(execution_context_, nullptr, "[SubgraphShapeMemo] [%s] hit = %lu, miss = %lu, "
+                                 "saved = %lu us", shapes_replayed_ ? "Replayed" : "Recording", statistics.hit_count,
+                                 statistics.miss_count, statistics.saved_us);
+    return SUCCESS;
+  }
+
+  bool IsShapesReplayed() const {
+    return shapes_replayed_;
+  }
+
+  // called by InferShape after output tensor sizes of a dynamic node are calculated
+  void RecordNodeShapes(const NodeItem &node_item, const uint64_t infer_cost_us) {
+    if ((shape_memo_ != nullptr) && (!shapes_replayed_)) {
+      shape_memo_->RecordNode(node_item, infer_cost_us);
+    }
+  }
+
+  // end of subgraph, failed executions drop the record of a miss
+  void CommitShapes(const Status status) {
+    if ((shape_memo_ == nullptr) || shapes_replayed_) {
+      return;
+    }
+    if (status != SUCCESS) {
+      shape_memo_->Abandon();
+      return;
+    }
+    shape_memo_->Commit();
+  }
+
  private:
   static Status CanonicalizeShape(GeTensorDesc &tensor_desc, std::vector<int64_t> &shape, bool fallback_with_range);
   static Status CalcTensorSize(DataType data_type, const std::vector<int64_t> &shape, int64_t &tensor_size);
   static Status UpdatePeerNodeShape(const Node &node);
   Status AwaitDependentNodes(NodeState &node_state);
 
+  static uint64_t ElapsedUs(const std::chrono::steady_clock::time_point &begin) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+  }
+
   GraphExecutionContext *execution_context_;
   SubgraphContext *subgraph_context_;
   std::mutex mu_;
+  SubgraphShapeMemo *shape_memo_ = nullptr;
+  bool shapes_replayed_ = false;
 };
 }  // namespace hybrid
 }  // namespace ge
@@ -18,6 +18,7 @@
 #define GE_HYBRID_MODEL_SUBGRAPH_ITEM_H_
 
 #include "external/ge/ge_api_error_codes.h"
+#include "hybrid/model/flat_graph_layout.h"
 #include "hybrid/model/node_item.h"
 
 namespace ge {
@@ -65,6 +66,18 @@ class GraphItem {
   int GetParentOutputIndex(size_t index) const;
   const vector<int> &GetInputIndexMapping() const;
 
+  /**
+   * Build flat layout from node items, must be called after all nodes of the graph are linked and
+   * again whenever the links change, the layout is empty until then
+   */
+  Status BuildFlatLayout() {
+    return flat_layout_.Build(node_items_);
+  }
+
+  const FlatGraphLayout &GetFlatLayout() const {
+    return flat_layout_;
+  }
+
  private:
   friend class HybridModelBuilder;
   Status GroupNodes(const std::vector<NodeItem *> &node_items,
@@ -86,6 +99,7 @@ class GraphItem {
   bool has_ctrl_flow_op_ = false;
   std::vector<int> input_index_mapping_;
   std::vector<int> output_index_mapping_;
+  FlatGraphLayout flat_layout_;
 };
 }  // namespace hybrid
 }  // namespace ge
@@ -97,6 +97,18 @@ class HybridModelBuilder {
   Status OptimizeDependenciesForConstantInputs();
   Status Convert2HostTensor(const NodePtr &node, int node_id, uint32_t output_idx);
 
+  // called by Build once every graph item is linked, the executor reads the layouts instead of the node items
+  Status BuildFlatLayouts() {
+    if (hybrid_model_.root_graph_item_ != nullptr) {
+      GE_CHK_STATUS_RET(hybrid_model_.root_graph_item_->BuildFlatLayout(), "[Build][FlatLayout] failed, graph:%s",
+                        hybrid_model_.root_graph_item_->GetName().c_str());
+    }
+    for (const auto &it : hybrid_model_.subgraph_items_) {
+      GE_CHK_STATUS_RET(it.second->BuildFlatLayout(), "[Build][FlatLayout] failed, graph:%s", it.first.c_str());
+    }
+    return SUCCESS;
+  }
+
   Status RelinkNextIteration();
   Status BuildProfilingControl(GraphItem &graph_item, const std::map<size_t, std::pair<uint32_t, uint32_t>> &nodes);
   Status BuildFrameGroupIndex(NodeItem &node_item);
@@ -0,0 +1,39 @@
+/**
+ * Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GE_HYBRID_MODEL_SCHEDULE_GRAPH_H_
+#define GE_HYBRID_MODEL_SCHEDULE_GRAPH_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace ge {
+namespace hybrid {
+/**
+ * Immutable dependency graph of one schedule, successors in CSR layout
+ */
+struct ScheduleGraph {
+  std::vector<int32_t> in_degrees;
+  std::vector<int32_t> succ_offsets;  // size is node num + 1
+  std::vector<int32_t> succs;
+
+  size_t NodeNum() const {
+    return in_degrees.size();
+  }
+};
+}  // namespace hybrid
+}  // namespace ge
+#endif  // GE_HYBRID_MODEL_SCHEDULE_GRAPH_H_
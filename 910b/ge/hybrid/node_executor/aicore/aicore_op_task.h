@@ -17,9 +17,17 @@
 #ifndef GE_HYBRID_KERNEL_AICORE_OP_TASK_H_
 #define GE_HYBRID_KERNEL_AICORE_OP_TASK_H_
 
+#include <atomic>
 #include <memory>
+#include <new>
+#include <string>
+#include <utility>
 #include <vector>
+#include "common/shape_keyed_cache.h"
+#include "framework/common/debug/log.h"
 #include "framework/common/ge_inner_error_codes.h"
+#include "framework/common/types.h"
+#include "graph/runtime_inference_context.h"
 #include "runtime/stream.h"
 #include "hybrid/common/tensor_value.h"
 #include "hybrid/node_executor/task_context.h"
@@ -54,6 +62,16 @@ class TbeHandleRegistry {
   std::set<std::unique_ptr<TbeHandleHolder>> registered_handles_;
 };
 
+constexpr size_t kTilingCacheMaxEntries = 32U;
+constexpr size_t kTilingCacheMaxBytes = 64U * 1024U;
+
+// hit and miss of tiling caches of all nodes, for profiling and dump of the process
+struct AiCoreTilingCacheCounters {
+  std::atomic<uint64_t> hit_count{0UL};
+  std::atomic<uint64_t> miss_count{0UL};
+  std::atomic<uint64_t> uncacheable_count{0UL};  // runs without key, e.g. depend values not on host
+};
+
 class AiCoreOpTask {
  public:
   AiCoreOpTask() = default;
@@ -82,8 +100,203 @@ class AiCoreOpTask {
 
   virtual const std::string& GetOpType() const;
 
+  // tiling cache of the node, bounded by entry number and bytes of tiling data and workspace sizes, 0 entries
+  // disables it. Values tiling reads are those of the producers the node depends on for shape inference
+  void EnableTilingCache(const NodeItem &node_item, const size_t max_entries = kTilingCacheMaxEntries,
+                         const size_t max_bytes = kTilingCacheMaxBytes) {
+    tiling_cache_inited_ = true;
+    tiling_cache_key_.Clear();
+    uploaded_tiling_key_.clear();
+    tiling_depend_outputs_.clear();
+    tiling_cache_.reset((max_entries == 0U) ? nullptr :
+                        new (std::nothrow) ShapeKeyedCache<TbeLaunchCacheEntry>(max_entries, max_bytes));
+    if (tiling_cache_ == nullptr) {
+      return;
+    }
+    for (const auto &in_anchor : node_item.node->GetAllInDataAnchors()) {
+      const auto peer_anchor = (in_anchor == nullptr) ? nullptr : in_anchor->GetPeerOutAnchor();
+      if ((peer_anchor == nullptr) || (peer_anchor->GetOwnerNode() == nullptr)) {
+        continue;
+      }
+      const NodePtr &src_node = peer_anchor->GetOwnerNode();
+      // values of const inputs are fixed for the node
+      if ((src_node->GetType() == CONSTANT) || (src_node->GetType() == CONSTANTOP)) {
+        continue;
+      }
+      for (const auto &depend_node : node_item.dependents_for_shape_inference) {
+        if (depend_node == src_node) {
+          tiling_depend_outputs_.emplace_back(src_node->GetOpDesc()->GetId(), peer_anchor->GetIdx());
+          break;
+        }
+      }
+    }
+  }
+
+  // results saved before are stale, e.g. kernel or tiling buffer is replaced
+  void InvalidateTilingCache() {
+    if (tiling_cache_ != nullptr) {
+      tiling_cache_->Invalidate();
+    }
+    uploaded_tiling_key_.clear();
+  }
+
+  const ShapeKeyedCacheStatistics *GetTilingCacheStatistics() const {
+    return (tiling_cache_ == nullptr) ? nullptr : &tiling_cache_->GetStatistics();
+  }
+
+  static AiCoreTilingCacheCounters &GetTilingCacheCounters() {
+    static AiCoreTilingCacheCounters counters;
+    return counters;
+  }
+
  protected:
-  Status UpdateTilingInfo(TaskContext &context);
+  // key of input and output shapes and of values tiling depends on,
+  // returns false if the node is not cached or a depend value is not in the runtime inference context
+  bool BuildTilingCacheKey(TaskContext &context) {
+    tiling_cache_key_.Clear();
+    if (tiling_cache_ == nullptr) {
+      return false;
+    }
+    bool cacheable = true;
+    for (int32_t i = 0; cacheable && (i < context.NumInputs()); ++i) {
+      const auto tensor_desc = context.GetInputDesc(i);
+      cacheable = (tensor_desc != nullptr);
+      if (cacheable) {
+        tiling_cache_key_.AddTensor(*tensor_desc);
+      }
+    }
+    for (int32_t i = 0; cacheable && (i < context.NumOutputs()); ++i) {
+      const auto tensor_desc = context.GetOutputDesc(i);
+      cacheable = (tensor_desc != nullptr);
+      if (cacheable) {
+        tiling_cache_key_.AddTensor(*tensor_desc);
+      }
+    }
+    RuntimeInferenceContext *runtime_context = nullptr;
+    if (cacheable && (!tiling_depend_outputs_.empty())) {
+      cacheable = (RuntimeInferenceContext::GetContext(std::to_string(context.GetExecutionContext()->context_id),
+                                                       &runtime_context) == GRAPH_SUCCESS) &&
+                  (runtime_context != nullptr);
+    }
+    for (size_t i = 0U; cacheable && (i < tiling_depend_outputs_.size()); ++i) {
+      GeTensorPtr value;
+      cacheable = (runtime_context->GetTensor(tiling_depend_outputs_[i].first, tiling_depend_outputs_[i].second,
+                                              value) == GRAPH_SUCCESS) && (value != nullptr);
+      if (cacheable) {
+        tiling_cache_key_.AddBytes(value->GetData().GetData(), value->GetData().GetSize());
+      }
+    }
+    if (!cacheable) {
+      tiling_cache_key_.Clear();
+      (void)GetTilingCacheCounters().uncacheable_count.fetch_add(1UL);
+    }
+    return cacheable;
+  }
+
+  // on hit, tiling data, block dim, tiling key, atomic clean decision and workspace sizes are those saved for the key
+  bool RestoreLaunchState(OpDesc &op_desc) {
+    if ((tiling_cache_ == nullptr) || tiling_cache_key_.Key().empty()) {
+      return false;
+    }
+    const TbeLaunchCacheEntry *const entry = tiling_cache_->Find(tiling_cache_key_.Key());
+    if (entry == nullptr) {
+      (void)GetTilingCacheCounters().miss_count.fetch_add(1UL);
+      return false;
+    }
+    (void)GetTilingCacheCounters().hit_count.fetch_add(1UL);
+    tiling_data_ = entry->tiling_data;
+    block_dim_ = entry->block_dim;
+    tiling_key_ = entry->tiling_key;
+    clear_atomic_ = entry->clear_atomic;
+    if (CalcsWorkspaces()) {
+      op_desc.SetWorkspaceBytes(entry->workspace_sizes);
+    }
+    return true;
+  }
+
+  // called after CalcTilingInfo of a miss, args are rebuilt by UpdateArgs on each launch and not saved
+  void SaveLaunchState(const OpDesc &op_desc) {
+    if ((tiling_cache_ == nullptr) || tiling_cache_key_.Key().empty()) {
+      return;
+    }
+    TbeLaunchCacheEntry entry;
+    entry.tiling_data = tiling_data_;
+    entry.block_dim = block_dim_;
+    entry.tiling_key = tiling_key_;
+    entry.clear_atomic = clear_atomic_;
+    if (CalcsWorkspaces()) {
+      entry.workspace_sizes = op_desc.GetWorkspaceBytes();
+    }
+    const size_t bytes = entry.Bytes();
+    (void)tiling_cache_->Insert(tiling_cache_key_.Key(), std::move(entry), bytes);
+  }
+
+  // tiling through the cache of the node, the upload to tiling buffer is skipped if it holds data of the same key
+  // whether CalcTilingInfo sets workspace sizes of the node, they are saved and restored with the tiling data
+  virtual bool CalcsWorkspaces() const {
+    return true;
+  }
+
+  Status UpdateTilingInfo(TaskContext &context) {
+    auto node = context.GetNodeItem().node;
+    GE_CHECK_NOTNULL(node);
+    auto op_desc = node->GetOpDesc();
+    GE_CHECK_NOTNULL(op_desc);
+    GELOGD("[%s] Start to update tiling info for task: [%s]", node->GetName().c_str(), stub_name_.c_str());
+    auto execution_context = context.GetExecutionContext();
+    if (!tiling_cache_inited_) {
+      EnableTilingCache(context.GetNodeItem());
+    }
+    const bool cacheable = BuildTilingCacheKey(context);
+    const AiCoreTilingCacheCounters &counters = GetTilingCacheCounters();
+    if (cacheable && RestoreLaunchState(*op_desc)) {
+      RECORD_EXECUTION_EVENT(execution_context, context.GetNodeName(), "[TilingCache] Hit, hit:%lu, miss:%lu, "
+                             "uncacheable:%lu", counters.hit_count.load(), counters.miss_count.load(),
+                             counters.uncacheable_count.load());
+    } else {
+      optiling::utils::OpRunInfo tiling_info(-1, true, 0);
+      RECORD_EXECUTION_EVENT(execution_context, context.GetNodeName(), "[CalcTilingInfo] Start");
+      GE_CHK_STATUS_RET(CalcTilingInfo(node, tiling_info), "[Calc][TilingInfo]failed.");
+      RECORD_EXECUTION_EVENT(execution_context, context.GetNodeName(), "[CalcTilingInfo] End");
+      // update op args by tiling info
+      block_dim_ = tiling_info.GetBlockDim();
+      clear_atomic_ = tiling_info.GetClearAtomic();
+      tiling_data_ = tiling_info.GetAllTilingData().str();
+      tiling_key_ = tiling_info.GetTilingKey();
+      GELOGD("Successfully getting [tiling_key] : %u", tiling_key_);
+      SaveLaunchState(*op_desc);
+      RECORD_EXECUTION_EVENT(execution_context, context.GetNodeName(), "[TilingCache] Miss, hit:%lu, miss:%lu, "
+                             "uncacheable:%lu", counters.hit_count.load(), counters.miss_count.load(),
+                             counters.uncacheable_count.load());
+    }
+    if (tiling_data_.empty()) {
+      GELOGD("[%s] Tiling data is empty.", op_desc->GetName().c_str());
+      uploaded_tiling_key_.clear();
+      return SUCCESS;
+    }
+    if (tiling_buffer_ == nullptr) {
+      GELOGE(INTERNAL_ERROR, "[Check][Param] tiling_buffer is nullptr while tiling_data is not empty!");
+      return INTERNAL_ERROR;
+    }
+    if (tiling_data_.size() > tiling_buffer_->GetSize()) {
+      GELOGE(INTERNAL_ERROR, "[Check][Size][%s] Tiling data size now (%zu)"
+             "shouldn't larger than we alloc before (%zu).",
+             stub_name_.c_str(), tiling_data_.size(), tiling_buffer_->GetSize());
+      return INTERNAL_ERROR;
+    }
+    if (cacheable && (uploaded_tiling_key_ == tiling_cache_key_.Key())) {
+      GELOGD("[%s] Tiling buffer already holds tiling data of the shapes.", node->GetName().c_str());
+      return SUCCESS;
+    }
+    RECORD_EXECUTION_EVENT(execution_context, context.GetNodeName(), "[CopyTilingInfo] Start");
+    GE_CHK_RT_RET(rtMemcpy(tiling_buffer_->GetData(), tiling_buffer_->GetSize(), tiling_data_.c_str(),
+                           tiling_data_.size(), RT_MEMCPY_HOST_TO_DEVICE));
+    RECORD_EXECUTION_EVENT(execution_context, context.GetNodeName(), "[CopyTilingInfo] End");
+    uploaded_tiling_key_ = cacheable ? tiling_cache_key_.Key() : std::string();
+    GELOGD("[%s] Done updating tiling info for task: [%s]", node->GetName().c_str(), stub_name_.c_str());
+    return SUCCESS;
+  }
+
   virtual std::string GetKeyForOpParamSize() const;
   virtual std::string GetKeyForTbeKernel() const;
   virtual std::string GetKeyForTvmMagic() const;
@@ -122,6 +335,11 @@ class AiCoreOpTask {
   std::string log_name_;
   uint32_t offset_ = 0;
   std::string op_type_;
+  bool tiling_cache_inited_ = false;
+  std::unique_ptr<ShapeKeyedCache<TbeLaunchCacheEntry>> tiling_cache_;
+  ShapeSignature tiling_cache_key_;
+  std::string uploaded_tiling_key_;  // key of tiling data in tiling_buffer_
+  std::vector<std::pair<int64_t, int32_t>> tiling_depend_outputs_;  // node id and output index of values tiling reads
 };
 
 class AtomicAddrCleanOpTask : public AiCoreOpTask {
@@ -137,6 +355,10 @@ class AtomicAddrCleanOpTask : public AiCoreOpTask {
   std::string GetKeyForTvmMetaData() const override;
   std::string GetKeyForKernelName(const OpDesc &op_desc) const override;
   Status CalcTilingInfo(const NodePtr &node, optiling::utils::OpRunInfo &tiling_info) override;
+  // workspace sizes of the node are those of the aicore task
+  bool CalcsWorkspaces() const override {
+    return false;
+  }
 
  private:
   Status InitAtomicAddrCleanIndices(const OpDesc &op_desc);
@@ -73,6 +73,19 @@ class DynamicSingleOp {
                       std::vector<GeTensorDesc> &output_desc,
                       std::vector<DataBuffer> &outputs);
 
+  // launch cache of tbe task, keyed by input and output shapes and host tensor values set on the op
+  void SetLaunchCacheCapacity(const size_t capacity) {
+    TbeOpTask *const tbe_task = dynamic_cast<TbeOpTask *>(op_task_.get());
+    if (tbe_task != nullptr) {
+      tbe_task->SetLaunchCacheCapacity(capacity);
+    }
+  }
+
+  const ShapeKeyedCacheStatistics *GetLaunchCacheStatistics() const {
+    const TbeOpTask *const tbe_task = dynamic_cast<const TbeOpTask *>(op_task_.get());
+    return (tbe_task == nullptr) ? nullptr : tbe_task->GetLaunchCacheStatistics();
+  }
+
  private:
   friend class SingleOpModel;
   Status ValidateParams(const vector<GeTensorDesc> &input_desc,
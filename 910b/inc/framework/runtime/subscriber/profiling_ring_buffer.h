@@ -0,0 +1,301 @@
+/**
+* Copyright (c) Huawei Technologies Co., Ltd. 2022. All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+ */
+#ifndef AIR_CXX_INC_FRAMEWORK_RUNTIME_SUBSCRIBER_PROFILING_RING_BUFFER_H_
+#define AIR_CXX_INC_FRAMEWORK_RUNTIME_SUBSCRIBER_PROFILING_RING_BUFFER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "mmpa/mmpa_api.h"
+#include "runtime/subscriber/executor_subscriber_c.h"
+
+namespace gert {
+using ProfilingClock = std::chrono::steady_clock;
+using ProfilingTimePoint = std::chrono::time_point<ProfilingClock>;
+constexpr size_t kProfilingRingCap = 64UL * 1024UL;
+
+struct ProfilingData {
+  uint64_t name_idx;
+  uint64_t type_idx;
+  ExecutorEvent event;
+  ProfilingTimePoint timestamp;
+  int64_t thread_id;
+};
+
+// convert time point recorded by system clock, only for callers which have not moved to ProfilingClock
+inline ProfilingTimePoint ToProfilingTimePoint(const std::chrono::time_point<std::chrono::system_clock> timestamp) {
+  const auto elapsed = std::chrono::system_clock::now() - timestamp;
+  return ProfilingClock::now() - std::chrono::duration_cast<ProfilingClock::duration>(elapsed);
+}
+
+/**
+ * Single producer ring buffer of one thread. The owner thread writes without lock and overwrites the oldest
+ * records when full, a reader can take a snapshot at any time without stopping the writer. Every slot carries a
+ * sequence number of the record in it, odd while the record is written, so the reader drops records which are
+ * overwritten while it copies them instead of returning torn ones.
+ */
+class ProfilingRingBuffer {
+ public:
+  explicit ProfilingRingBuffer(const size_t capacity) : capacity_(RoundUpPowerOfTwo(capacity)),
+                                                        mask_(capacity_ - 1UL),
+                                                        slots_(new Slot[capacity_]()) {}
+
+  void Push(const ProfilingData &data) {
+    const uint64_t index = write_count_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[index & mask_];
+    slot.seq.store((index << 1U) + 1UL, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.words[kNameIdxWord].store(data.name_idx, std::memory_order_relaxed);
+    slot.words[kTypeIdxWord].store(data.type_idx, std::memory_order_relaxed);
+    slot.words[kEventWord].store(static_cast<uint64_t>(data.event), std::memory_order_relaxed);
+    slot.words[kTimestampWord].store(static_cast<uint64_t>(data.timestamp.time_since_epoch().count()),
+                                     std::memory_order_relaxed);
+    slot.words[kThreadIdWord].store(static_cast<uint64_t>(data.thread_id), std::memory_order_relaxed);
+    slot.seq.store((index + 1UL) << 1U, std::memory_order_release);
+    write_count_.store(index + 1UL, std::memory_order_release);
+  }
+
+  /**
+   * append the records still in buffer to out, records overwritten during copy are dropped
+   * @return number of records appended
+   */
+  size_t Snapshot(std::vector<ProfilingData> &out) const {
+    const uint64_t end = write_count_.load(std::memory_order_acquire);
+    const uint64_t begin = (end > capacity_) ? (end - capacity_) : 0UL;
+    size_t appended = 0UL;
+    for (uint64_t i = begin; i < end; ++i) {
+      ProfilingData data;
+      if (Read(i, data)) {
+        out.emplace_back(data);
+        ++appended;
+      }
+    }
+    return appended;
+  }
+
+  uint64_t GetWriteCount() const {
+    return write_count_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+
+ private:
+  enum SlotWord : size_t { kNameIdxWord, kTypeIdxWord, kEventWord, kTimestampWord, kThreadIdWord, kSlotWordNum };
+
+  struct Slot {
+    std::atomic<uint64_t> seq;  // (index + 1) * 2 once record of index is written, odd while writing
+    std::atomic<uint64_t> words[kSlotWordNum];
+  };
+
+  bool Read(const uint64_t index, ProfilingData &data) const {
+    const Slot &slot = slots_[index & mask_];
+    const uint64_t expected_seq = (index + 1UL) << 1U;
+    if (slot.seq.load(std::memory_order_acquire) != expected_seq) {
+      return false;
+    }
+    uint64_t words[kSlotWordNum];
+    for (size_t i = 0UL; i < static_cast<size_t>(kSlotWordNum); ++i) {
+      words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != expected_seq) {
+      return false;
+    }
+    data.name_idx = words[kNameIdxWord];
+    data.type_idx = words[kTypeIdxWord];
+    data.event = static_cast<ExecutorEvent>(words[kEventWord]);
+    data.timestamp =
+        ProfilingTimePoint(ProfilingClock::duration(static_cast<ProfilingClock::rep>(words[kTimestampWord])));
+    data.thread_id = static_cast<int64_t>(words[kThreadIdWord]);
+    return true;
+  }
+
+  static size_t RoundUpPowerOfTwo(const size_t value) {
+    size_t result = 1UL;
+    while (result < value) {
+      result <<= 1U;
+    }
+    return result;
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> write_count_{0UL};
+};
+
+/**
+ * Ring buffers of the recording threads of one profiler. Threads hold it weakly, so a thread exiting after the
+ * profiler is freed does not touch it. The ring of an exited thread is freed, its records are moved into a list
+ * shared by all exited threads and bounded by the ring capacity.
+ */
+class ProfilingBufferRegistry {
+ public:
+  explicit ProfilingBufferRegistry(const size_t ring_capacity) : ring_capacity_(ring_capacity) {}
+
+  ProfilingRingBuffer *Create() {
+    std::unique_ptr<ProfilingRingBuffer> buffer(new (std::nothrow) ProfilingRingBuffer(ring_capacity_));
+    if (buffer == nullptr) {
+      return nullptr;
+    }
+    const std::lock_guard<std::mutex> lk(mutex_);
+    buffers_.emplace_back(std::move(buffer));
+    return buffers_.back().get();
+  }
+
+  // called by the owner thread of buffer, when it exits or moves to another profiler
+  void Retire(const ProfilingRingBuffer *const buffer) {
+    const std::lock_guard<std::mutex> lk(mutex_);
+    for (auto it = buffers_.begin(); it != buffers_.end(); ++it) {
+      if (it->get() != buffer) {
+        continue;
+      }
+      std::vector<ProfilingData> records;
+      (void)buffer->Snapshot(records);
+      retired_records_.insert(retired_records_.end(), records.begin(), records.end());
+      while (retired_records_.size() > ring_capacity_) {
+        retired_records_.pop_front();
+      }
+      retired_count_ += buffer->GetWriteCount();
+      (void)buffers_.erase(it);
+      return;
+    }
+  }
+
+  uint64_t GetCount() const {
+    const std::lock_guard<std::mutex> lk(mutex_);
+    uint64_t count = retired_count_;
+    for (const auto &buffer : buffers_) {
+      count += buffer->GetWriteCount();
+    }
+    return count;
+  }
+
+  void Snapshot(std::vector<ProfilingData> &records) const {
+    const std::lock_guard<std::mutex> lk(mutex_);
+    records.insert(records.end(), retired_records_.begin(), retired_records_.end());
+    for (const auto &buffer : buffers_) {
+      (void)buffer->Snapshot(records);
+    }
+  }
+
+ private:
+  const size_t ring_capacity_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<ProfilingRingBuffer>> buffers_;
+  std::deque<ProfilingData> retired_records_;
+  uint64_t retired_count_ = 0UL;
+};
+
+/**
+ * Write records as Chrome trace event format, the output can be opened by chrome://tracing or Perfetto UI
+ */
+class ChromeTraceExporter {
+ public:
+  static void Export(std::vector<ProfilingData> &records, const std::vector<std::string> &idx_to_str,
+                     std::ostream &out_stream) {
+    std::stable_sort(records.begin(), records.end(), [](const ProfilingData &lhs, const ProfilingData &rhs) {
+      return lhs.timestamp < rhs.timestamp;
+    });
+    const int64_t pid = static_cast<int64_t>(mmGetPid());
+    out_stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto &record : records) {
+      if (!first) {
+        out_stream << ",";
+      }
+      first = false;
+      const auto ts_ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(record.timestamp.time_since_epoch()).count();
+      char_t ts_buf[32] = {};
+      (void)snprintf(ts_buf, sizeof(ts_buf), "%lld.%03lld", static_cast<long long>(ts_ns / 1000),
+                     static_cast<long long>(ts_ns % 1000));
+      out_stream << "{\"name\":\"" << Escape(GetString(record.name_idx, idx_to_str)) << "\",\"cat\":\""
+                 << Escape(GetString(record.type_idx, idx_to_str)) << "\",\"ph\":\"" << GetPhase(record.event)
+                 << "\",\"ts\":" << ts_buf << ",\"pid\":" << pid << ",\"tid\":" << record.thread_id;
+      if (record.event == kModelStart || record.event == kModelEnd) {
+        out_stream << ",\"args\":{\"scope\":\"model\"}";
+      }
+      out_stream << "}";
+    }
+    out_stream << "]}";
+  }
+
+ private:
+  static const char_t *GetPhase(const ExecutorEvent event) {
+    switch (event) {
+      case kExecuteStart:
+      case kModelStart:
+        return "B";
+      case kExecuteEnd:
+      case kModelEnd:
+        return "E";
+      default:
+        return "i";
+    }
+  }
+
+  static std::string GetString(const uint64_t idx, const std::vector<std::string> &idx_to_str) {
+    if (idx < idx_to_str.size()) {
+      return idx_to_str[idx];
+    }
+    return std::to_string(idx);
+  }
+
+  static std::string Escape(const std::string &str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char_t c : str) {
+      switch (c) {
+        case '"':
+          escaped += "\\\"";
+          break;
+        case '\\':
+          escaped += "\\\\";
+          break;
+        case '\n':
+          escaped += "\\n";
+          break;
+        case '\t':
+          escaped += "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20U) {
+            char_t buf[8] = {};
+            (void)snprintf(buf, sizeof(buf), "\\u%04x", static_cast<uint32_t>(static_cast<unsigned char>(c)));
+            escaped += buf;
+          } else {
+            escaped += c;
+          }
+          break;
+      }
+    }
+    return escaped;
+  }
+};
+}  // namespace gert
+#endif